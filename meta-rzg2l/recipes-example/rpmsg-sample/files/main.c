@@ -13,20 +13,36 @@
  *            Modification for OpenAMP 2018.10.
  *          - rev 1.2 (2020.10.27) Imada
  *            Added the license description.
+ *          - rev 1.3 (2026.10.18)
+ *            Added the IPC statistics export.
+ *          - rev 1.4 (2026.10.18)
+ *            Receive the echo with the pull API.
+ *          - rev 1.5 (2026.10.18)
+ *            Encode the echo payload with a fixed layout, in place.
+ *          - rev 1.6 (2026.10.18)
+ *            Added the broker mode (-b).
+ *          - rev 1.7 (2026.10.18)
+ *            Added the bridge mode (-s).
  ****************************************************************************
  */
 
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#include <time.h>
 #include <pthread.h>
 #include "metal/alloc.h"
 #include "metal/utilities.h"
 #include "openamp/open_amp.h"
 #include "platform_info.h"
 #include "rsc_table.h"
+#include "rpmsg_vdev.h"
+#include "rpmsg_msgs.h"
+#include "rpmsg_broker.h"
+#include "rpmsg_bridge.h"
 
 #define SHUTDOWN_MSG    (0xEF56A55A)
+#define RECV_TIMEOUT_MS (100)
 
 #ifndef max
 #define max(a,b) \
@@ -39,13 +55,6 @@
     #define ARRAY_SIZE(x) (sizeof(x)/sizeof(x[0]))
 #endif
 
-/* Payload definition */
-struct _payload {
-    unsigned long num;
-    unsigned long size;
-    unsigned char data[];
-};
-
 /* Payload information */
 struct payload_info {
     int minnum;
@@ -65,16 +74,21 @@ static void show_menu(int argc);
 static int wait_input(int argc, char *argv[]);
 static void launch_communicate(int pattern);
 static void *communicate(void* arg);
+static int broker(struct rpmsg_device *rdev, unsigned long id);
+static int bridge(struct rpmsg_device *rdev, unsigned long id);
 
 /* Globals */
 static struct rpmsg_endpoint rp_ept = { 0 };
-static struct _payload *i_payload;
-static int rnum = 0;
 static int err_cnt = 0;
 static char *svc_name = NULL;
-int force_stop = 0;
-pthread_cond_t cond;
-pthread_mutex_t mutex, rsc_mutex;
+static int serve_mode = 0; /* 'b' broker, 's' bridge, 0 echo test */
+static int busy_poll = 0; /* -p: the echo test busy polls the vrings */
+pthread_mutex_t rsc_mutex;
+
+/* Owned by the platform code, which lives in librpmsg_sample.a */
+extern int force_stop;
+extern pthread_cond_t cond;
+extern pthread_mutex_t mutex;
 
 struct comm_arg ids[] = {
     {NULL, 0},
@@ -85,6 +99,16 @@ struct comm_arg ids[] = {
 extern int init_system(void);
 extern void cleanup_system(void);
 
+/* Microseconds elapsed since from */
+static uint64_t usec_since(const struct timespec *from)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)((now.tv_sec - from->tv_sec) * 1000000000LL +
+                      (now.tv_nsec - from->tv_nsec)) / 1000U;
+}
+
 /* Application entry point */
 static int app (struct rpmsg_device *rdev, struct remoteproc *priv, unsigned long svcno)
 {
@@ -92,8 +116,15 @@ static int app (struct rpmsg_device *rdev, struct remoteproc *priv, unsigned lon
     int shutdown_msg = SHUTDOWN_MSG;
     int i;
     int size;
-    int expect_rnum = 0;
+    struct rpmsg_vdev_msg msg;
+    struct rpmsg_echo_hdr hdr;
+    void *buf;
+    size_t len;
     struct payload_info pi = { 0 };
+    struct rpmsg_vdev *rpvdev = rpmsg_vdev_from_rdev(rdev);
+    struct timespec sent;
+    uint64_t rtt, rtt_min = UINT64_MAX, rtt_max = 0U, rtt_sum = 0U;
+    unsigned int rtt_num = 0U;
     static int sighandled = 0;
 
     LPRINTF(" 1 - Send data to remote core, retrieve the echo");
@@ -139,29 +170,58 @@ static int app (struct rpmsg_device *rdev, struct remoteproc *priv, unsigned lon
     }
 
     LPRINTF("RPMSG service has created.");
+    if ((ret = rpmsg_vdev_pull_enable(&rp_ept))) {
+        LPERROR("Failed to enable the pull API.");
+        goto error;
+    }
+    /* Watch the vrings rather than wait for the doorbell */
+    if (busy_poll && rpmsg_vdev_set_busy_poll(rpvdev, 1)) {
+        LPERROR("Failed to enable busy polling.");
+    }
     for (i = 0, size = pi.minnum; i < (int)pi.num; i++, size++) {
-        i_payload->num = i;
-        i_payload->size = size;
-     
-        /* Mark the data buffer. */
-        memset(&(i_payload->data[0]), 0xA5, size);
-     
+        hdr.num = i;
+        hdr.size = size;
+
+        /* Encode the header and mark the data right in the TX buffer */
+        buf = rpmsg_vdev_get_tx_buffer(&rp_ept, NULL, 1);
+        if (!buf) {
+            LPRINTF("Error getting a TX buffer");
+            break;
+        }
+        len = rpmsg_echo_hdr_encode(&hdr, buf);
+        memset((unsigned char *)buf + len, 0xA5, size);
+
         LPRINTF("sending payload number %lu of size %lu",
-             i_payload->num, (2 * sizeof(unsigned long)) + size);
-     
-        ret = rpmsg_send(&rp_ept, i_payload,
-             (2 * sizeof(unsigned long)) + size);
+             (unsigned long)hdr.num, (unsigned long)(len + size));
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &sent);
+        ret = rpmsg_vdev_send_nocopy(&rp_ept, buf, (int)(len + size));
      
         if (ret < 0) {
             LPRINTF("Error sending data...%d", ret);
             break;
         }
-        LPRINTF("echo test: sent : %lu", (2 * sizeof(unsigned long)) + size);
      
-        expect_rnum++;
         do {
-            platform_poll(priv);
-        } while (!force_stop && (rnum < expect_rnum) && !err_cnt);
+            ret = rpmsg_vdev_recv_batch(&rp_ept, &msg, 1U, RECV_TIMEOUT_MS);
+        } while (!force_stop && !ret);
+        if (ret < 0) {
+            LPRINTF("Error receiving data...%d", ret);
+            break;
+        }
+        if (ret) {
+            /* Round trip, taken before anything is printed */
+            rtt = usec_since(&sent);
+            rpmsg_stats_observe(rpvdev->stats, busy_poll ? RPMSG_STATS_HIST_ECHO_POLL_USEC :
+                                RPMSG_STATS_HIST_ECHO_IRQ_USEC, rtt);
+            rtt_min = (rtt < rtt_min) ? rtt : rtt_min;
+            rtt_max = (rtt > rtt_max) ? rtt : rtt_max;
+            rtt_sum += rtt;
+            rtt_num++;
+            LPRINTF("echo test: sent : %lu", (unsigned long)(len + size));
+            (void)rpmsg_service_cb0(&rp_ept, msg.data, msg.len, msg.src, NULL);
+            rpmsg_vdev_recv_release(&rp_ept, &msg, 1U);
+        }
         usleep(10000);
         if (force_stop) {
             LPRINTF("\nForce stopped. ");
@@ -171,14 +231,21 @@ static int app (struct rpmsg_device *rdev, struct remoteproc *priv, unsigned lon
 
     LPRINTF("************************************");
     LPRINTF(" Test Results: Error count = %d ", err_cnt);
+    if (rtt_num) {
+        LPRINTF(" Round trip (%s): min %lu us, avg %lu us, max %lu us",
+                busy_poll ? "busy polling" : "doorbell", (unsigned long)rtt_min,
+                (unsigned long)(rtt_sum / rtt_num), (unsigned long)rtt_max);
+    }
     LPRINTF("************************************");
 error:
+    if (rpvdev->busy_poll)
+        (void)rpmsg_vdev_set_busy_poll(rpvdev, 0);
+    rpmsg_vdev_pull_disable(&rp_ept);
     /* Send shutdown message to remote */
     rpmsg_send(&rp_ept, &shutdown_msg, sizeof(int));
     sleep(1);
     LPRINTF("Quitting application .. Echo test end");
 
-    metal_free_memory(i_payload);
     return 0;
 }
 
@@ -212,26 +279,31 @@ static int rpmsg_service_cb0(struct rpmsg_endpoint *cb_rp_ept, void *data, size_
     (void)priv;
     int i;
     int ret = 0;
-    struct _payload *r_payload = (struct _payload *)data;
+    struct rpmsg_echo_hdr hdr;
+    const unsigned char *payload = (const unsigned char *)data + rpmsg_echo_hdr_wire_size;
 
+    if (!rpmsg_echo_hdr_decode(&hdr, data, len) || (len - rpmsg_echo_hdr_wire_size < hdr.size)) {
+        LPERROR(" Truncated payload is received.");
+        err_cnt++;
+        return -1;
+    }
     LPRINTF(" received payload number %lu of size %lu \r",
-    r_payload->num, len);
+    (unsigned long)hdr.num, (unsigned long)len);
 
-    if (r_payload->size == 0) {
+    if (hdr.size == 0) {
         LPERROR(" Invalid size of package is received.");
         err_cnt++;
         return -1;
     }
     /* Validate data buffer integrity. */
-    for (i = 0; i < (int)r_payload->size; i++) {
-        if (r_payload->data[i] != 0xA5) {
+    for (i = 0; i < (int)hdr.size; i++) {
+        if (payload[i] != 0xA5) {
             LPRINTF("Data corruption at index %d", i);
             err_cnt++;
             ret = -1;
             break;
         }
     }
-    rnum = r_payload->num + 1;
     return ret;
 }
 
@@ -247,23 +319,13 @@ static int payload_init(struct rpmsg_device *rdev, struct payload_info *pi) {
     pi->maxnum = rpmsg_buf_size - 24;
     pi->num = pi->maxnum / pi->minnum;
 
-    i_payload =
-        (struct _payload *)metal_allocate_memory(2 * sizeof(unsigned long) +
-                      pi->maxnum);
-    if (!i_payload) {
-        LPERROR("memory allocation failed.");
-        return -ENOMEM;
-    }
-
     return 0;
 }
 
 static void init_cond(void)
 {
 #ifdef __linux__
-    pthread_mutex_init(&mutex, NULL);
     pthread_mutex_init(&rsc_mutex, NULL);
-    pthread_cond_init(&cond, NULL);
 #endif
 }
 
@@ -276,10 +338,29 @@ int main(int argc, char *argv[])
     int i;
     int ret = 0;
 
+    /* rpmsg_sample_client -p ...: the echo test busy polls the vrings */
+    if ((argc >= 2) && !strcmp(argv[1], "-p")) {
+        busy_poll = 1;
+        argc--;
+        argv++;
+    }
+
+    /* rpmsg_sample_client -b|-s <ch>: serve the channel to other processes */
+    if ((argc >= 2) && (!strcmp(argv[1], "-b") || !strcmp(argv[1], "-s"))) {
+        serve_mode = argv[1][1];
+        argc--;
+        argv++;
+    }
+
     /* Initialize HW system components */
     init_system();
     init_cond();
 
+    /* Export the IPC statistics (node_exporter textfile format) */
+    if (rpmsg_stats_start(RPMSG_STATS_PATH, RPMSG_STATS_PERIOD_MS)) {
+        LPERROR("Failed to start the statistics export.");
+    }
+
     /* Initialize platform */
     
     for (i = 0; i < ARRAY_SIZE(ids); i++) {
@@ -311,6 +392,7 @@ int main(int argc, char *argv[])
     cleanup_system();
 
 error_return:
+    rpmsg_stats_stop();
     return ret;
 }
 
@@ -322,20 +404,31 @@ error_return:
 static void *communicate(void* arg) {
     struct comm_arg *p = (struct comm_arg*)arg;
     struct rpmsg_device *rpdev;
+    rpmsg_ns_bind_cb ns_bind = rpmsg_service_bind;
     unsigned long proc_id = p->channel;
 
     LPRINTF("thread start ");
 
+    if (serve_mode == 'b')
+        ns_bind = rpmsg_broker_ns_bind;
+    else if (serve_mode == 's')
+        ns_bind = rpmsg_bridge_ns_bind;
+
     pthread_mutex_lock(&rsc_mutex);
     rpdev = platform_create_rpmsg_vdev(p->platform, 0,
                       VIRTIO_DEV_MASTER,
                       NULL,
-                      rpmsg_service_bind);
+                      ns_bind);
     pthread_mutex_unlock(&rsc_mutex);
     if (!rpdev) {
         LPERROR("Failed to create rpmsg virtio device.");
     } else {
-        (void)app(rpdev, p->platform, proc_id);
+        if (serve_mode == 'b')
+            (void)broker(rpdev, proc_id);
+        else if (serve_mode == 's')
+            (void)bridge(rpdev, proc_id);
+        else
+            (void)app(rpdev, p->platform, proc_id);
         platform_release_rpmsg_vdev(p->platform, rpdev);
     }
     LPRINTF("Stopping application...");
@@ -343,6 +436,48 @@ static void *communicate(void* arg) {
     return NULL;
 }
 
+/**
+ * @fn broker
+ * @brief serve the rpmsg device to other processes until stopped
+ * @param rdev - rpmsg device
+ * @param id - number of the broker socket
+ */
+static int broker(struct rpmsg_device *rdev, unsigned long id)
+{
+    char path[64];
+    static int sighandled = 0;
+
+    if (!sighandled) {
+        sighandled = 1;
+        register_handler(SIGINT, stop_handler);
+        register_handler(SIGTERM, stop_handler);
+    }
+
+    snprintf(path, sizeof(path), RPMSG_BROKER_PATH_FMT, id);
+    return rpmsg_broker_run(rdev, path, &force_stop);
+}
+
+/**
+ * @fn bridge
+ * @brief expose the services of the rpmsg device as sockets until stopped
+ * @param rdev - rpmsg device
+ * @param id - number of the socket directory
+ */
+static int bridge(struct rpmsg_device *rdev, unsigned long id)
+{
+    char dir[64];
+    static int sighandled = 0;
+
+    if (!sighandled) {
+        sighandled = 1;
+        register_handler(SIGINT, stop_handler);
+        register_handler(SIGTERM, stop_handler);
+    }
+
+    snprintf(dir, sizeof(dir), RPMSG_BRIDGE_DIR_FMT, id);
+    return rpmsg_bridge_run(rdev, dir, &force_stop);
+}
+
 /**
  * @fn launch_communicate
  * @brief Launch test threads according to test patterns
@@ -418,6 +553,8 @@ static int wait_input(int argc, char *argv[])
         /***************************************
         * rpmsg_sample_client 0   -> pattern 1
         * rpmsg_sample_client 1   -> pattern 2
+        * rpmsg_sample_client -b 0 -> pattern 1, broker
+        * rpmsg_sample_client -s 0 -> pattern 1, bridge
         **************************************/
     } else {
         fgets(inbuf, sizeof(inbuf), stdin);
@@ -0,0 +1,66 @@
+/**
+ * @file    rpmsg_bridge.h
+ * @brief   Bridge exposing rpmsg services as Unix seqpacket sockets.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * Every service announced by the remote side gets an endpoint and a
+ * SOCK_SEQPACKET socket named after it, for example
+ * /run/rpmsg-bridge-0/rpmsg-service-0. One packet is one message, so any
+ * program able to use a Unix socket talks to the remote side:
+ *
+ * @code
+ *     socat - UNIX-CONNECT:/run/rpmsg-bridge-0/rpmsg-service-0,type=5
+ * @endcode
+ *
+ * A service has one connection at a time, further ones wait in the listen
+ * backlog. Messages are moved in batches with recvmmsg() and sendmmsg(),
+ * without a copy: packets are read straight into vring TX buffers and
+ * written from the vring RX buffers. Messages received while nobody is
+ * connected are dropped, so that they do not hold vring buffers shared
+ * with the other services. Empty packets are not forwarded.
+ */
+
+#ifndef RPMSG_BRIDGE_H_
+#define RPMSG_BRIDGE_H_
+
+#include <stdint.h>
+#include <openamp/rpmsg.h>
+
+// Directory of the sockets of rpmsg device <id>
+#define RPMSG_BRIDGE_DIR_FMT        "/run/rpmsg-bridge-%lu"
+// Services of one bridge; each takes a pull queue and a TX ready entry
+#define RPMSG_BRIDGE_SERVICE_MAX    (8U)
+// Interval at which the event loop checks the stop flag
+#define RPMSG_BRIDGE_STOP_CHECK_MS  (100)
+
+/**
+ * rpmsg_bridge_ns_bind - name service callback of a bridged device
+ *
+ * Pass it to platform_create_rpmsg_vdev() for a device served by
+ * rpmsg_bridge_run().
+ */
+void rpmsg_bridge_ns_bind(struct rpmsg_device *rdev, const char *name, uint32_t dest);
+
+/**
+ * rpmsg_bridge_run - expose the services of a device as sockets
+ *
+ * Runs the event loop of the bridge in the calling thread. The device is
+ * served by an rpmsg_poller of the bridge, platform_poll() is not needed.
+ *
+ * @rdev: device, virtio master
+ * @dir: directory of the sockets, created if needed
+ * @stop: the bridge returns once *stop is non-zero
+ *
+ * return 0 once stopped, negative value on failure
+ */
+int rpmsg_bridge_run(struct rpmsg_device *rdev, const char *dir, volatile int *stop);
+
+#endif /* RPMSG_BRIDGE_H_ */
@@ -0,0 +1,119 @@
+/**
+ * @file    rpmsg_coro_echo.cpp
+ * @brief   Echo test written against the installed libraries only.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * Built like a service out of this tree: it includes the installed headers
+ * and links librpmsg_coro.a and librpmsg_sample.a only, so a symbol missing
+ * from the archives fails the build of the layer.
+ *
+ * usage: rpmsg_coro_echo [channel]
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "rpmsg_coro.hpp"
+
+extern "C" {
+#include "platform_info.h"
+
+int init_system(void);
+void cleanup_system(void);
+}
+
+#define ECHO_COUNT      (16U)
+#define ECHO_TIMEOUT_MS (1000)
+
+static rpmsg::task<void> echo(rpmsg::endpoint &ep, int &result)
+{
+    char buf[32];
+    rpmsg::message msg;
+    unsigned int i;
+    int len;
+
+    co_await ep.wait_ready();
+    for (i = 0; i < ECHO_COUNT; i++) {
+        len = snprintf(buf, sizeof(buf), "echo %u", i);
+        result = co_await ep.send(buf, (size_t)len);
+        if (result < 0) {
+            LPERROR("Failed to send: %d.", result);
+            co_return;
+        }
+        msg = co_await ep.recv(std::chrono::milliseconds(ECHO_TIMEOUT_MS));
+        if (msg.status) {
+            result = msg.status;
+            LPERROR("No echo: %d.", result);
+            co_return;
+        }
+        if ((msg.data.size() != (size_t)len) || memcmp(msg.data.data(), buf, (size_t)len)) {
+            result = -EBADMSG;
+            LPERROR("Echo %u differs from the message.", i);
+            co_return;
+        }
+    }
+    result = 0;
+    LPRINTF("%u messages echoed.", ECHO_COUNT);
+}
+
+/* Serve the device on this thread until the echo test is over */
+static int run(struct rpmsg_device *rdev)
+{
+    rpmsg::executor ex;
+    rpmsg::endpoint ep(ex);
+    int ret;
+
+    ret = ex.add(rdev);
+    if (!ret)
+        ret = ep.open(rdev, CFG_RPMSG_SVC_NAME0);
+    if (ret) {
+        LPERROR("Failed to open the endpoint: %d.", ret);
+        return ret;
+    }
+    ex.spawn(echo(ep, ret));
+    (void)ex.run();
+
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    struct remoteproc *platform = NULL;
+    struct rpmsg_device *rdev;
+    unsigned long channel = 0;
+    int ret;
+
+    if (argc > 1)
+        channel = strtoul(argv[1], NULL, 0);
+
+    init_system();
+    ret = platform_init(channel, channel, &platform);
+    if (ret) {
+        LPERROR("Failed to initialize platform.");
+        cleanup_system();
+        return 1;
+    }
+
+    rdev = platform_create_rpmsg_vdev(platform, 0, VIRTIO_DEV_MASTER, NULL, NULL);
+    if (!rdev) {
+        LPERROR("Failed to create rpmsg virtio device.");
+        ret = 1;
+    } else {
+        ret = run(rdev) ? 1 : 0;
+        platform_release_rpmsg_vdev(platform, rdev);
+    }
+
+    platform_cleanup(platform);
+    cleanup_system();
+
+    return ret;
+}
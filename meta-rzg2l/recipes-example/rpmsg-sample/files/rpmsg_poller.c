@@ -0,0 +1,182 @@
+/**
+ * @file    rpmsg_poller.c
+ * @brief   Budgeted round-robin RX dispatch over several rpmsg devices.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "rpmsg_vdev.h"
+#include "rpmsg_poller.h"
+
+static void poller_signal(struct rpmsg_poller *poller)
+{
+    uint64_t one = 1U;
+
+    (void)write(poller->fd, &one, sizeof(one));
+}
+
+static void ready_push(struct rpmsg_poller *poller, unsigned int index)
+{
+    poller->ready[(poller->head + poller->count) % RPMSG_POLLER_DEV_MAX] = index;
+    poller->count++;
+    poller->queued |= 1U << index;
+}
+
+static unsigned int ready_pop(struct rpmsg_poller *poller)
+{
+    unsigned int index = poller->ready[poller->head];
+
+    poller->head = (poller->head + 1U) % RPMSG_POLLER_DEV_MAX;
+    poller->count--;
+
+    return index;
+}
+
+int rpmsg_poller_init(struct rpmsg_poller *poller)
+{
+    memset(poller, 0, sizeof(*poller));
+    poller->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    return (poller->fd < 0) ? -errno : 0;
+}
+
+void rpmsg_poller_deinit(struct rpmsg_poller *poller)
+{
+    unsigned int i;
+
+    for (i = 0; i < RPMSG_POLLER_DEV_MAX; i++) {
+        if (poller->dev[i])
+            rpmsg_poller_remove(poller, &poller->dev[i]->rvdev.rdev);
+    }
+    if (poller->fd >= 0) {
+        (void)close(poller->fd);
+        poller->fd = -1;
+    }
+}
+
+int rpmsg_poller_add(struct rpmsg_poller *poller, struct rpmsg_device *rdev, unsigned int budget)
+{
+    struct rpmsg_vdev *rpvdev = rpmsg_vdev_from_rdev(rdev);
+    unsigned int i;
+
+    if (rpvdev->poller)
+        return -EBUSY;
+    for (i = 0; i < RPMSG_POLLER_DEV_MAX; i++) {
+        if (!poller->dev[i])
+            break;
+    }
+    if (i == RPMSG_POLLER_DEV_MAX)
+        return -ENOSPC;
+
+    poller->dev[i] = rpvdev;
+    poller->budget[i] = budget ? budget : RPMSG_POLLER_BUDGET;
+    poller->num++;
+    rpvdev->poller_index = i;
+    __atomic_store_n(&rpvdev->poller, poller, __ATOMIC_RELEASE);
+
+    /* Messages may have arrived before the device was attached */
+    rpmsg_poller_schedule(rpvdev);
+
+    return 0;
+}
+
+void rpmsg_poller_remove(struct rpmsg_poller *poller, struct rpmsg_device *rdev)
+{
+    struct rpmsg_vdev *rpvdev = rpmsg_vdev_from_rdev(rdev);
+    unsigned int index = rpvdev->poller_index;
+    unsigned int i, n;
+
+    if (rpvdev->poller != poller)
+        return;
+
+    __atomic_store_n(&rpvdev->poller, NULL, __ATOMIC_RELEASE);
+    poller->dev[index] = NULL;
+    poller->num--;
+    (void)__atomic_fetch_and(&poller->pending, ~(1U << index), __ATOMIC_SEQ_CST);
+
+    if (poller->queued & (1U << index)) {
+        poller->queued &= ~(1U << index);
+        for (n = poller->count; n; n--) {
+            i = ready_pop(poller);
+            if (i != index)
+                ready_push(poller, i);
+        }
+    }
+}
+
+void rpmsg_poller_schedule(struct rpmsg_vdev *rpvdev)
+{
+    struct rpmsg_poller *poller = __atomic_load_n(&rpvdev->poller, __ATOMIC_ACQUIRE);
+
+    if (!poller)
+        return;
+
+    /* Only the first notification of a device wakes the event loop up */
+    if (!(__atomic_fetch_or(&poller->pending, 1U << rpvdev->poller_index, __ATOMIC_SEQ_CST)
+          & (1U << rpvdev->poller_index)))
+        poller_signal(poller);
+}
+
+unsigned int rpmsg_poller_run(struct rpmsg_poller *poller)
+{
+    struct rpmsg_vdev *rpvdev;
+    unsigned int pending, index, turns, n;
+    unsigned int total = 0U;
+    uint64_t cnt;
+
+    (void)read(poller->fd, &cnt, sizeof(cnt));
+
+    /* Notified devices join the back of the queue */
+    pending = __atomic_exchange_n(&poller->pending, 0U, __ATOMIC_SEQ_CST);
+    while (pending) {
+        index = (unsigned int)__builtin_ctz(pending);
+        pending &= pending - 1U;
+        if (poller->dev[index] && !(poller->queued & (1U << index)))
+            ready_push(poller, index);
+    }
+
+    /* One turn for every device queued at this point */
+    for (turns = poller->count; turns; turns--) {
+        index = ready_pop(poller);
+        rpvdev = poller->dev[index];
+
+        n = rpmsg_vdev_rx_poll(rpvdev, poller->budget[index]);
+        rpmsg_vdev_tx_dispatch(&rpvdev->rvdev.rdev);
+        total += n;
+
+        if (n == poller->budget[index])
+            ready_push(poller, index); /* budget used up: more may be waiting */
+        else
+            poller->queued &= ~(1U << index);
+    }
+
+    /* Resume the unfinished devices on the next call, without an interrupt */
+    if (poller->count)
+        poller_signal(poller);
+
+    return total;
+}
+
+int rpmsg_poller_wait(struct rpmsg_poller *poller, int timeout_ms)
+{
+    struct pollfd pfd = { poller->fd, POLLIN, 0 };
+    int ret;
+
+    do {
+        ret = poll(&pfd, 1, timeout_ms);
+    } while ((ret < 0) && (errno == EINTR));
+
+    return (ret < 0) ? -errno : ret;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file    rpmsg_rpc.h
+ * @brief   Request/response calls with correlation IDs over one endpoint.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * Every message on the endpoint starts with struct rpmsg_rpc_hdr. A
+ * response carries the id of its request and RPMSG_RPC_FLAG_RESP, so
+ * responses may come back in any order and many requests may be in
+ * flight. The remote side answers each request it receives with exactly
+ * one response.
+ */
+
+#ifndef RPMSG_RPC_H_
+#define RPMSG_RPC_H_
+
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <openamp/rpmsg.h>
+#include "rpmsg_vdev.h"
+
+// Maximum number of requests in flight on one endpoint
+#define RPMSG_RPC_PENDING_MAX   (32U)
+// Largest message, header included (RPMsg buffer minus its header)
+#define RPMSG_RPC_MSG_MAX       (RPMSG_BUFFER_SIZE - sizeof(struct rpmsg_vdev_hdr))
+// Set in the flags of a response
+#define RPMSG_RPC_FLAG_RESP     (0x0001U)
+
+/**
+ * @struct rpmsg_rpc_hdr
+ * @brief  header of every request and response
+ */
+struct rpmsg_rpc_hdr {
+    uint32_t id;     /**< correlation id chosen by the requester */
+    uint16_t op;     /**< operation, echoed in the response */
+    uint16_t flags;  /**< RPMSG_RPC_FLAG_* */
+    int32_t status;  /**< result of the operation, 0 in requests */
+} __attribute__((packed));
+
+// Largest request or response payload
+#define RPMSG_RPC_PAYLOAD_MAX   (RPMSG_RPC_MSG_MAX - sizeof(struct rpmsg_rpc_hdr))
+
+/**
+ * rpmsg_rpc_done_cb - completion of a request
+ *
+ * Called once per request, without any lock held, from the thread
+ * receiving the response or, on timeout, from the thread calling
+ * rpmsg_rpc_expire().
+ *
+ * @priv: argument given with the request
+ * @status: status of the response, -ETIMEDOUT or -ECANCELED
+ * @data: response payload, only valid during the call
+ * @len: payload length
+ */
+typedef void (*rpmsg_rpc_done_cb)(void *priv, int status, const void *data, size_t len);
+
+/**
+ * rpmsg_rpc_req_cb - request received from the remote side
+ *
+ * The handler answers with rpmsg_rpc_reply(), now or later.
+ *
+ * @priv: argument given to rpmsg_rpc_init()
+ * @hdr: request header
+ * @data: request payload, only valid during the call
+ * @len: payload length
+ */
+typedef void (*rpmsg_rpc_req_cb)(void *priv, const struct rpmsg_rpc_hdr *hdr, const void *data, size_t len);
+
+/**
+ * @struct rpmsg_rpc_pending
+ * @brief  entry of the pending-request table
+ */
+struct rpmsg_rpc_pending {
+    uint32_t id;               /**< 0 when the entry is free */
+    uint16_t op;
+    struct timespec deadline;  /**< CLOCK_MONOTONIC */
+    rpmsg_rpc_done_cb cb;
+    void *priv;
+};
+
+/**
+ * @struct rpmsg_rpc
+ * @brief  RPC channel on one endpoint
+ */
+struct rpmsg_rpc {
+    struct rpmsg_endpoint *ept;
+    pthread_mutex_t lock;    /**< protects the members below */
+    pthread_cond_t cond;     /**< signalled when a future completes */
+    struct rpmsg_rpc_pending pending[RPMSG_RPC_PENDING_MAX];
+    unsigned int num;        /**< requests in flight */
+    uint32_t seq;            /**< generation of the next id */
+    rpmsg_rpc_req_cb req_cb; /**< handler of incoming requests, may be NULL */
+    void *req_priv;
+};
+
+/**
+ * @struct rpmsg_rpc_future
+ * @brief  result of a request, filled in on completion
+ */
+struct rpmsg_rpc_future {
+    struct rpmsg_rpc *rpc;
+    void *resp;      /**< buffer for the response payload, may be NULL */
+    size_t size;     /**< size of @resp */
+    size_t len;      /**< response payload length, may exceed @size */
+    int status;
+    int done;
+};
+
+/**
+ * rpmsg_rpc_init - set up an RPC channel on an endpoint
+ *
+ * The endpoint must be created with rpmsg_rpc_ept_cb() as callback; its
+ * private data is set to @rpc.
+ *
+ * @rpc: channel
+ * @ept: endpoint
+ * @req_cb: handler of requests from the remote side, NULL to ignore them
+ * @req_priv: argument of @req_cb
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_rpc_init(struct rpmsg_rpc *rpc, struct rpmsg_endpoint *ept,
+                   rpmsg_rpc_req_cb req_cb, void *req_priv);
+
+/**
+ * rpmsg_rpc_deinit - complete all pending requests with -ECANCELED
+ *
+ * @rpc: channel
+ */
+void rpmsg_rpc_deinit(struct rpmsg_rpc *rpc);
+
+/**
+ * rpmsg_rpc_ept_cb - endpoint callback dispatching the RPC messages
+ */
+int rpmsg_rpc_ept_cb(struct rpmsg_endpoint *ept, void *data, size_t len, uint32_t src, void *priv);
+
+/**
+ * rpmsg_rpc_call_async - send a request without waiting for the response
+ *
+ * @rpc: channel
+ * @op: operation
+ * @data: request payload
+ * @len: payload length, up to RPMSG_RPC_PAYLOAD_MAX
+ * @timeout_ms: time the remote has to answer
+ * @cb: completion callback
+ * @priv: argument of @cb
+ *
+ * return correlation id (positive) on success, -EAGAIN if
+ *        RPMSG_RPC_PENDING_MAX requests are in flight, negative value on
+ *        other failures, in which case @cb is not called
+ */
+int rpmsg_rpc_call_async(struct rpmsg_rpc *rpc, uint16_t op, const void *data, size_t len,
+                         unsigned int timeout_ms, rpmsg_rpc_done_cb cb, void *priv);
+
+/**
+ * rpmsg_rpc_submit - send a request whose result goes to a future
+ *
+ * @rpc: channel
+ * @op: operation
+ * @data: request payload
+ * @len: payload length
+ * @timeout_ms: time the remote has to answer
+ * @f: future, with resp and size set by the caller; valid until waited for
+ *
+ * return correlation id on success, negative value on failure
+ */
+int rpmsg_rpc_submit(struct rpmsg_rpc *rpc, uint16_t op, const void *data, size_t len,
+                     unsigned int timeout_ms, struct rpmsg_rpc_future *f);
+
+/**
+ * rpmsg_rpc_wait - wait for a future
+ *
+ * Takes the messages from the RX virtqueue meanwhile, unless another thread
+ * does (virtio master), so the thread that normally polls the device may
+ * wait too.
+ *
+ * @f: future of a submitted request
+ *
+ * return status of the response, -ETIMEDOUT or -ECANCELED
+ */
+int rpmsg_rpc_wait(struct rpmsg_rpc_future *f);
+
+/**
+ * rpmsg_rpc_call - send a request and wait for its response
+ *
+ * @rpc: channel
+ * @op: operation
+ * @data: request payload
+ * @len: payload length
+ * @resp: buffer for the response payload, may be NULL
+ * @size: size of @resp, a longer payload is truncated
+ * @timeout_ms: time the remote has to answer
+ *
+ * return response payload length if the status is 0, else the status or
+ *        another negative value
+ */
+int rpmsg_rpc_call(struct rpmsg_rpc *rpc, uint16_t op, const void *data, size_t len,
+                   void *resp, size_t size, unsigned int timeout_ms);
+
+/**
+ * rpmsg_rpc_reply - answer a request of the remote side
+ *
+ * @rpc: channel
+ * @req: header of the request
+ * @status: result of the operation
+ * @data: response payload
+ * @len: payload length
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_rpc_reply(struct rpmsg_rpc *rpc, const struct rpmsg_rpc_hdr *req, int status,
+                    const void *data, size_t len);
+
+/**
+ * rpmsg_rpc_expire - complete the requests past their deadline
+ *
+ * Futures expire by themselves in rpmsg_rpc_wait(). Requests with a
+ * callback expire when the channel sends or receives, or when the
+ * application calls this function, e.g. from its event loop.
+ *
+ * @rpc: channel
+ *
+ * return number of expired requests
+ */
+unsigned int rpmsg_rpc_expire(struct rpmsg_rpc *rpc);
+
+#endif /* RPMSG_RPC_H_ */
@@ -0,0 +1,109 @@
+/**
+ * @file    rpmsg_serve.c
+ * @brief   Helpers shared by the servers exposing an rpmsg device on Unix sockets.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "platform_info.h"
+#include "rpmsg_serve.h"
+
+int rpmsg_serve_register(struct rpmsg_serve_registry *reg, struct rpmsg_device *rdev, void *server)
+{
+    unsigned int i;
+    int ret = -ENOSPC;
+
+    pthread_mutex_lock(&reg->lock);
+    for (i = 0; i < RPMSG_POLLER_DEV_MAX; i++) {
+        if (!reg->server[i]) {
+            reg->rdev[i] = rdev;
+            reg->server[i] = server;
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&reg->lock);
+
+    return ret;
+}
+
+void rpmsg_serve_unregister(struct rpmsg_serve_registry *reg, void *server)
+{
+    unsigned int i;
+
+    pthread_mutex_lock(&reg->lock);
+    for (i = 0; i < RPMSG_POLLER_DEV_MAX; i++) {
+        if (reg->server[i] == server) {
+            reg->server[i] = NULL;
+            reg->rdev[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&reg->lock);
+}
+
+void *rpmsg_serve_find(struct rpmsg_serve_registry *reg, struct rpmsg_device *rdev)
+{
+    void *server = NULL;
+    unsigned int i;
+
+    pthread_mutex_lock(&reg->lock);
+    for (i = 0; i < RPMSG_POLLER_DEV_MAX; i++) {
+        if (reg->server[i] && (reg->rdev[i] == rdev))
+            server = reg->server[i];
+    }
+    pthread_mutex_unlock(&reg->lock);
+
+    return server;
+}
+
+int rpmsg_serve_listen(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return -ENAMETOOLONG;
+
+    fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -errno;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    /* Left over by a previous instance */
+    (void)unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(fd, RPMSG_SERVE_BACKLOG)) {
+        (void)close(fd);
+        return -errno;
+    }
+
+    return fd;
+}
+
+int rpmsg_serve_ept_cb(struct rpmsg_endpoint *ept, void *data, size_t len, uint32_t src, void *priv)
+{
+    (void)data;
+    (void)len;
+    (void)src;
+    (void)priv;
+
+    LPERROR("Message for %s dropped.", ept->name);
+    return RPMSG_SUCCESS;
+}
+
+void rpmsg_serve_unbind_cb(struct rpmsg_endpoint *ept)
+{
+    (void)ept;
+}
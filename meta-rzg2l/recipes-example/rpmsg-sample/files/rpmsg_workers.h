@@ -0,0 +1,63 @@
+/**
+ * @file    rpmsg_workers.h
+ * @brief   Worker threads running the endpoint callbacks of a rpmsg device.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#ifndef RPMSG_WORKERS_H_
+#define RPMSG_WORKERS_H_
+
+#include <openamp/rpmsg.h>
+#include "rpmsg_vdev.h"
+
+// Maximum number of worker threads of a device
+#define RPMSG_WORKERS_MAX       (4U)
+// Messages a worker handles before it gives their buffers back with one kick
+#define RPMSG_WORKERS_BATCH     (16U)
+
+/**
+ * rpmsg_workers_start - run the endpoint callbacks of a device on workers
+ *
+ * Received messages are handed to worker @c addr % @num of their endpoint
+ * without a copy; the vring buffer is held until the callback returned.
+ * Messages of one endpoint are therefore delivered in order, while
+ * different endpoints run in parallel.
+ *
+ * @rdev: device returned by platform_create_rpmsg_vdev()
+ * @num: number of worker threads, 1 to RPMSG_WORKERS_MAX
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_workers_start(struct rpmsg_device *rdev, unsigned int num);
+
+/**
+ * rpmsg_workers_stop - stop the workers after the queued messages
+ *
+ * Callbacks run in the polling thread again afterwards. Call it from the
+ * polling thread, or when it is stopped, and before destroying endpoints.
+ *
+ * @rdev: device
+ */
+void rpmsg_workers_stop(struct rpmsg_device *rdev);
+
+/**
+ * rpmsg_workers_submit - queue a received message for its worker
+ *
+ * Used by the receive loop of rpmsg_vdev.
+ *
+ * @workers: worker pool of the device
+ * @ept: destination endpoint
+ * @hdr: received buffer, given back by the worker
+ */
+void rpmsg_workers_submit(struct rpmsg_workers *workers, struct rpmsg_endpoint *ept,
+                          struct rpmsg_vdev_hdr *hdr);
+
+#endif /* RPMSG_WORKERS_H_ */
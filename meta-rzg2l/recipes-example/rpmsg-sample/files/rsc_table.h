@@ -37,8 +37,17 @@
 #define VIRTIO_ID_RPMSG_        (7U)
 
 #define NUM_VRINGS              (2U)
-#define NUM_TABLE_ENTRIES       (2U)
-#define NO_RESOURCE_ENTRIES     (2U)
+#define NUM_TABLE_ENTRIES       (1U + RSC_VDEV_NUM)
+#define NO_RESOURCE_ENTRIES     (1U + RSC_VDEV_NUM)
+
+/* No cache line may hold vring fields written by both cores */
+#if (CFG_VRING0_BASE0 % VRING_CACHE_LINE) || (CFG_VRING1_BASE0 % VRING_CACHE_LINE) || \
+    (CFG_VRING0_BASE1 % VRING_CACHE_LINE) || (CFG_VRING1_BASE1 % VRING_CACHE_LINE)
+#error "vrings must start on a cache line"
+#endif
+#if (CFG_VRING_ALIGN0 % VRING_CACHE_LINE) || (CFG_VRING_ALIGN1 % VRING_CACHE_LINE)
+#error "vring alignment must be a multiple of the cache line"
+#endif
 
 /* Resource table UIO device */
 #define CFG_RSCTBL_DEV_NAME     "42f00000.rsctbl"
@@ -47,6 +56,13 @@
 
 #if defined(__CC_ARM) || defined(__GNUC__)
 /* MDK_ARM compiler does not apply __packed__ for this */
+/* rpmsg vdev entry with its vring pair */
+struct remote_rsc_vdev {
+    struct fw_rsc_vdev vdev;
+    struct fw_rsc_vdev_vring vring0;
+    struct fw_rsc_vdev_vring vring1;
+};
+
 struct remote_resource_table {
     unsigned int version;
     unsigned int num;
@@ -58,6 +74,10 @@ struct remote_resource_table {
     struct fw_rsc_vdev rpmsg_vdev;
     struct fw_rsc_vdev_vring rpmsg_vring0;
     struct fw_rsc_vdev_vring rpmsg_vring1;
+#if RSC_VDEV_NUM > 1
+    /* further rpmsg vdev entries, vdev_index 1 and up */
+    struct remote_rsc_vdev rpmsg_vdev_more[RSC_VDEV_NUM - 1];
+#endif
 };
 
 #elif __ICCARM__
@@ -90,6 +110,10 @@ struct remote_resource_table {
     struct fw_rsc_rproc_mem rproc_mem;
     /* rpmsg vdev entry */
     struct my_fw_rsc_vdev rpmsg_vdev;
+#if RSC_VDEV_NUM > 1
+    /* further rpmsg vdev entries, vdev_index 1 and up */
+    struct my_fw_rsc_vdev rpmsg_vdev_more[RSC_VDEV_NUM - 1];
+#endif
 } OPENAMP_PACKED_END;
 #endif
 
@@ -31,6 +31,7 @@
 #include <metal/utilities.h>
 #include <openamp/rpmsg_virtio.h>
 #include "platform_info.h"
+#include "rpmsg_vdev.h"
 
 extern struct ipi_info ipi;
 extern struct shm_info shm;
@@ -276,31 +277,102 @@ error_return:
     return;
 }
 
+/*
+ * Decode the notification word of the remote into notify id bits, 0 if it
+ * is invalid or counts nothing new. In the counting format these are the
+ * ids whose count moved since the word in *seen, which takes val; the
+ * legacy format (notify_id of the sender) checks all.
+ */
+static uint32_t notify_bits(uint32_t *seen, uint32_t val)
+{
+    uint32_t moved;
+    uint32_t bits = 0U;
+    unsigned int id;
+
+    if (val & NOTIFY_COUNT_FLAG) {
+        moved = val ^ *seen;
+        *seen = val;
+        for (id = 0U; id < NOTIFY_COUNT_IDS; id++) {
+            if (moved & NOTIFY_COUNT_FIELD(id))
+                bits |= 1U << id;
+        }
+        return bits;
+    }
+
+    return (val < RPVDEV_MAX_NUM) ? NOTIFY_CHECK_ALL : 0U;
+}
+
+/*
+ * Count a notification of notify id @id in the word of ours, 0 to send the
+ * legacy format instead. Each field wraps on its own.
+ */
+static uint32_t notify_count(uint32_t *sent, uint32_t id)
+{
+    uint32_t old = __atomic_load_n(sent, __ATOMIC_RELAXED);
+    uint32_t val;
+
+    if (!old || (id >= NOTIFY_COUNT_IDS))
+        return 0U;
+    do {
+        val = (old & ~NOTIFY_COUNT_FIELD(id)) |
+              ((old + (1U << (id * NOTIFY_COUNT_BITS))) & NOTIFY_COUNT_FIELD(id));
+    } while (!__atomic_compare_exchange_n(sent, &old, val, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+    return val;
+}
+
+/*
+ * 1 with the latest word in *val if the word of ours moved on since *val:
+ * a concurrent notify may have written its word before the older *val.
+ */
+static int notify_count_stale(uint32_t *sent, uint32_t *val)
+{
+    uint32_t now = __atomic_load_n(sent, __ATOMIC_SEQ_CST);
+
+    if (now == *val)
+        return 0;
+    *val = now;
+    return 1;
+}
+
 static int rz_proc_irq_handler(int vect_id, void *data)
 {
     unsigned int val = 0U;
+    uint32_t bits;
+#ifdef __linux__
+    unsigned int i;
+#endif
 
     (void)vect_id;
     (void)data;
 
+    rpmsg_stats_inc(ipi.stats, RPMSG_STATS_IRQS);
+
     /* Clear the interrupt */
     metal_io_write32_with_check(ipi.io, MBX_REMOTE_INT_CLR_REG(MBX_NO), 0x1U);
 
     /* Get a massage from the mailbox */
     metal_io_read32_with_check(shm.io, SHM_REMOTE_OFFSET(MBX_NO), &val);
+    bits = notify_bits(&ipi.notify_seen, val);
 
-    if (val >= RPVDEV_MAX_NUM) { /* val should have the notify_id of the sender */
+    if (!bits) { /* val should have the notify_id of the sender or notify counts */
+        if (val & NOTIFY_COUNT_FLAG)
+            return METAL_IRQ_HANDLED; /* Counted in the word read for an earlier doorbell */
+        rpmsg_stats_inc(ipi.stats, RPMSG_STATS_IRQS_SPURIOUS);
         return METAL_IRQ_NOT_HANDLED; /* Invalid message arrived */
     }
 
 #ifdef __linux__
-    ipi.notify_id = val;
+    __atomic_fetch_or(&ipi.notify_mask, bits, __ATOMIC_SEQ_CST);
     atomic_flag_clear(&ipi.sync);
     pthread_mutex_lock(&mutex);
     pthread_cond_signal(&cond);
     pthread_mutex_unlock(&mutex);
+    /* The vdevs of the channel share its interrupt */
+    for (i = 0; i < RSC_VDEV_NUM; i++)
+        rpmsg_vdev_notified(ipi.rpvdev[i]);
 #else /* uC3 */
-    if (ipi.ipi_sem_id[val] != E_ID) {
+    if ((val < RPVDEV_MAX_NUM) && (ipi.ipi_sem_id[val] != E_ID)) {
         isig_sem(ipi.ipi_sem_id[val]);
     }
     else
@@ -417,21 +489,81 @@ static int rz_proc_notify(struct remoteproc *rproc, uint32_t id)
 {
     struct remoteproc_priv *prproc = rproc->priv;
     unsigned int val = 0U;
-
-    /* Put a message saying "This is the notify_id of mine!" */
-    metal_io_write32_with_check(shm.io, SHM_LOCAL_OFFSET(MBX_NO), (uint64_t)prproc->notify_id);
+    unsigned int wait = 0U;
+
+    val = notify_count(&ipi.notify_sent, id);
+    if (val) {
+        /* Count the notify id, leaving the word as the latest count */
+        do {
+            metal_io_write32_with_check(shm.io, SHM_LOCAL_OFFSET(MBX_NO), (uint64_t)val);
+        } while (notify_count_stale(&ipi.notify_sent, &val));
+    } else {
+        /* Put a message saying "This is the notify_id of mine!" */
+        metal_io_write32_with_check(shm.io, SHM_LOCAL_OFFSET(MBX_NO), (uint64_t)prproc->notify_id);
+    }
 
     /* Check interrupt status: Has the previous message been received? */
     do {
         metal_io_read32_with_check(ipi.io, MBX_LOCAL_INT_STS_REG(MBX_NO), &val);
+        wait++;
     } while (0 != val && !force_stop);
+    if (wait > 1U) {
+        /* The previous doorbell was still pending when this one was requested */
+        rpmsg_stats_inc(prproc->stats, RPMSG_STATS_DOORBELLS_COALESCED);
+        rpmsg_stats_add(prproc->stats, RPMSG_STATS_NOTIFY_STS_WAITS, (uint64_t)(wait - 1U));
+    }
 
     /* Send notification */
     metal_io_write32_with_check(ipi.io, MBX_LOCAL_INT_SET_REG(MBX_NO), 0x1U);
+    rpmsg_stats_inc(prproc->stats, RPMSG_STATS_DOORBELLS);
+
+    return 0;
+}
+
+/*
+ * Event channel. A non-zero slot holds an event code not taken yet; the
+ * receiver clears it, then the interrupt status of the channel.
+ */
+int platform_event_send(uint32_t code)
+{
+    unsigned int val = 0U;
+    int wait = 0;
+
+    if (!code || !ipi.io || !shm.io)
+        return -1;
+
+    /* Has the previous event been taken? */
+    do {
+        metal_io_read32_with_check(ipi.io, MBX_LOCAL_INT_STS_REG(EVENT_MBX_NO), &val);
+        if ((wait++) > EVENT_SEND_WAIT) {
+            LPERROR("Event channel busy.");
+            return -1;
+        }
+    } while (0U != val);
+
+    metal_io_write32_with_check(shm.io, SHM_LOCAL_OFFSET(EVENT_MBX_NO), (uint64_t)code);
+    metal_io_write32_with_check(ipi.io, MBX_LOCAL_INT_SET_REG(EVENT_MBX_NO), 0x1U);
 
     return 0;
 }
 
+int platform_event_poll(uint32_t *code)
+{
+    unsigned int val = 0U;
+
+    if (!code || !ipi.io || !shm.io)
+        return -1;
+
+    metal_io_read32_with_check(shm.io, SHM_REMOTE_OFFSET(EVENT_MBX_NO), &val);
+    if (!val)
+        return 0;
+    metal_io_write32_with_check(shm.io, SHM_REMOTE_OFFSET(EVENT_MBX_NO), 0U);
+    metal_io_write32_with_check(ipi.io, MBX_REMOTE_INT_CLR_REG(EVENT_MBX_NO), 0x1U);
+    *code = val;
+
+    return 1;
+}
+
 #ifdef __linux__
 static void *
 rz_proc_mmap(struct remoteproc *rproc,
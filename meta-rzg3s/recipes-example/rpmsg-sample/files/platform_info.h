@@ -18,12 +18,15 @@
 #include <openamp/rpmsg.h>
 #include <openamp/remoteproc.h>
 #include "OpenAMP_RPMsg_cfg.h"
+#include "rpmsg_stats.h"
+
+struct rpmsg_vdev;
 #ifndef __linux__ /* uC3 */
 #include "RZG2_UC3.h"
 #include "kernel.h"
 #endif
 
-static inline pid_t gettid(void) {
+static inline pid_t platform_gettid(void) {
     return syscall(SYS_gettid);
 }
 // Macros for printf
@@ -35,7 +38,7 @@ extern pid_t g_tid_cm33;
 extern pid_t g_tid_cm33_fpu;
 #define LPRINTF(format, ...) \
 do { \
-    pid_t tid = gettid(); \
+    pid_t tid = platform_gettid(); \
     if (tid == g_tid_cm33) { \
         (void)printf("[CM33] " format "\n", ##__VA_ARGS__); \
     } else if(tid == g_tid_cm33_fpu) { \
@@ -136,9 +139,44 @@ do { \
 #define SHM_LOCAL_OFFSET(y)  (((1 << (y)) & MBX_SEND_TYPE_MSG_CHANNEL_MASK) ? (0x08U*(y) + 0x04U * MBX_LOCAL) : (0x08U*(y) + 0x04U * MBX_REMOTE))
 #define SHM_REMOTE_OFFSET(y) (((1 << (y)) & MBX_SEND_TYPE_MSG_CHANNEL_MASK) ? (0x08U*(y) + 0x04U * MBX_REMOTE) : (0x08U*(y) + 0x04U * MBX_LOCAL))
 
+// Event channel: a mailbox channel the vrings do not use (chn_info), carrying
+// 32-bit event codes in its shared memory slot, both ways (platform_event_send())
+#define EVENT_MBX_NO    (0x2U)
+
 // The number of maximum remoteproc vdevs
 #define RPVDEV_MAX_NUM (MBX_MAX_CHN)
 
+// rpmsg vdevs in the resource table of a channel (vdev_index 0 .. n - 1),
+// each with its own vring pair and notify ids; the remote firmware must
+// declare as many vdev entries
+#ifndef RSC_VDEV_NUM
+#define RSC_VDEV_NUM (1U)
+#endif
+
+// Cache line of the cores sharing the vrings. Vrings placed and aligned on
+// it keep the lines written by the driver (descriptors and avail ring) apart
+// from those written by the device (used ring)
+#define VRING_CACHE_LINE (64U)
+
+// Notification word in the shared memory slot, written by its sender only.
+// With NOTIFY_COUNT_FLAG set, field n of NOTIFY_COUNT_BITS bits counts the
+// notifications of notify id n. The receiver compares each field with the
+// word it saw last and checks the virtqueues whose count moved, so it never
+// writes the word and no notification is lost unless the sender notifies
+// one id 2^NOTIFY_COUNT_BITS times between two reads. Any other value is
+// the notify_id of the sender (legacy format) and all virtqueues are
+// checked; notify ids from NOTIFY_COUNT_IDS up are sent that way.
+#define NOTIFY_COUNT_FLAG   (0x80000000U)
+#define NOTIFY_COUNT_BITS   (7U)
+#define NOTIFY_COUNT_IDS    (4U)
+#define NOTIFY_COUNT_FIELD(id) (((1U << NOTIFY_COUNT_BITS) - 1U) << ((id) * NOTIFY_COUNT_BITS))
+// vdev feature bit: the remote offers it in dfeatures of its vdev entries
+// when it takes the counting format, the host sends that format from then
+// on and sets the bit in gfeatures. Both formats are always received.
+#define RPMSG_F_NOTIFY_COUNT (8U)
+// notify_mask value asking for all virtqueues
+#define NOTIFY_CHECK_ALL    (0x80000000U)
+
 /** @enum UIO_DEV - uio device index */
 enum UIO_DEV {
     UIO_MBX,
@@ -163,9 +201,13 @@ struct ipi_info {
     int registered;
     struct mbx_channel mbx_chn;
     unsigned int chn_mask; /**< IPI channel mask */
+    uint32_t notify_seen; /**< notification word of the remote seen last, counting format */
+    uint32_t notify_sent; /**< notification word of ours, 0 while sending the legacy format */
 #ifdef __linux__
     atomic_flag sync;
-    uint32_t notify_id;
+    uint32_t notify_mask; /**< pending notify ids, NOTIFY_CHECK_ALL to check all */
+    struct rpmsg_stats_channel *stats; /**< statistics of the channel in service */
+    struct rpmsg_vdev *rpvdev[RSC_VDEV_NUM]; /**< devices in service by vdev index, woken up on notification */
 #else
     ID ipi_sem_id[CFG_RPMSG_SVCNO];
 #endif
@@ -200,6 +242,7 @@ struct vring_info {
 struct remoteproc_priv {
     unsigned int notify_id;
     unsigned int mbx_chn_id;
+    struct rpmsg_stats_channel *stats; /**< statistics of the channel */
     struct shm_info *vr_info;
 };
 
@@ -273,4 +316,43 @@ void platform_release_rpmsg_vdev(struct remoteproc *platform, struct rpmsg_devic
  */
 void platform_cleanup(struct remoteproc *platform);
 
+/**
+ * platform_event_send - signal an event code to the remote
+ *
+ * Puts @code into the slot of the event channel, once the remote took the
+ * previous one, and rings the doorbell of the channel. No vring is
+ * involved, so an urgent event does not queue behind the messages.
+ *
+ * @code: event code, any value but 0
+ *
+ * return 0 for success, negative value if the remote does not take the
+ * previous event or the channel is not set up
+ */
+int platform_event_send(uint32_t code);
+
+/**
+ * platform_event_poll - take the event code signalled by the remote
+ *
+ * The event channel has no interrupt handler on Linux, the receiver polls
+ * the slot; taking the code lets the remote signal the next one.
+ *
+ * @code: pointer to store the event code
+ *
+ * return 1 if an event was taken, 0 if none is pending, negative value
+ * for errors
+ */
+int platform_event_poll(uint32_t *code);
+
+/**
+ * platform_event_wait - poll for an event code until one arrives
+ *
+ * Spins on platform_event_poll(), for a core dedicated to the caller.
+ *
+ * @code: pointer to store the event code
+ * @stop: returns once *stop is non-zero
+ *
+ * return 1 if an event was taken, 0 once stopped, negative value for errors
+ */
+int platform_event_wait(uint32_t *code, volatile int *stop);
+
 #endif /* PLATFORM_INFO_H_ */
@@ -0,0 +1,576 @@
+/**
+ * @file    rpmsg_bench.c
+ * @brief   Scaling benchmark of the TX submission path with 1-8 senders,
+ *          ping-pong over the vring layouts, gathered sends, packing and
+ *          wake-up latency of busy polling against a notification.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * Compares the former TX path (device lock, buffer copy and kick per
+ * message) with the submission queue (lock-free enqueue, one drainer, one
+ * kick per batch). The vring is a ring of RPMsg sized slots in local
+ * memory and the kick is a busy wait standing for the doorbell register
+ * write, so the benchmark runs without a remote core.
+ *
+ * With -l, a driver and a device thread on two cores exchange messages
+ * over a split vring in local cacheable memory instead, once with the used
+ * ring right behind the avail ring and once with each aligned on a cache
+ * line and on CFG_VRING_ALIGN. The ping-pong has one message in flight,
+ * the stream keeps the ring full. It shows what a shared line between the
+ * indices written by each core costs where the vrings are mapped
+ * cacheable; the UIO mappings of this sample are not.
+ *
+ * With -g, messages made of several pieces are either assembled in a local
+ * buffer and then copied into a slot, as an application does before
+ * rpmsg_send(), or gathered straight into the slot like
+ * rpmsg_vdev_sendv() does.
+ *
+ * With -p, small messages take a slot and a kick each, or are packed into
+ * slots with the rpmsg_pack framing and kicked once a slot is full.
+ *
+ * With -w, a device thread moves a used index now and then and the driver
+ * on another core notices it either by spinning on the index, like the
+ * busy polling mode of rpmsg_vdev, or by being woken up through a
+ * condition variable, like platform_poll() by the libmetal IRQ thread.
+ * The latency distribution leaves out what the hardware adds in interrupt
+ * mode (MHU, GIC, UIO and the IRQ thread wake-up), so it is a lower bound
+ * of the difference; the echo test (rpmsg_sample_client -p) measures both
+ * modes against the remote core.
+ */
+
+#define _GNU_SOURCE /* pthread_setaffinity_np() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <openamp/virtio_ring.h>
+#include "OpenAMP_RPMsg_cfg.h"
+#include "rpmsg_pack.h"
+#include "rpmsg_txq.h"
+
+#define BENCH_THREADS_MAX   (8U)
+#define BENCH_SLOT_SIZE     (512U)
+#define BENCH_SLOT_NUM      (256U)
+#define BENCH_HDR_SIZE      (16U)
+#define BENCH_CACHE_LINE    (64U)
+#define BENCH_VRING_NUM_MAX (1024U)
+#define BENCH_PIECES_MAX    (16U)
+#define BENCH_WAKE_GAP_US   (100U)
+
+/* Simulated send virtqueue */
+struct bench_ring {
+    unsigned char slot[BENCH_SLOT_NUM][BENCH_SLOT_SIZE];
+    unsigned int idx;
+    unsigned long kicks;
+};
+
+struct bench_req {
+    struct rpmsg_txq_node node;
+    const void *data;
+    int size;
+};
+
+static struct bench_ring ring;
+static struct rpmsg_txq txq;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t barrier;
+static unsigned long kick_ns = 300U;
+static unsigned long msgs = 200000U;
+static int msg_size = 64;
+static int use_txq;
+static unsigned int vring_num = 16U;
+static int yield_spin;
+
+/* Used index moved by the device thread of -w, and how the driver waits for it */
+static struct {
+    uint64_t stamp;         /* time of the last move */
+    uint16_t idx;
+    uint16_t seen;          /* last index taken by the driver */
+    int irq;                /* woken up through cond rather than spinning */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} wake = { .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+static void ring_put(const void *data, int size)
+{
+    unsigned char *buf = ring.slot[ring.idx++ % BENCH_SLOT_NUM];
+
+    memset(buf, 0, BENCH_HDR_SIZE);
+    memcpy(buf + BENCH_HDR_SIZE, data, size);
+}
+
+static void ring_kick(void)
+{
+    uint64_t end = now_ns() + kick_ns;
+
+    ring.kicks++;
+    while (now_ns() < end)
+        ;
+}
+
+static void bench_drain(void *arg, struct rpmsg_txq_node **nodes, unsigned int n)
+{
+    struct bench_req *req;
+    unsigned int i;
+
+    (void)arg;
+    for (i = 0; i < n; i++) {
+        req = (struct bench_req *)nodes[i];
+        ring_put(req->data, req->size);
+        req->node.result = req->size;
+    }
+    ring_kick();
+}
+
+static void *sender(void *arg)
+{
+    unsigned char data[BENCH_SLOT_SIZE];
+    struct bench_req req;
+    unsigned long i;
+
+    (void)arg;
+    memset(data, 0xA5, sizeof(data));
+    (void)pthread_barrier_wait(&barrier);
+
+    for (i = 0; i < msgs; i++) {
+        if (use_txq) {
+            req.data = data;
+            req.size = msg_size;
+            (void)rpmsg_txq_submit(&txq, &req.node);
+        } else {
+            pthread_mutex_lock(&lock);
+            ring_put(data, msg_size);
+            ring_kick();
+            pthread_mutex_unlock(&lock);
+        }
+    }
+
+    return NULL;
+}
+
+static void run(unsigned int nthreads)
+{
+    pthread_t th[BENCH_THREADS_MAX];
+    uint64_t start, elapsed;
+    unsigned long total = msgs * nthreads;
+    unsigned int i;
+
+    ring.idx = 0U;
+    ring.kicks = 0U;
+    rpmsg_txq_init(&txq, bench_drain, NULL);
+    (void)pthread_barrier_init(&barrier, NULL, nthreads + 1U);
+
+    for (i = 0; i < nthreads; i++)
+        (void)pthread_create(&th[i], NULL, sender, NULL);
+    (void)pthread_barrier_wait(&barrier);
+    start = now_ns();
+    for (i = 0; i < nthreads; i++)
+        (void)pthread_join(th[i], NULL);
+    elapsed = now_ns() - start;
+    (void)pthread_barrier_destroy(&barrier);
+
+    printf("%-5s %7u %12.0f %10.1f %12.2f\n", use_txq ? "txq" : "lock", nthreads,
+           (double)total * 1e9 / (double)elapsed, (double)elapsed / (double)total,
+           (double)total / (double)ring.kicks);
+}
+
+static void pin_cpu(int cpu)
+{
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    (void)pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/* Busy wait for the other core, giving way on a single core system */
+static void spin(void)
+{
+    if (yield_spin)
+        (void)sched_yield();
+}
+
+/* Device side: returns the buffers made available, in order */
+static void *vring_device(void *arg)
+{
+    struct vring *vr = arg;
+    uint16_t last = 0U, head;
+    unsigned long i;
+
+    pin_cpu(1);
+    (void)pthread_barrier_wait(&barrier);
+    for (i = 0; i < msgs; i++) {
+        while (__atomic_load_n(&vr->avail->idx, __ATOMIC_ACQUIRE) == last)
+            spin();
+        head = vr->avail->ring[last % vr->num];
+        vr->used->ring[last % vr->num].id = head;
+        vr->used->ring[last % vr->num].len = vr->desc[head].len;
+        last++;
+        __atomic_store_n(&vr->used->idx, last, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+/* Driver side: keeps up to @inflight buffers available, returns ns per message */
+static double vring_driver(struct vring *vr, unsigned int inflight)
+{
+    uint16_t idx = 0U, used = 0U, head;
+    uint64_t start;
+    unsigned long i;
+
+    (void)pthread_barrier_wait(&barrier);
+    start = now_ns();
+    for (i = 0; i < msgs; i++) {
+        while ((uint16_t)(idx - used) >= inflight) {
+            used = __atomic_load_n(&vr->used->idx, __ATOMIC_ACQUIRE);
+            if ((uint16_t)(idx - used) >= inflight)
+                spin();
+        }
+        head = idx % vr->num;
+        vr->desc[head].addr = (uint64_t)head * BENCH_SLOT_SIZE;
+        vr->desc[head].len = (uint32_t)msg_size;
+        vr->desc[head].flags = 0U;
+        vr->avail->ring[idx % vr->num] = head;
+        idx++;
+        __atomic_store_n(&vr->avail->idx, idx, __ATOMIC_RELEASE);
+    }
+    while (__atomic_load_n(&vr->used->idx, __ATOMIC_ACQUIRE) != idx)
+        spin();
+
+    return (double)(now_ns() - start) / (double)msgs;
+}
+
+static void run_vring(unsigned long align)
+{
+    struct vring vr;
+    pthread_t th;
+    void *mem;
+    double ns[2];
+    unsigned int pass;
+    int shared;
+
+    if (posix_memalign(&mem, 0x1000U, (size_t)vring_size(vring_num, align)))
+        return;
+
+    for (pass = 0; pass < 2; pass++) {
+        memset(mem, 0, (size_t)vring_size(vring_num, align));
+        vring_init(&vr, vring_num, mem, align);
+        (void)pthread_barrier_init(&barrier, NULL, 2U);
+        (void)pthread_create(&th, NULL, vring_device, &vr);
+        ns[pass] = vring_driver(&vr, pass ? vring_num : 1U);
+        (void)pthread_join(th, NULL);
+        (void)pthread_barrier_destroy(&barrier);
+    }
+
+    /* The line holding the end of the avail ring also holds the used index */
+    shared = ((uintptr_t)&vr.avail->ring[vring_num] / BENCH_CACHE_LINE) ==
+             ((uintptr_t)&vr.used->idx / BENCH_CACHE_LINE);
+    printf("%5lu %6s %16.1f %14.0f\n", align, shared ? "yes" : "no", ns[0], 1e9 / ns[1]);
+    free(mem);
+}
+
+/* Copy the pieces of a message one after the other */
+static void gather(unsigned char *buf, const struct iovec *iov, unsigned int n)
+{
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        memcpy(buf, iov[i].iov_base, iov[i].iov_len);
+        buf += iov[i].iov_len;
+    }
+}
+
+static void run_gather(unsigned int pieces)
+{
+    static unsigned char data[BENCH_SLOT_SIZE];
+    unsigned char local[BENCH_SLOT_SIZE];
+    struct iovec iov[BENCH_PIECES_MAX];
+    unsigned char *buf;
+    uint64_t start;
+    double ns[2];
+    unsigned long i;
+    unsigned int k;
+    size_t off = 0U;
+
+    /* Even pieces, the last one takes the rest */
+    memset(data, 0xA5, sizeof(data));
+    for (k = 0; k < pieces; k++) {
+        iov[k].iov_base = data + off;
+        iov[k].iov_len = (k == pieces - 1U) ? (size_t)msg_size - off : (size_t)msg_size / pieces;
+        off += iov[k].iov_len;
+    }
+
+    ring.idx = 0U;
+    start = now_ns();
+    for (i = 0; i < msgs; i++) {
+        gather(local, iov, pieces);
+        ring_put(local, msg_size);
+    }
+    ns[0] = (double)(now_ns() - start) / (double)msgs;
+
+    ring.idx = 0U;
+    start = now_ns();
+    for (i = 0; i < msgs; i++) {
+        buf = ring.slot[ring.idx++ % BENCH_SLOT_NUM];
+        memset(buf, 0, BENCH_HDR_SIZE);
+        gather(buf + BENCH_HDR_SIZE, iov, pieces);
+    }
+    ns[1] = (double)(now_ns() - start) / (double)msgs;
+
+    printf("%6u %5d %14.1f %14.1f\n", pieces, msg_size, ns[0], ns[1]);
+}
+
+static void run_pack(void)
+{
+    static unsigned char data[BENCH_SLOT_SIZE];
+    unsigned char *buf = NULL;
+    uint32_t used = 0U;
+    uint64_t start;
+    double rate[2];
+    unsigned long i;
+
+    memset(data, 0xA5, sizeof(data));
+
+    ring.idx = 0U;
+    ring.kicks = 0U;
+    start = now_ns();
+    for (i = 0; i < msgs; i++) {
+        ring_put(data, msg_size);
+        ring_kick();
+    }
+    rate[0] = (double)msgs * 1e9 / (double)(now_ns() - start);
+
+    ring.idx = 0U;
+    ring.kicks = 0U;
+    start = now_ns();
+    for (i = 0; i < msgs; i++) {
+        if (buf && !rpmsg_pack_put(buf + BENCH_HDR_SIZE, BENCH_SLOT_SIZE - BENCH_HDR_SIZE, &used,
+                                   data, (uint32_t)msg_size))
+            continue;
+        if (buf)
+            ring_kick();
+        buf = ring.slot[ring.idx++ % BENCH_SLOT_NUM];
+        memset(buf, 0, BENCH_HDR_SIZE);
+        used = 0U;
+        (void)rpmsg_pack_put(buf + BENCH_HDR_SIZE, BENCH_SLOT_SIZE - BENCH_HDR_SIZE, &used,
+                             data, (uint32_t)msg_size);
+    }
+    if (buf)
+        ring_kick();
+    rate[1] = (double)msgs * 1e9 / (double)(now_ns() - start);
+
+    printf("%5d %14.0f %14.0f %10.1f\n", msg_size, rate[0], rate[1], (double)msgs / (double)ring.kicks);
+}
+
+/* Device side of -w: moves the index once the driver took the previous move */
+static void *wake_device(void *arg)
+{
+    uint16_t idx;
+    unsigned long i;
+
+    (void)arg;
+    pin_cpu(1);
+    (void)pthread_barrier_wait(&barrier);
+    for (i = 0; i < msgs; i++) {
+        /* Long enough for the driver to block */
+        (void)usleep(BENCH_WAKE_GAP_US);
+        idx = (uint16_t)(i + 1U);
+        __atomic_store_n(&wake.stamp, now_ns(), __ATOMIC_RELAXED);
+        __atomic_store_n(&wake.idx, idx, __ATOMIC_RELEASE);
+        if (wake.irq) {
+            pthread_mutex_lock(&wake.lock);
+            pthread_cond_signal(&wake.cond);
+            pthread_mutex_unlock(&wake.lock);
+        }
+        while (__atomic_load_n(&wake.seen, __ATOMIC_ACQUIRE) != idx)
+            spin();
+    }
+
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void run_wake(int irq, uint64_t *lat)
+{
+    pthread_t th;
+    uint16_t idx = 0U;
+    unsigned long i;
+
+    wake.idx = 0U;
+    wake.seen = 0U;
+    wake.irq = irq;
+    (void)pthread_barrier_init(&barrier, NULL, 2U);
+    (void)pthread_create(&th, NULL, wake_device, NULL);
+    pin_cpu(0);
+    (void)pthread_barrier_wait(&barrier);
+    for (i = 0; i < msgs; i++) {
+        if (irq) {
+            pthread_mutex_lock(&wake.lock);
+            while ((idx = __atomic_load_n(&wake.idx, __ATOMIC_ACQUIRE)) == wake.seen)
+                pthread_cond_wait(&wake.cond, &wake.lock);
+            pthread_mutex_unlock(&wake.lock);
+        } else {
+            while ((idx = __atomic_load_n(&wake.idx, __ATOMIC_ACQUIRE)) == wake.seen)
+                spin();
+        }
+        lat[i] = now_ns() - __atomic_load_n(&wake.stamp, __ATOMIC_RELAXED);
+        __atomic_store_n(&wake.seen, idx, __ATOMIC_RELEASE);
+    }
+    (void)pthread_join(th, NULL);
+    (void)pthread_barrier_destroy(&barrier);
+
+    qsort(lat, msgs, sizeof(*lat), cmp_u64);
+    printf("%-5s %9lu %9lu %9lu %9lu %9lu\n", irq ? "wake" : "poll",
+           (unsigned long)lat[msgs / 2U], (unsigned long)lat[msgs * 90U / 100U],
+           (unsigned long)lat[msgs * 99U / 100U], (unsigned long)lat[msgs * 999U / 1000U],
+           (unsigned long)lat[msgs - 1U]);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-t max_threads] [-n msgs_per_thread] [-s size] [-k kick_ns]\n"
+                    "       %s -l [-q vring_num] [-n msgs] [-s size]\n"
+                    "       %s -g pieces [-n msgs] [-s size]\n"
+                    "       %s -p [-n msgs] [-s size] [-k kick_ns]\n"
+                    "       %s -w samples\n", prog, prog, prog, prog, prog);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int max_threads = BENCH_THREADS_MAX;
+    unsigned int n;
+    int layout = 0;
+    int pack = 0;
+    unsigned long samples = 0U;
+    uint64_t *lat;
+    unsigned int pieces = 0U;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:n:s:k:lq:g:pw:h")) != -1) {
+        switch (opt) {
+        case 't':
+            max_threads = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            msgs = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            msg_size = atoi(optarg);
+            break;
+        case 'k':
+            kick_ns = strtoul(optarg, NULL, 0);
+            break;
+        case 'l':
+            layout = 1;
+            break;
+        case 'q':
+            vring_num = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            pack = 1;
+            break;
+        case 'w':
+            samples = strtoul(optarg, NULL, 0);
+            if (!samples) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'g':
+            pieces = (unsigned int)strtoul(optarg, NULL, 0);
+            if (!pieces || (pieces > BENCH_PIECES_MAX)) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (!max_threads || (max_threads > BENCH_THREADS_MAX) || !msgs ||
+        (msg_size < 0) || (msg_size > (int)(BENCH_SLOT_SIZE - BENCH_HDR_SIZE)) ||
+        !vring_num || (vring_num > BENCH_VRING_NUM_MAX) || (vring_num & (vring_num - 1U))) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (samples) {
+        lat = malloc(samples * sizeof(*lat));
+        if (!lat)
+            return 1;
+        if (sysconf(_SC_NPROCESSORS_ONLN) < 2) {
+            fprintf(stderr, "single core: the driver cannot spin while the device runs\n");
+            yield_spin = 1;
+        }
+        msgs = samples;
+        printf("%-5s %9s %9s %9s %9s %9s\n", "mode", "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "max ns");
+        run_wake(0, lat);
+        run_wake(1, lat);
+        free(lat);
+        return 0;
+    }
+
+    if (pack) {
+        if (msg_size > (int)RPMSG_PACK_MSG_MAX) {
+            usage(argv[0]);
+            return 1;
+        }
+        printf("%5s %14s %14s %10s\n", "size", "single msgs/s", "packed msgs/s", "msgs/kick");
+        run_pack();
+        return 0;
+    }
+
+    if (pieces) {
+        printf("%6s %5s %14s %14s\n", "pieces", "size", "copy ns/msg", "gather ns/msg");
+        run_gather(pieces);
+        return 0;
+    }
+
+    if (layout) {
+        if (sysconf(_SC_NPROCESSORS_ONLN) < 2) {
+            fprintf(stderr, "single core: the figures do not show any cache line transfer\n");
+            yield_spin = 1;
+        }
+        printf("vring_num %u\n", vring_num);
+        printf("%5s %6s %16s %14s\n", "align", "shared", "pingpong ns/msg", "stream msgs/s");
+        run_vring(sizeof(uint32_t));
+        run_vring(BENCH_CACHE_LINE);
+        run_vring(CFG_VRING_ALIGN0);
+        return 0;
+    }
+
+    printf("%-5s %7s %12s %10s %12s\n", "path", "threads", "msgs/s", "ns/msg", "msgs/kick");
+    for (use_txq = 0; use_txq < 2; use_txq++) {
+        for (n = 1U; n <= max_threads; n++)
+            run(n);
+    }
+
+    return 0;
+}
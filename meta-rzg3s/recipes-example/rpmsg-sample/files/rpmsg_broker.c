@@ -0,0 +1,528 @@
+/**
+ * @file    rpmsg_broker.c
+ * @brief   Broker sharing one rpmsg device between Linux processes.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#define _GNU_SOURCE /* accept4(), memfd_create() */
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "platform_info.h"
+#include "rpmsg_vdev.h"
+#include "rpmsg_poller.h"
+#include "rpmsg_serve.h"
+#include "rpmsg_broker.h"
+
+// Messages moved per client and direction in one turn
+#define BROKER_BATCH    (16U)
+// Listening socket, poller event, TX space event, then two per client
+#define BROKER_PFD_MAX  (3U + (2U * RPMSG_BROKER_CLIENT_MAX))
+
+/**
+ * @struct broker_client
+ * @brief  client process and its endpoint
+ */
+struct broker_client {
+    int sock;                       /**< connection, -1 when the entry is free */
+    int kick_fd;                    /**< written by the client */
+    int wake_fd;                    /**< written by the broker */
+    struct rpmsg_broker_shm *shm;   /**< NULL until the endpoint is open */
+    struct rpmsg_endpoint ept;
+    int tx_blocked;                 /**< no TX buffer, waiting for the TX ready callback */
+};
+
+/**
+ * @struct broker_name
+ * @brief  name service announcement of the remote side
+ */
+struct broker_name {
+    char name[RPMSG_NAME_SIZE];
+    uint32_t dest;
+};
+
+/**
+ * @struct broker
+ * @brief  broker of one device, only used by the thread running it
+ */
+struct broker {
+    struct rpmsg_device *rdev;
+    struct rpmsg_poller poller;
+    int listen_fd;
+    struct broker_client client[RPMSG_BROKER_CLIENT_MAX];
+    struct broker_name names[RPMSG_BROKER_NAME_MAX];
+    unsigned int names_num;
+};
+
+/* Running brokers, for the name service callback */
+static struct rpmsg_serve_registry brokers = RPMSG_SERVE_REGISTRY_INITIALIZER;
+
+/* Called on the broker thread, from rpmsg_poller_run() or a receive */
+void rpmsg_broker_ns_bind(struct rpmsg_device *rdev, const char *name, uint32_t dest)
+{
+    struct broker *b;
+    unsigned int i;
+
+    b = rpmsg_serve_find(&brokers, rdev);
+    if (!b)
+        return;
+
+    /* No endpoint has this name yet: remember it for the next open */
+    for (i = 0; i < b->names_num; i++) {
+        if (!strncmp(b->names[i].name, name, RPMSG_NAME_SIZE))
+            break;
+    }
+    if (i == RPMSG_BROKER_NAME_MAX) {
+        LPERROR("Too many name services, %s is ignored.", name);
+        return;
+    }
+    if (i == b->names_num) {
+        strncpy(b->names[i].name, name, RPMSG_NAME_SIZE - 1);
+        b->names[i].name[RPMSG_NAME_SIZE - 1] = '\0';
+        b->names_num++;
+    }
+    b->names[i].dest = dest;
+}
+
+static uint32_t broker_name_dest(struct broker *b, const char *name)
+{
+    unsigned int i;
+
+    for (i = 0; i < b->names_num; i++) {
+        if (!strncmp(b->names[i].name, name, RPMSG_NAME_SIZE))
+            return b->names[i].dest;
+    }
+
+    return RPMSG_ADDR_ANY;
+}
+
+static void broker_tx_ready(struct rpmsg_endpoint *ept, void *priv)
+{
+    struct broker_client *c = priv;
+
+    (void)ept;
+    c->tx_blocked = 0;
+}
+
+static void broker_wake(struct broker_client *c)
+{
+    uint64_t one = 1;
+
+    (void)write(c->wake_fd, &one, sizeof(one));
+}
+
+static int broker_reply(int sock, int status, uint32_t src, const int *fds, unsigned int nfds)
+{
+    struct rpmsg_broker_reply reply;
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int) * RPMSG_BROKER_FDS)];
+    } ctl;
+
+    reply.status = status;
+    reply.src = src;
+    iov.iov_base = &reply;
+    iov.iov_len = sizeof(reply);
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (nfds) {
+        msg.msg_control = ctl.buf;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+        cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+    }
+
+    return (sendmsg(sock, &msg, MSG_NOSIGNAL) == (ssize_t)sizeof(reply)) ? 0 : -errno;
+}
+
+static void broker_client_close(struct broker_client *c)
+{
+    if (c->shm) {
+        (void)rpmsg_vdev_set_tx_ready_cb(&c->ept, NULL, NULL);
+        rpmsg_vdev_pull_disable(&c->ept);
+        rpmsg_destroy_ept(&c->ept);
+        (void)munmap(c->shm, sizeof(*c->shm));
+        c->shm = NULL;
+    }
+    if (c->kick_fd >= 0)
+        (void)close(c->kick_fd);
+    if (c->wake_fd >= 0)
+        (void)close(c->wake_fd);
+    if (c->sock >= 0)
+        (void)close(c->sock);
+    c->kick_fd = -1;
+    c->wake_fd = -1;
+    c->sock = -1;
+}
+
+static int broker_client_open(struct broker *b, struct broker_client *c, const struct rpmsg_broker_open *req)
+{
+    struct rpmsg_broker_shm *shm;
+    char name[RPMSG_NAME_SIZE];
+    uint32_t dst = req->dst;
+    unsigned int i;
+    int fds[RPMSG_BROKER_FDS];
+    int memfd, ret;
+
+    if (req->version != RPMSG_BROKER_VERSION)
+        return RPMSG_ERR_PARAM;
+    memcpy(name, req->name, sizeof(name));
+    name[sizeof(name) - 1] = '\0';
+
+    /* A name service announcement would only bind one of them */
+    for (i = 0; i < RPMSG_BROKER_CLIENT_MAX; i++) {
+        if (b->client[i].shm && !strncmp(b->client[i].ept.name, name, RPMSG_NAME_SIZE))
+            return -EBUSY;
+    }
+    if (dst == RPMSG_ADDR_ANY)
+        dst = broker_name_dest(b, name);
+
+    memfd = memfd_create("rpmsg-broker", MFD_CLOEXEC);
+    if (memfd < 0)
+        return -errno;
+    if (ftruncate(memfd, sizeof(*shm))) {
+        ret = -errno;
+        (void)close(memfd);
+        return ret;
+    }
+    shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (shm == MAP_FAILED) {
+        ret = -errno;
+        (void)close(memfd);
+        return ret;
+    }
+    shm->version = RPMSG_BROKER_VERSION;
+    shm->dst = RPMSG_ADDR_ANY;
+    c->kick_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    c->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((c->kick_fd < 0) || (c->wake_fd < 0)) {
+        ret = -errno;
+        goto err_unmap;
+    }
+
+    ret = rpmsg_create_ept(&c->ept, b->rdev, name, req->src, dst, rpmsg_serve_ept_cb, rpmsg_serve_unbind_cb);
+    if (ret)
+        goto err_unmap;
+    ret = rpmsg_vdev_pull_enable(&c->ept);
+    if (!ret)
+        ret = rpmsg_vdev_set_tx_ready_cb(&c->ept, broker_tx_ready, c);
+    if (ret) {
+        rpmsg_vdev_pull_disable(&c->ept);
+        rpmsg_destroy_ept(&c->ept);
+        goto err_unmap;
+    }
+    c->shm = shm;
+    c->tx_blocked = 0;
+
+    fds[0] = memfd;
+    fds[1] = c->kick_fd;
+    fds[2] = c->wake_fd;
+    ret = broker_reply(c->sock, 0, c->ept.addr, fds, RPMSG_BROKER_FDS);
+    (void)close(memfd);
+    if (ret)
+        broker_client_close(c);
+
+    return ret;
+
+err_unmap:
+    (void)munmap(shm, sizeof(*shm));
+    (void)close(memfd);
+    return ret;
+}
+
+/* Handle a request or the hangup of a client */
+static void broker_client_input(struct broker *b, struct broker_client *c)
+{
+    struct rpmsg_broker_open req;
+    ssize_t len;
+    int ret;
+
+    len = recv(c->sock, &req, sizeof(req), 0);
+    if ((len < 0) && ((errno == EAGAIN) || (errno == EINTR)))
+        return;
+    if (len <= 0) {
+        broker_client_close(c);
+        return;
+    }
+    if (c->shm)
+        return;
+
+    ret = (len == (ssize_t)sizeof(req)) ? broker_client_open(b, c, &req) : RPMSG_ERR_PARAM;
+    if (ret) {
+        LPERROR("Failed to open endpoint for a client: %d.", ret);
+        (void)broker_reply(c->sock, ret, RPMSG_ADDR_ANY, NULL, 0);
+        broker_client_close(c);
+    }
+}
+
+static void broker_accept(struct broker *b)
+{
+    unsigned int i;
+    int fd;
+
+    while ((fd = accept4(b->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        for (i = 0; i < RPMSG_BROKER_CLIENT_MAX; i++) {
+            if (b->client[i].sock < 0)
+                break;
+        }
+        if (i == RPMSG_BROKER_CLIENT_MAX) {
+            LPERROR("Too many clients.");
+            (void)broker_reply(fd, -ENOSPC, RPMSG_ADDR_ANY, NULL, 0);
+            (void)close(fd);
+            continue;
+        }
+        b->client[i].sock = fd;
+    }
+}
+
+/*
+ * Send the messages of the client TX ring. Returns 1 if some are left for
+ * the next turn, 0 if the ring is empty or the client has to wait, and
+ * negative if the ring is corrupt.
+ */
+static int broker_pump_tx(struct broker_client *c)
+{
+    struct rpmsg_broker_ring *r = &c->shm->tx;
+    struct rpmsg_broker_slot *slot;
+    uint32_t i, n, len, dst;
+    void *buf;
+    int ret, stalled = 0;
+
+    for (;;) {
+        n = rpmsg_broker_ring_count(r);
+        if (n > RPMSG_BROKER_SLOTS)
+            return -EPROTO;
+        if (!n) {
+            if (rpmsg_broker_ring_wait_data(r))
+                return 0;
+            continue;
+        }
+        if (n > BROKER_BATCH)
+            n = BROKER_BATCH;
+
+        for (i = 0; i < n; i++) {
+            slot = rpmsg_broker_ring_used_slot(r, i);
+            len = slot->len;
+            dst = slot->addr;
+            if (len > RPMSG_BROKER_MSG_MAX)
+                return -EPROTO;
+            /* Kept until the remote side binds the endpoint */
+            if ((dst == RPMSG_ADDR_ANY) && (c->ept.dest_addr == RPMSG_ADDR_ANY)) {
+                stalled = 1;
+                break;
+            }
+            buf = rpmsg_vdev_get_tx_buffer(&c->ept, NULL, 0);
+            if (!buf) {
+                c->tx_blocked = 1;
+                stalled = 1;
+                break;
+            }
+            memcpy(buf, slot->data, len);
+            if (dst == RPMSG_ADDR_ANY)
+                ret = rpmsg_vdev_send_nocopy(&c->ept, buf, (int)len);
+            else
+                ret = rpmsg_vdev_sendto_nocopy(&c->ept, buf, (int)len, dst);
+            if ((ret == RPMSG_ERR_PARAM) || (ret == RPMSG_ERR_BUFF_SIZE))
+                rpmsg_vdev_release_tx_buffer(&c->ept, buf);
+            if (ret < 0)
+                LPERROR("Failed to send for %s: %d.", c->ept.name, ret);
+        }
+        if (i && rpmsg_broker_ring_release(r, i))
+            broker_wake(c);
+        if (stalled)
+            return 0;
+        if (n == BROKER_BATCH)
+            return 1;
+    }
+}
+
+/*
+ * Move received messages into the client RX ring. Same return values as
+ * broker_pump_tx().
+ */
+static int broker_pump_rx(struct broker_client *c)
+{
+    struct rpmsg_broker_ring *r = &c->shm->rx;
+    struct rpmsg_broker_slot *slot;
+    struct rpmsg_vdev_msg msgs[BROKER_BATCH];
+    uint32_t space, len;
+    int i, n;
+
+    space = rpmsg_broker_ring_space(r);
+    if (space > RPMSG_BROKER_SLOTS)
+        return -EPROTO;
+    /* The messages wait in their vring buffers until the client reads */
+    if (!space && rpmsg_broker_ring_wait_space(r))
+        return 0;
+    space = rpmsg_broker_ring_space(r);
+    if (space > BROKER_BATCH)
+        space = BROKER_BATCH;
+
+    n = rpmsg_vdev_recv_batch(&c->ept, msgs, space, 0);
+    if (n <= 0)
+        return 0;
+
+    for (i = 0; i < n; i++) {
+        slot = rpmsg_broker_ring_free_slot(r, (uint32_t)i);
+        len = (msgs[i].len < RPMSG_BROKER_MSG_MAX) ? msgs[i].len : RPMSG_BROKER_MSG_MAX;
+        slot->len = len;
+        slot->addr = msgs[i].src;
+        memcpy(slot->data, msgs[i].data, len);
+    }
+    rpmsg_vdev_recv_release(&c->ept, msgs, (unsigned int)n);
+    if (rpmsg_broker_ring_commit(r, (uint32_t)n))
+        broker_wake(c);
+
+    return ((uint32_t)n == space) ? 1 : 0;
+}
+
+/* Serve one client, return 1 if it has work left for the next turn */
+static int broker_serve(struct broker_client *c)
+{
+    uint32_t dst = c->ept.dest_addr;
+    int tx = 0, rx;
+
+    if (__atomic_load_n(&c->shm->dst, __ATOMIC_RELAXED) != dst) {
+        __atomic_store_n(&c->shm->dst, dst, __ATOMIC_RELEASE);
+        broker_wake(c);
+    }
+
+    if (!c->tx_blocked)
+        tx = broker_pump_tx(c);
+    rx = broker_pump_rx(c);
+    if ((tx < 0) || (rx < 0)) {
+        LPERROR("Corrupt rings for %s, closing.", c->ept.name);
+        broker_client_close(c);
+        return 0;
+    }
+
+    return tx || rx;
+}
+
+int rpmsg_broker_run(struct rpmsg_device *rdev, const char *path, volatile int *stop)
+{
+    struct broker *b;
+    struct pollfd pfd[BROKER_PFD_MAX];
+    int sock_pfd[RPMSG_BROKER_CLIENT_MAX], kick_pfd[RPMSG_BROKER_CLIENT_MAX];
+    struct broker_client *c;
+    unsigned int i, n;
+    uint64_t cnt;
+    int ret, more = 0;
+
+    if (!rdev || !path || !stop)
+        return RPMSG_ERR_PARAM;
+
+    b = calloc(1, sizeof(*b));
+    if (!b)
+        return RPMSG_ERR_NO_MEM;
+    b->rdev = rdev;
+    for (i = 0; i < RPMSG_BROKER_CLIENT_MAX; i++) {
+        b->client[i].sock = -1;
+        b->client[i].kick_fd = -1;
+        b->client[i].wake_fd = -1;
+    }
+
+    b->listen_fd = rpmsg_serve_listen(path);
+    if (b->listen_fd < 0) {
+        ret = b->listen_fd;
+        LPERROR("Failed to listen on %s: %d.", path, ret);
+        goto err_free;
+    }
+    ret = rpmsg_poller_init(&b->poller);
+    if (ret)
+        goto err_close;
+    ret = rpmsg_serve_register(&brokers, rdev, b);
+    if (ret)
+        goto err_poller;
+    ret = rpmsg_poller_add(&b->poller, rdev, 0);
+    if (ret)
+        goto err_unregister;
+    LPRINTF("rpmsg broker listening on %s.", path);
+
+    while (!*stop) {
+        n = 0;
+        pfd[n++] = (struct pollfd){ b->listen_fd, POLLIN, 0 };
+        pfd[n++] = (struct pollfd){ rpmsg_poller_fd(&b->poller), POLLIN, 0 };
+        pfd[n++] = (struct pollfd){ rpmsg_vdev_tx_fd(rdev), POLLIN, 0 };
+        for (i = 0; i < RPMSG_BROKER_CLIENT_MAX; i++) {
+            c = &b->client[i];
+            sock_pfd[i] = kick_pfd[i] = -1;
+            if (c->sock < 0)
+                continue;
+            sock_pfd[i] = (int)n;
+            pfd[n++] = (struct pollfd){ c->sock, POLLIN, 0 };
+            if (c->shm) {
+                kick_pfd[i] = (int)n;
+                pfd[n++] = (struct pollfd){ c->kick_fd, POLLIN, 0 };
+            }
+        }
+
+        ret = poll(pfd, n, more ? 0 : RPMSG_BROKER_STOP_CHECK_MS);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            ret = -errno;
+            break;
+        }
+        ret = 0;
+
+        /* Received messages go to the pull queues of the endpoints */
+        if (pfd[1].revents & POLLIN)
+            (void)rpmsg_poller_run(&b->poller);
+        if (pfd[2].revents & POLLIN)
+            rpmsg_vdev_tx_dispatch(rdev);
+        for (i = 0; i < RPMSG_BROKER_CLIENT_MAX; i++) {
+            c = &b->client[i];
+            if ((kick_pfd[i] >= 0) && (pfd[kick_pfd[i]].revents & POLLIN))
+                (void)read(c->kick_fd, &cnt, sizeof(cnt));
+            if ((sock_pfd[i] >= 0) && pfd[sock_pfd[i]].revents)
+                broker_client_input(b, c);
+        }
+        if (pfd[0].revents & POLLIN)
+            broker_accept(b);
+
+        more = 0;
+        for (i = 0; i < RPMSG_BROKER_CLIENT_MAX; i++) {
+            if (b->client[i].shm)
+                more |= broker_serve(&b->client[i]);
+        }
+    }
+
+    for (i = 0; i < RPMSG_BROKER_CLIENT_MAX; i++)
+        broker_client_close(&b->client[i]);
+    rpmsg_poller_remove(&b->poller, rdev);
+err_unregister:
+    rpmsg_serve_unregister(&brokers, b);
+err_poller:
+    rpmsg_poller_deinit(&b->poller);
+err_close:
+    (void)close(b->listen_fd);
+    (void)unlink(path);
+err_free:
+    free(b);
+
+    return ret;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file    rpmsg_broker_client.h
+ * @brief   Client side of the rpmsg broker.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * Opens an endpoint through a running broker (rpmsg_sample_client -b) and
+ * exchanges messages with the remote side through shared memory. The
+ * client needs neither libmetal nor open-amp. A channel is used by one
+ * thread at a time.
+ *
+ * @code
+ *     struct rpmsg_broker_chan ch;
+ *     struct rpmsg_broker_msg msg;
+ *     void *buf;
+ *
+ *     snprintf(path, sizeof(path), RPMSG_BROKER_PATH_FMT, 0UL);
+ *     rpmsg_broker_open(&ch, path, "rpmsg-service-0", RPMSG_BROKER_ADDR_ANY, RPMSG_BROKER_ADDR_ANY);
+ *     rpmsg_broker_wait_ready(&ch, -1);
+ *
+ *     buf = rpmsg_broker_get_tx_buffer(&ch, -1);
+ *     len = build_request(buf);
+ *     rpmsg_broker_send_nocopy(&ch, buf, len, RPMSG_BROKER_ADDR_ANY);
+ *
+ *     if (rpmsg_broker_recv(&ch, &msg, 1, 100) > 0) {
+ *         handle(msg.data, msg.len);
+ *         rpmsg_broker_recv_release(&ch, 1);
+ *     }
+ *     rpmsg_broker_close(&ch);
+ * @endcode
+ */
+
+#ifndef RPMSG_BROKER_CLIENT_H_
+#define RPMSG_BROKER_CLIENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rpmsg_broker_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct rpmsg_broker_chan
+ * @brief  endpoint opened through the broker
+ */
+struct rpmsg_broker_chan {
+    int sock;                       /**< connection to the broker */
+    int kick_fd;                    /**< wakes the broker */
+    int wake_fd;                    /**< woken by the broker */
+    struct rpmsg_broker_shm *shm;
+    uint32_t src;                   /**< address of the endpoint */
+};
+
+/**
+ * @struct rpmsg_broker_msg
+ * @brief  received message, in the shared memory until released
+ */
+struct rpmsg_broker_msg {
+    const void *data;
+    uint32_t len;
+    uint32_t src;
+};
+
+/**
+ * rpmsg_broker_open - open an endpoint through the broker
+ *
+ * @ch: channel
+ * @path: socket of the broker, see RPMSG_BROKER_PATH_FMT
+ * @name: service name
+ * @src: local address, or RPMSG_BROKER_ADDR_ANY
+ * @dst: remote address, or RPMSG_BROKER_ADDR_ANY to bind by name
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_broker_open(struct rpmsg_broker_chan *ch, const char *path, const char *name,
+                      uint32_t src, uint32_t dst);
+
+/**
+ * rpmsg_broker_close - close the endpoint
+ *
+ * @ch: channel
+ */
+void rpmsg_broker_close(struct rpmsg_broker_chan *ch);
+
+/**
+ * rpmsg_broker_ready - whether the endpoint is bound to a remote address
+ */
+int rpmsg_broker_ready(struct rpmsg_broker_chan *ch);
+
+/**
+ * rpmsg_broker_wait_ready - wait for the remote side to bind the endpoint
+ *
+ * @ch: channel
+ * @timeout_ms: timeout, negative to wait forever
+ *
+ * return 0 when bound, -ETIMEDOUT, or another negative value on failure
+ */
+int rpmsg_broker_wait_ready(struct rpmsg_broker_chan *ch, int timeout_ms);
+
+/**
+ * rpmsg_broker_get_tx_buffer - buffer to build the next message in
+ *
+ * The buffer is in the shared memory and holds RPMSG_BROKER_MSG_MAX
+ * bytes. It stays the same until it is sent.
+ *
+ * @ch: channel
+ * @timeout_ms: time to wait while the broker holds every buffer, negative
+ *              to wait forever
+ *
+ * return buffer, NULL on timeout or failure
+ */
+void *rpmsg_broker_get_tx_buffer(struct rpmsg_broker_chan *ch, int timeout_ms);
+
+/**
+ * rpmsg_broker_send_nocopy - send the buffer of rpmsg_broker_get_tx_buffer()
+ *
+ * Messages to the bound address wait in the ring until the remote side
+ * binds the endpoint.
+ *
+ * @ch: channel
+ * @data: buffer
+ * @len: message length
+ * @dst: destination, RPMSG_BROKER_ADDR_ANY for the bound address
+ *
+ * return len on success, negative value on failure
+ */
+int rpmsg_broker_send_nocopy(struct rpmsg_broker_chan *ch, void *data, uint32_t len, uint32_t dst);
+
+/**
+ * rpmsg_broker_send - copy a message into a TX buffer and send it
+ *
+ * @ch: channel
+ * @data: message
+ * @len: message length
+ * @timeout_ms: time to wait for a buffer, negative to wait forever
+ *
+ * return len on success, -ETIMEDOUT, or another negative value on failure
+ */
+int rpmsg_broker_send(struct rpmsg_broker_chan *ch, const void *data, uint32_t len, int timeout_ms);
+
+/**
+ * rpmsg_broker_recv - get the next received messages
+ *
+ * The messages stay in the shared memory until rpmsg_broker_recv_release().
+ * Calling again before releasing returns the same messages first.
+ *
+ * @ch: channel
+ * @msgs: received messages
+ * @max: size of @msgs
+ * @timeout_ms: time to wait if there is none, 0 not to wait, negative to
+ *              wait forever
+ *
+ * return number of messages, 0 on timeout, negative value on failure
+ */
+int rpmsg_broker_recv(struct rpmsg_broker_chan *ch, struct rpmsg_broker_msg *msgs,
+                      unsigned int max, int timeout_ms);
+
+/**
+ * rpmsg_broker_recv_release - give the first n received messages back
+ *
+ * @ch: channel
+ * @n: number of messages, from the oldest
+ */
+void rpmsg_broker_recv_release(struct rpmsg_broker_chan *ch, unsigned int n);
+
+/**
+ * rpmsg_broker_fd - event for the event loop of the client
+ *
+ * Readable after a message came in, a TX buffer was freed or the binding
+ * changed. An event loop reads the 8-byte counter to clear it, then calls
+ * rpmsg_broker_recv() with a zero timeout until it returns 0; that call
+ * also asks the broker for the next wakeup.
+ *
+ * @ch: channel
+ *
+ * return file descriptor
+ */
+static inline int rpmsg_broker_fd(struct rpmsg_broker_chan *ch)
+{
+    return ch->wake_fd;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RPMSG_BROKER_CLIENT_H_ */
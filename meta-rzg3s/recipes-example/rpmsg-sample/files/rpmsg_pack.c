@@ -0,0 +1,216 @@
+/**
+ * @file    rpmsg_pack.c
+ * @brief   Packing of small messages into shared RPMsg buffers.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <time.h>
+#include "platform_info.h"
+#include "rpmsg_pack.h"
+#include "rpmsg_vdev.h"
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000U + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+/* Send the buffer being filled; called with the lock held */
+static int pack_flush(struct rpmsg_pack *p)
+{
+    int ret;
+
+    /* An empty TX buffer is kept for the next message */
+    if (!p->used)
+        return 0;
+
+    if (p->buf == p->local)
+        ret = rpmsg_send(p->ept, p->local, (int)p->used);
+    else
+        ret = rpmsg_vdev_send_nocopy(p->ept, p->buf, (int)p->used);
+    p->buf = NULL;
+    p->used = 0U;
+    if (ret < 0)
+        return ret;
+    p->bufs++;
+
+    return 0;
+}
+
+/* Take the buffer to fill next; called with the lock held */
+static int pack_take(struct rpmsg_pack *p)
+{
+    struct rpmsg_vdev *rpvdev = rpmsg_vdev_from_rdev(p->ept->rdev);
+
+    if (rpvdev->rvdev.vdev->role != VIRTIO_DEV_MASTER) {
+        p->buf = p->local;
+        p->cap = sizeof(p->local);
+        return 0;
+    }
+
+    p->buf = rpmsg_vdev_get_tx_buffer(p->ept, &p->cap, 1);
+
+    return p->buf ? 0 : RPMSG_ERR_NO_BUFF;
+}
+
+/* Sends the buffers whose oldest message waited for the flush interval */
+static void *pack_timer(void *arg)
+{
+    struct rpmsg_pack *p = arg;
+    struct timespec until;
+    uint64_t due;
+
+    pthread_mutex_lock(&p->lock);
+    while (!p->stop) {
+        if (!p->used) {
+            pthread_cond_wait(&p->cond, &p->lock);
+            continue;
+        }
+        due = p->first_us + p->flush_us;
+        if (now_us() < due) {
+            until.tv_sec = (time_t)(due / 1000000U);
+            until.tv_nsec = (long)(due % 1000000U) * 1000L;
+            (void)pthread_cond_timedwait(&p->cond, &p->lock, &until);
+            continue;
+        }
+        if (pack_flush(p) < 0)
+            LPERROR("Failed to send a packed buffer.");
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    return NULL;
+}
+
+int rpmsg_pack_init(struct rpmsg_pack *p, struct rpmsg_endpoint *ept, uint32_t flush_us,
+                    rpmsg_pack_cb cb, void *priv)
+{
+    pthread_condattr_t attr;
+
+    if (!p || !ept || !ept->rdev || !cb)
+        return RPMSG_ERR_PARAM;
+
+    p->ept = ept;
+    p->cb = cb;
+    p->priv = priv;
+    p->flush_us = flush_us;
+    p->stop = 0;
+    p->buf = NULL;
+    p->cap = 0U;
+    p->used = 0U;
+    p->first_us = 0U;
+    p->msgs = 0UL;
+    p->bufs = 0UL;
+    p->rx_malformed = 0UL;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&p->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if (flush_us && pthread_create(&p->timer, NULL, pack_timer, p)) {
+        pthread_cond_destroy(&p->cond);
+        pthread_mutex_destroy(&p->lock);
+        return RPMSG_ERR_NO_MEM;
+    }
+    ept->priv = p;
+
+    return 0;
+}
+
+void rpmsg_pack_deinit(struct rpmsg_pack *p)
+{
+    pthread_mutex_lock(&p->lock);
+    if (pack_flush(p) < 0)
+        LPERROR("Failed to send a packed buffer.");
+    if (p->buf && (p->buf != p->local))
+        rpmsg_vdev_release_tx_buffer(p->ept, p->buf);
+    p->buf = NULL;
+    p->stop = 1;
+    pthread_cond_signal(&p->cond);
+    pthread_mutex_unlock(&p->lock);
+
+    if (p->flush_us)
+        (void)pthread_join(p->timer, NULL);
+    pthread_cond_destroy(&p->cond);
+    pthread_mutex_destroy(&p->lock);
+}
+
+int rpmsg_pack_ept_cb(struct rpmsg_endpoint *ept, void *data, size_t len, uint32_t src, void *priv)
+{
+    struct rpmsg_pack *p = priv;
+    const void *msg;
+    uint32_t msg_len;
+    size_t off = 0U;
+
+    (void)ept;
+    (void)src;
+
+    while ((msg = rpmsg_pack_next(data, len, &off, &msg_len)) != NULL)
+        p->cb(p->priv, msg, msg_len);
+    if (off != len) {
+        __atomic_add_fetch(&p->rx_malformed, 1UL, __ATOMIC_RELAXED);
+        LPERROR("Packed buffer malformed at %lu of %lu bytes.", (unsigned long)off, (unsigned long)len);
+    }
+
+    return RPMSG_SUCCESS;
+}
+
+int rpmsg_pack_send(struct rpmsg_pack *p, const void *data, size_t len)
+{
+    int ret = 0;
+
+    if (!p || (!data && len))
+        return RPMSG_ERR_PARAM;
+    if (len > RPMSG_PACK_MSG_MAX)
+        return RPMSG_ERR_BUFF_SIZE;
+
+    pthread_mutex_lock(&p->lock);
+    /* Send what is there if the message does not fit anymore */
+    if (p->buf && (p->cap - p->used < rpmsg_pack_rec_size((uint32_t)len)))
+        ret = pack_flush(p);
+    if (!ret && !p->buf)
+        ret = pack_take(p);
+    if (ret)
+        goto out;
+
+    if (!p->used) {
+        /* First message of the buffer: the flush interval starts */
+        p->first_us = now_us();
+        pthread_cond_signal(&p->cond);
+    }
+    (void)rpmsg_pack_put(p->buf, p->cap, &p->used, data, (uint32_t)len);
+    p->msgs++;
+
+    /* Full */
+    if (p->cap - p->used <= sizeof(struct rpmsg_pack_rec))
+        ret = pack_flush(p);
+out:
+    pthread_mutex_unlock(&p->lock);
+
+    return ret ? ret : (int)len;
+}
+
+int rpmsg_pack_flush(struct rpmsg_pack *p)
+{
+    int ret;
+
+    if (!p)
+        return RPMSG_ERR_PARAM;
+
+    pthread_mutex_lock(&p->lock);
+    ret = pack_flush(p);
+    pthread_mutex_unlock(&p->lock);
+
+    return ret;
+}
@@ -0,0 +1,238 @@
+/**
+ * @file    rpmsg_schema.h
+ * @brief   Fixed-width little-endian message codecs generated from a schema.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * A message is described once as a list of fields, and the same header is
+ * compiled on Linux (C and C++) and on the remote core (C99). Each field is
+ * written at a fixed offset, packed, little-endian, with the width of its
+ * kind, so the layout does not depend on the ABI (unsigned long is 8 bytes
+ * on the CA55 and 4 on the CM33/R52).
+ *
+ * @code
+ *     #define MY_CMD_FIELDS(F) \
+ *         F(U16, op)           \
+ *         F(U16, flags)        \
+ *         F(U32, value)
+ *     RPMSG_SCHEMA(my_cmd, MY_CMD_FIELDS)
+ * @endcode
+ *
+ * generates:
+ * - struct my_cmd, with one native field per schema field
+ * - my_cmd_wire_size, the encoded size, a compile-time constant
+ * - my_cmd_encode(const struct my_cmd *m, void *buf), returning the size
+ * - my_cmd_decode(struct my_cmd *m, const void *buf, size_t len),
+ *   returning the size, or 0 if len is too short
+ * - in C++, the rpmsg_schema<struct my_cmd> traits
+ *
+ * The codecs read and write the buffer they are given, e.g. a TX buffer
+ * from rpmsg_vdev_get_tx_buffer() or a message of rpmsg_vdev_recv_batch(),
+ * with no intermediate copy. A variable part, if any, follows the encoded
+ * fields. Byte-wise accesses are merged by the compiler into single
+ * (unaligned) loads and stores on little-endian cores.
+ *
+ * Field kinds: U8, U16, U32, U64, I8, I16, I32, I64.
+ */
+
+#ifndef RPMSG_SCHEMA_H_
+#define RPMSG_SCHEMA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Native type and encoded size of each field kind
+#define RPMSG_SCHEMA_TYPE_U8    uint8_t
+#define RPMSG_SCHEMA_TYPE_U16   uint16_t
+#define RPMSG_SCHEMA_TYPE_U32   uint32_t
+#define RPMSG_SCHEMA_TYPE_U64   uint64_t
+#define RPMSG_SCHEMA_TYPE_I8    int8_t
+#define RPMSG_SCHEMA_TYPE_I16   int16_t
+#define RPMSG_SCHEMA_TYPE_I32   int32_t
+#define RPMSG_SCHEMA_TYPE_I64   int64_t
+
+#define RPMSG_SCHEMA_SIZE_U8    1U
+#define RPMSG_SCHEMA_SIZE_U16   2U
+#define RPMSG_SCHEMA_SIZE_U32   4U
+#define RPMSG_SCHEMA_SIZE_U64   8U
+#define RPMSG_SCHEMA_SIZE_I8    1U
+#define RPMSG_SCHEMA_SIZE_I16   2U
+#define RPMSG_SCHEMA_SIZE_I32   4U
+#define RPMSG_SCHEMA_SIZE_I64   8U
+
+static inline unsigned char *rpmsg_schema_put_U8(unsigned char *p, uint8_t v)
+{
+    p[0] = v;
+    return p + 1;
+}
+
+static inline unsigned char *rpmsg_schema_put_U16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    return p + 2;
+}
+
+static inline unsigned char *rpmsg_schema_put_U32(unsigned char *p, uint32_t v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+    return p + 4;
+}
+
+static inline unsigned char *rpmsg_schema_put_U64(unsigned char *p, uint64_t v)
+{
+    p = rpmsg_schema_put_U32(p, (uint32_t)v);
+    return rpmsg_schema_put_U32(p, (uint32_t)(v >> 32));
+}
+
+static inline const unsigned char *rpmsg_schema_get_U8(const unsigned char *p, uint8_t *v)
+{
+    *v = p[0];
+    return p + 1;
+}
+
+static inline const unsigned char *rpmsg_schema_get_U16(const unsigned char *p, uint16_t *v)
+{
+    *v = (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+    return p + 2;
+}
+
+static inline const unsigned char *rpmsg_schema_get_U32(const unsigned char *p, uint32_t *v)
+{
+    *v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    return p + 4;
+}
+
+static inline const unsigned char *rpmsg_schema_get_U64(const unsigned char *p, uint64_t *v)
+{
+    uint32_t lo, hi;
+
+    p = rpmsg_schema_get_U32(p, &lo);
+    p = rpmsg_schema_get_U32(p, &hi);
+    *v = (uint64_t)lo | ((uint64_t)hi << 32);
+    return p;
+}
+
+/* Signed kinds are encoded in two's complement */
+static inline unsigned char *rpmsg_schema_put_I8(unsigned char *p, int8_t v)
+{
+    return rpmsg_schema_put_U8(p, (uint8_t)v);
+}
+
+static inline unsigned char *rpmsg_schema_put_I16(unsigned char *p, int16_t v)
+{
+    return rpmsg_schema_put_U16(p, (uint16_t)v);
+}
+
+static inline unsigned char *rpmsg_schema_put_I32(unsigned char *p, int32_t v)
+{
+    return rpmsg_schema_put_U32(p, (uint32_t)v);
+}
+
+static inline unsigned char *rpmsg_schema_put_I64(unsigned char *p, int64_t v)
+{
+    return rpmsg_schema_put_U64(p, (uint64_t)v);
+}
+
+static inline const unsigned char *rpmsg_schema_get_I8(const unsigned char *p, int8_t *v)
+{
+    *v = (int8_t)p[0];
+    return p + 1;
+}
+
+static inline const unsigned char *rpmsg_schema_get_I16(const unsigned char *p, int16_t *v)
+{
+    uint16_t u;
+
+    p = rpmsg_schema_get_U16(p, &u);
+    *v = (int16_t)u;
+    return p;
+}
+
+static inline const unsigned char *rpmsg_schema_get_I32(const unsigned char *p, int32_t *v)
+{
+    uint32_t u;
+
+    p = rpmsg_schema_get_U32(p, &u);
+    *v = (int32_t)u;
+    return p;
+}
+
+static inline const unsigned char *rpmsg_schema_get_I64(const unsigned char *p, int64_t *v)
+{
+    uint64_t u;
+
+    p = rpmsg_schema_get_U64(p, &u);
+    *v = (int64_t)u;
+    return p;
+}
+
+// Expansions of one field
+#define RPMSG_SCHEMA_MEMBER(kind, name)  RPMSG_SCHEMA_TYPE_##kind name;
+#define RPMSG_SCHEMA_SIZE(kind, name)    + RPMSG_SCHEMA_SIZE_##kind
+#define RPMSG_SCHEMA_PUT(kind, name)     p = rpmsg_schema_put_##kind(p, m->name);
+#define RPMSG_SCHEMA_GET(kind, name)     p = rpmsg_schema_get_##kind(p, &m->name);
+
+#ifdef __cplusplus
+extern "C++" {
+template <typename T>
+struct rpmsg_schema;
+}
+
+#define RPMSG_SCHEMA_CXX(msg)                                                        \
+    extern "C++" {                                                                   \
+    template <>                                                                      \
+    struct rpmsg_schema<struct msg> {                                                \
+        static constexpr size_t wire_size = msg##_wire_size;                         \
+        static size_t encode(const struct msg &m, void *buf)                         \
+        {                                                                            \
+            return msg##_encode(&m, buf);                                            \
+        }                                                                            \
+        static size_t decode(struct msg &m, const void *buf, size_t len)             \
+        {                                                                            \
+            return msg##_decode(&m, buf, len);                                       \
+        }                                                                            \
+    };                                                                               \
+    }
+#else
+#define RPMSG_SCHEMA_CXX(msg)
+#endif
+
+/**
+ * RPMSG_SCHEMA - define a message and its codec
+ *
+ * @msg: name of the message
+ * @fields: X-macro listing the fields as F(kind, name)
+ */
+#define RPMSG_SCHEMA(msg, fields)                                                    \
+    struct msg {                                                                     \
+        fields(RPMSG_SCHEMA_MEMBER)                                                  \
+    };                                                                               \
+    enum { msg##_wire_size = 0 fields(RPMSG_SCHEMA_SIZE) };                          \
+    static inline size_t msg##_encode(const struct msg *m, void *buf)                \
+    {                                                                                \
+        unsigned char *p = (unsigned char *)buf;                                     \
+        fields(RPMSG_SCHEMA_PUT)                                                     \
+        return (size_t)(p - (unsigned char *)buf);                                   \
+    }                                                                                \
+    static inline size_t msg##_decode(struct msg *m, const void *buf, size_t len)    \
+    {                                                                                \
+        const unsigned char *p = (const unsigned char *)buf;                         \
+        if (len < (size_t)msg##_wire_size)                                           \
+            return 0;                                                                \
+        fields(RPMSG_SCHEMA_GET)                                                     \
+        return (size_t)(p - (const unsigned char *)buf);                             \
+    }                                                                                \
+    RPMSG_SCHEMA_CXX(msg)
+
+#endif /* RPMSG_SCHEMA_H_ */
@@ -0,0 +1,230 @@
+/**
+ * @file    rpmsg_stripe.c
+ * @brief   Logical link striped over the channels to one remote core.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "platform_info.h"
+#include "rpmsg_stripe.h"
+#include "rpmsg_vdev.h"
+
+int rpmsg_stripe_init(struct rpmsg_stripe *s, struct rpmsg_endpoint *ept, unsigned int num,
+                      rpmsg_stripe_cb cb, void *priv)
+{
+    unsigned int i, size = 0U;
+
+    if (!s || !ept || !num || (num > RPMSG_STRIPE_LANE_MAX) || !cb)
+        return RPMSG_ERR_PARAM;
+
+    /* The remote cannot have more messages ahead than the RX vrings hold */
+    for (i = 0; i < num; i++) {
+        if (!ept[i].rdev)
+            return RPMSG_ERR_PARAM;
+        size += rpmsg_vdev_from_rdev(ept[i].rdev)->rvdev.rvq->vq_nentries;
+    }
+    s->window = calloc(size, sizeof(*s->window));
+    if (!s->window)
+        return RPMSG_ERR_NO_MEM;
+    s->window_size = size;
+
+    s->num = num;
+    s->cb = cb;
+    s->priv = priv;
+    pthread_mutex_init(&s->tx_lock, NULL);
+    s->tx_seq = 0U;
+    s->tx_lane = 0U;
+    pthread_mutex_init(&s->rx_lock, NULL);
+    pthread_cond_init(&s->rx_cond, NULL);
+    s->rx_seq = 0U;
+    s->rx_busy = 0;
+    s->rx_dropped = 0UL;
+    s->rx_skipped = 0UL;
+    for (i = 0; i < num; i++) {
+        s->ept[i] = &ept[i];
+        ept[i].priv = s;
+    }
+
+    return 0;
+}
+
+void rpmsg_stripe_deinit(struct rpmsg_stripe *s)
+{
+    free(s->window);
+    s->window = NULL;
+    pthread_cond_destroy(&s->rx_cond);
+    pthread_mutex_destroy(&s->rx_lock);
+    pthread_mutex_destroy(&s->tx_lock);
+}
+
+/*
+ * Deliver the messages held in the window from rx_seq on, until the next
+ * gap. Called with rx_lock held and rx_busy set; the callback runs without
+ * the lock, so the other lanes keep filling the window meanwhile.
+ */
+static void stripe_drain(struct rpmsg_stripe *s)
+{
+    struct rpmsg_stripe_slot *slot;
+
+    for (;;) {
+        slot = &s->window[s->rx_seq % s->window_size];
+        if (!slot->used)
+            break;
+        pthread_mutex_unlock(&s->rx_lock);
+        s->cb(s->priv, slot->data, slot->len);
+        pthread_mutex_lock(&s->rx_lock);
+        slot->used = 0;
+        s->rx_seq++;
+    }
+}
+
+/*
+ * Move rx_seq up to seq, delivering the messages held on the way and
+ * giving up on the numbers that never came. Same calling context as
+ * stripe_drain().
+ */
+static void stripe_skip(struct rpmsg_stripe *s, uint32_t seq)
+{
+    struct rpmsg_stripe_slot *slot;
+
+    while ((int32_t)(seq - s->rx_seq) > 0) {
+        slot = &s->window[s->rx_seq % s->window_size];
+        if (slot->used) {
+            pthread_mutex_unlock(&s->rx_lock);
+            s->cb(s->priv, slot->data, slot->len);
+            pthread_mutex_lock(&s->rx_lock);
+            slot->used = 0;
+        } else {
+            s->rx_skipped++;
+            LPERROR("Striped message %u never came, skipped.", s->rx_seq);
+        }
+        s->rx_seq++;
+    }
+}
+
+static void stripe_idle(struct rpmsg_stripe *s)
+{
+    s->rx_busy = 0;
+    pthread_cond_broadcast(&s->rx_cond);
+}
+
+int rpmsg_stripe_ept_cb(struct rpmsg_endpoint *ept, void *data, size_t len, uint32_t src, void *priv)
+{
+    struct rpmsg_stripe *s = priv;
+    const struct rpmsg_stripe_hdr *hdr = data;
+    struct rpmsg_stripe_slot *slot;
+    uint32_t ahead;
+
+    (void)ept;
+    (void)src;
+
+    if (len < sizeof(*hdr))
+        return RPMSG_SUCCESS;
+    data = (void *)(hdr + 1);
+    len -= sizeof(*hdr);
+
+    pthread_mutex_lock(&s->rx_lock);
+    ahead = hdr->seq - s->rx_seq;
+    if ((ahead >= s->window_size) && ((int32_t)ahead > 0) && (len <= RPMSG_STRIPE_PAYLOAD_MAX)) {
+        /*
+         * Beyond the window: the number at rx_seq was taken by a send that
+         * failed, or its lane is not serviced while the others run ahead.
+         * Give up on the oldest numbers rather than stall the link.
+         */
+        while (s->rx_busy)
+            pthread_cond_wait(&s->rx_cond, &s->rx_lock);
+        ahead = hdr->seq - s->rx_seq;
+        if ((ahead >= s->window_size) && ((int32_t)ahead > 0)) {
+            s->rx_busy = 1;
+            stripe_skip(s, hdr->seq - s->window_size + 1U);
+            stripe_idle(s);
+            ahead = hdr->seq - s->rx_seq;
+        }
+    }
+    if ((ahead >= s->window_size) || (len > RPMSG_STRIPE_PAYLOAD_MAX)) {
+        /* Behind rx_seq: a number given up on came after all */
+        s->rx_dropped++;
+        LPERROR("Striped message %u dropped, expecting %u.", hdr->seq, s->rx_seq);
+    } else if (!ahead && !s->rx_busy) {
+        /* In order, delivered straight from the vring buffer */
+        s->rx_busy = 1;
+        pthread_mutex_unlock(&s->rx_lock);
+        s->cb(s->priv, data, len);
+        pthread_mutex_lock(&s->rx_lock);
+        s->rx_seq++;
+        stripe_drain(s);
+        stripe_idle(s);
+    } else {
+        /* Ahead of a message still on another lane, or of the one being delivered */
+        slot = &s->window[hdr->seq % s->window_size];
+        memcpy(slot->data, data, len);
+        slot->len = (uint32_t)len;
+        slot->used = 1;
+        if (!s->rx_busy) {
+            s->rx_busy = 1;
+            stripe_drain(s);
+            stripe_idle(s);
+        }
+    }
+    pthread_mutex_unlock(&s->rx_lock);
+
+    return RPMSG_SUCCESS;
+}
+
+int rpmsg_stripe_ready(struct rpmsg_stripe *s)
+{
+    unsigned int i;
+
+    for (i = 0; i < s->num; i++) {
+        if (!is_rpmsg_ept_ready(s->ept[i]))
+            return 0;
+    }
+
+    return 1;
+}
+
+int rpmsg_stripe_send(struct rpmsg_stripe *s, const void *data, size_t len)
+{
+    struct rpmsg_stripe_hdr *hdr = NULL;
+    unsigned int i, lane = 0U;
+    int ret;
+
+    if (!s || (len > RPMSG_STRIPE_PAYLOAD_MAX))
+        return RPMSG_ERR_BUFF_SIZE;
+    /* A number taken by a send that fails is only skipped once the receive window is full */
+    if (!rpmsg_stripe_ready(s))
+        return RPMSG_ERR_INIT;
+
+    pthread_mutex_lock(&s->tx_lock);
+    /* The first lane with a free TX buffer, starting after the last one used */
+    for (i = 0; !hdr && (i < s->num); i++) {
+        lane = (s->tx_lane + i) % s->num;
+        hdr = rpmsg_vdev_get_tx_buffer(s->ept[lane], NULL, 0);
+    }
+    if (!hdr) {
+        lane = s->tx_lane;
+        hdr = rpmsg_vdev_get_tx_buffer(s->ept[lane], NULL, 1);
+    }
+    if (!hdr) {
+        pthread_mutex_unlock(&s->tx_lock);
+        return RPMSG_ERR_NO_BUFF;
+    }
+    hdr->seq = s->tx_seq++;
+    s->tx_lane = (lane + 1U) % s->num;
+    pthread_mutex_unlock(&s->tx_lock);
+
+    /* The numbers are taken in order; the copies and kicks of the lanes overlap */
+    memcpy(hdr + 1, data, len);
+    ret = rpmsg_vdev_send_nocopy(s->ept[lane], hdr, (int)(sizeof(*hdr) + len));
+
+    return (ret < 0) ? ret : (int)len;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file    rpmsg_stripe.h
+ * @brief   Logical link striped over the channels to one remote core.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * A remote core reachable over several channels (CM33 ch0 and ch1 on
+ * RZ/G3S, the two RPMSG channel definitions on RZ/N2H and RZ/T2H) gets one
+ * endpoint per channel, the lanes. Each message goes to the next lane with
+ * a free TX buffer, so a single flow uses every vring and doorbell, and
+ * starts with struct rpmsg_stripe_hdr. The receiver puts the messages of
+ * all lanes back in sequence order before its callback sees them. The
+ * remote side stripes and reorders the same way.
+ *
+ * @code
+ *     rpmsg_create_ept(&ept[0], rdev0, "rpmsg-stripe", RPMSG_ADDR_ANY, RPMSG_ADDR_ANY,
+ *                      rpmsg_stripe_ept_cb, NULL);
+ *     rpmsg_create_ept(&ept[1], rdev1, "rpmsg-stripe", RPMSG_ADDR_ANY, RPMSG_ADDR_ANY,
+ *                      rpmsg_stripe_ept_cb, NULL);
+ *     rpmsg_stripe_init(&stripe, ept, 2, on_message, priv);
+ *
+ *     rpmsg_stripe_send(&stripe, data, len);
+ * @endcode
+ */
+
+#ifndef RPMSG_STRIPE_H_
+#define RPMSG_STRIPE_H_
+
+#include <stdint.h>
+#include <pthread.h>
+#include <openamp/rpmsg.h>
+#include "rpmsg_vdev.h"
+
+// Maximum number of lanes of one link
+#define RPMSG_STRIPE_LANE_MAX   (4U)
+// Largest message on a lane, header included (RPMsg buffer minus its header)
+#define RPMSG_STRIPE_MSG_MAX    (RPMSG_BUFFER_SIZE - sizeof(struct rpmsg_vdev_hdr))
+
+/**
+ * @struct rpmsg_stripe_hdr
+ * @brief  header of every message on a lane
+ */
+struct rpmsg_stripe_hdr {
+    uint32_t seq;   /**< sequence number over all lanes, from 0 */
+} __attribute__((packed));
+
+// Largest payload of a striped message
+#define RPMSG_STRIPE_PAYLOAD_MAX    (RPMSG_STRIPE_MSG_MAX - sizeof(struct rpmsg_stripe_hdr))
+
+/**
+ * rpmsg_stripe_cb - message received in order
+ *
+ * Called once per message, in sequence order and never concurrently, from
+ * the thread receiving on one of the lanes.
+ *
+ * @priv: argument given to rpmsg_stripe_init()
+ * @data: payload, only valid during the call
+ * @len: payload length
+ */
+typedef void (*rpmsg_stripe_cb)(void *priv, const void *data, size_t len);
+
+/**
+ * @struct rpmsg_stripe_slot
+ * @brief  message received ahead of its turn
+ */
+struct rpmsg_stripe_slot {
+    uint32_t len;
+    int used;
+    unsigned char data[RPMSG_STRIPE_PAYLOAD_MAX];
+};
+
+/**
+ * @struct rpmsg_stripe
+ * @brief  striped link
+ */
+struct rpmsg_stripe {
+    struct rpmsg_endpoint *ept[RPMSG_STRIPE_LANE_MAX];
+    unsigned int num;                 /**< lanes */
+    rpmsg_stripe_cb cb;
+    void *priv;
+    pthread_mutex_t tx_lock;          /**< protects the TX members below */
+    uint32_t tx_seq;                  /**< sequence number of the next message */
+    unsigned int tx_lane;             /**< lane tried first for the next message */
+    pthread_mutex_t rx_lock;          /**< protects the RX members below */
+    uint32_t rx_seq;                  /**< sequence number delivered next */
+    int rx_busy;                      /**< a thread is calling the callback */
+    pthread_cond_t rx_cond;           /**< signalled when rx_busy is cleared */
+    struct rpmsg_stripe_slot *window; /**< messages ahead of rx_seq, by seq % window_size */
+    unsigned int window_size;
+    unsigned long rx_dropped;         /**< messages behind rx_seq or too long */
+    unsigned long rx_skipped;         /**< sequence numbers given up on */
+};
+
+/**
+ * rpmsg_stripe_init - set up a striped link over endpoints
+ *
+ * The endpoints, one per channel to the same remote core, must be created
+ * with rpmsg_stripe_ept_cb() as callback; their private data is set to
+ * @s. The reorder window holds as many messages as the RX vrings of the
+ * lanes together. A message that does not fit in the window makes the
+ * receiver give up on the oldest missing numbers, so a number the sender
+ * took but failed to send does not stall the link.
+ *
+ * @s: link
+ * @ept: endpoints, the lanes
+ * @num: number of endpoints, up to RPMSG_STRIPE_LANE_MAX
+ * @cb: callback of the received messages
+ * @priv: argument of @cb
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_stripe_init(struct rpmsg_stripe *s, struct rpmsg_endpoint *ept, unsigned int num,
+                      rpmsg_stripe_cb cb, void *priv);
+
+/**
+ * rpmsg_stripe_deinit - release the reorder window
+ *
+ * Must be called once the lanes do not receive any more.
+ *
+ * @s: link
+ */
+void rpmsg_stripe_deinit(struct rpmsg_stripe *s);
+
+/**
+ * rpmsg_stripe_ept_cb - endpoint callback of the lanes
+ */
+int rpmsg_stripe_ept_cb(struct rpmsg_endpoint *ept, void *data, size_t len, uint32_t src, void *priv);
+
+/**
+ * rpmsg_stripe_ready - whether the remote side has bound every lane
+ *
+ * @s: link
+ */
+int rpmsg_stripe_ready(struct rpmsg_stripe *s);
+
+/**
+ * rpmsg_stripe_send - send a message on the next lane with a free TX buffer
+ *
+ * Blocks like rpmsg_send() while no lane has a free TX buffer. Virtio
+ * master only.
+ *
+ * @s: link
+ * @data: payload
+ * @len: payload length, up to RPMSG_STRIPE_PAYLOAD_MAX
+ *
+ * return @len on success, RPMSG_ERR_INIT if a lane is not bound yet,
+ *        another negative value on failure
+ */
+int rpmsg_stripe_send(struct rpmsg_stripe *s, const void *data, size_t len);
+
+#endif /* RPMSG_STRIPE_H_ */
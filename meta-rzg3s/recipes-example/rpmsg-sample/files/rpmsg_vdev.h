@@ -0,0 +1,578 @@
+/**
+ * @file    rpmsg_vdev.h
+ * @brief   RPMsg virtio device with platform-side TX/RX hooks.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#ifndef RPMSG_VDEV_H_
+#define RPMSG_VDEV_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <metal/list.h>
+#include <metal/utilities.h>
+#include <openamp/rpmsg_virtio.h>
+#include "rpmsg_stats.h"
+#include "rpmsg_txq.h"
+
+struct rpmsg_poller;
+struct rpmsg_workers;
+
+// Upper bound of a blocking send waiting for a TX buffer (same as open-amp)
+#ifndef RPMSG_VDEV_TX_TIMEOUT_MS
+#define RPMSG_VDEV_TX_TIMEOUT_MS    (15000U)
+#endif
+// Re-check interval of a waiter, for a remote returning buffers without a kick
+#ifndef RPMSG_VDEV_TX_RECHECK_MS
+#define RPMSG_VDEV_TX_RECHECK_MS    (10U)
+#endif
+// Maximum number of RX buffers handled before they are given back with one kick
+#ifndef RPMSG_VDEV_RX_BUDGET
+#define RPMSG_VDEV_RX_BUDGET        (32U)
+#endif
+// Maximum number of endpoints using the pull receive API
+#define RPMSG_VDEV_PULL_MAX         (8U)
+// Maximum number of endpoints with a TX space available callback
+#define RPMSG_VDEV_TX_READY_MAX     (8U)
+// Maximum number of endpoints with a TX class other than RPMSG_VDEV_TX_NORMAL
+#define RPMSG_VDEV_TX_CLASS_EPT_MAX (8U)
+// Each class leaves 1/2^shift of the TX ring per more urgent class to it
+#ifndef RPMSG_VDEV_TX_RESERVE_SHIFT
+#define RPMSG_VDEV_TX_RESERVE_SHIFT (3U)
+#endif
+// Deadline of messages sent without one
+#define RPMSG_VDEV_NO_DEADLINE      (UINT64_MAX)
+// Maximum number of endpoints with credit-based flow control
+#define RPMSG_VDEV_CREDIT_EPT_MAX   (8U)
+// Slots of the endpoint statistics cache, indexed by local address modulo the size
+#define RPMSG_VDEV_EPT_STATS_NUM    (RPMSG_ADDR_BMP_SIZE)
+// Header flag: the reserved field carries credits granted to the destination
+#define RPMSG_VDEV_HDR_CREDIT       (0x0001U)
+
+/**
+ * @enum rpmsg_vdev_tx_class
+ * @brief TX priority classes, most urgent first
+ *
+ * The remote side consumes the TX ring in order, so a message can only
+ * overtake what is not on the ring yet. A class therefore only takes a TX
+ * buffer while a share of the ring stays free for the more urgent ones,
+ * and blocked senders get the returned buffers by class, then by earliest
+ * deadline, then in arrival order.
+ */
+enum rpmsg_vdev_tx_class {
+    RPMSG_VDEV_TX_URGENT,   /**< control and safety commands */
+    RPMSG_VDEV_TX_NORMAL,   /**< default of every endpoint */
+    RPMSG_VDEV_TX_BULK,     /**< telemetry and transfers */
+    RPMSG_VDEV_TX_CLASS_NUM,
+};
+
+/**
+ * rpmsg_vdev_tx_ready_cb - TX space available callback
+ *
+ * Called once after rpmsg_vdev_trysend() on the endpoint returned -EAGAIN
+ * and the remote has given TX buffers back. It runs in the context that
+ * processes the notifications (platform_poll()).
+ *
+ * @ept: endpoint
+ * @priv: private data given at registration
+ */
+typedef void (*rpmsg_vdev_tx_ready_cb)(struct rpmsg_endpoint *ept, void *priv);
+
+/**
+ * @struct rpmsg_vdev_tx_ready
+ * @brief  TX space available callback of an endpoint
+ */
+struct rpmsg_vdev_tx_ready {
+    struct rpmsg_endpoint *ept;
+    rpmsg_vdev_tx_ready_cb cb;
+    void *priv;
+    int armed; /**< a non-blocking send failed since the last callback */
+};
+
+/**
+ * @struct rpmsg_vdev_msg
+ * @brief  message returned by rpmsg_vdev_recv_batch(), held in the vring
+ *         until it is released
+ */
+struct rpmsg_vdev_msg {
+    void *data;     /**< payload */
+    uint32_t len;   /**< payload length */
+    uint32_t src;   /**< source address */
+    void *buf;      /**< vring buffer */
+};
+
+/**
+ * @struct rpmsg_vdev_pullq
+ * @brief  received messages waiting for rpmsg_vdev_recv_batch()
+ */
+struct rpmsg_vdev_pullq {
+    struct rpmsg_endpoint *ept;
+    struct rpmsg_vdev_hdr **hdr; /**< ring, as large as the RX virtqueue */
+    unsigned int size;
+    unsigned int head;
+    unsigned int count;
+};
+
+/**
+ * @struct rpmsg_vdev_hdr
+ * @brief  header of a RPMsg buffer on the vring (same layout as the
+ *         header used by open-amp and the Linux kernel)
+ */
+struct rpmsg_vdev_hdr {
+    uint32_t src;
+    uint32_t dst;
+    uint32_t reserved;
+    uint16_t len;
+    uint16_t flags;
+} __attribute__((packed));
+
+/**
+ * @struct rpmsg_vdev_credit
+ * @brief  flow control state of an endpoint, see rpmsg_vdev_credit_enable()
+ */
+struct rpmsg_vdev_credit {
+    uint32_t addr;          /**< local address */
+    uint32_t dst;           /**< remote address the credits are granted to */
+    unsigned int window;    /**< credits of each side at start, 0 if the entry is free */
+    unsigned int tx;        /**< messages the remote endpoint still accepts */
+    unsigned int grant;     /**< messages consumed here and not granted back yet */
+};
+
+/**
+ * @struct rpmsg_vdev
+ * @brief  platform wrapper of the open-amp RPMsg virtio device
+ */
+struct rpmsg_vdev {
+    struct rpmsg_virtio_device rvdev; /**< open-amp device */
+    struct rpmsg_virtio_shm_pool shpool; /**< share of the channel buffers, virtio master */
+    struct rpmsg_stats_channel *stats; /**< statistics of the channel */
+    uint64_t ept_stats[RPMSG_VDEV_EPT_STATS_NUM]; /**< local address << 32 | statistics row + 1, see ept_stats() */
+    /** send operation installed by rpmsg_init_vdev() */
+    int (*send_offchannel_raw)(struct rpmsg_device *rdev, uint32_t src, uint32_t dst,
+                               const void *data, int size, int wait);
+    pthread_mutex_t tx_lock; /**< protects the TX completion */
+    pthread_cond_t tx_cond; /**< signalled when the remote notifies */
+    unsigned int tx_seq; /**< notifications received so far */
+    unsigned int tx_waiters; /**< senders blocked for a TX buffer */
+    struct rpmsg_vdev_tx_ready tx_ready[RPMSG_VDEV_TX_READY_MAX]; /**< protected by tx_lock */
+    unsigned int tx_armed; /**< armed entries of tx_ready */
+    int tx_fd; /**< eventfd readable when TX space became available */
+    struct rpmsg_txq txq; /**< TX submissions of the sender threads (master only) */
+    void **tx_spare; /**< TX buffers given back unused, owned by the TX drainer */
+    unsigned int tx_spare_num;
+    unsigned int tx_held; /**< TX buffers taken in place and not sent yet, owned by the TX drainer */
+    uint64_t tx_class[RPMSG_VDEV_TX_CLASS_EPT_MAX]; /**< endpoint address << 32 | class + 1, 0 if free */
+    struct metal_list tx_wait_list; /**< requests of the blocked senders, protected by tx_lock */
+    unsigned int tx_wait_seq; /**< arrival order of the blocked senders, protected by tx_lock */
+    struct rpmsg_vdev_credit credit[RPMSG_VDEV_CREDIT_EPT_MAX]; /**< writers hold tx_lock */
+    unsigned int credit_num; /**< entries of credit in use */
+    struct rpmsg_poller *poller; /**< poller servicing the RX side, or NULL */
+    unsigned int poller_index; /**< index of the device in the poller */
+    struct rpmsg_workers *workers; /**< worker pool running the endpoint callbacks, or NULL */
+    pthread_mutex_t rx_poll_lock; /**< one thread takes buffers from the RX virtqueue at a time */
+    pthread_mutex_t rx_lock; /**< protects the pull queues */
+    pthread_cond_t rx_cond; /**< signalled on notification and on queued messages */
+    unsigned int rx_waiters; /**< threads blocked in rpmsg_vdev_recv_batch() */
+    struct rpmsg_vdev_pullq pullq[RPMSG_VDEV_PULL_MAX]; /**< protected by rx_lock */
+    unsigned int pull_num; /**< pull queues in use */
+    int busy_poll; /**< the vring indices are watched, the remote does not ring the doorbell */
+};
+
+/**
+ * rpmsg_vdev_setup - install the platform hooks on an initialized device
+ *
+ * Must be called right after rpmsg_init_vdev(). The TX operation is wrapped
+ * and the RX virtqueue callback is replaced by the batched platform receive
+ * loop.
+ * As virtio master, sends go through the lock-free submission queue: one
+ * sender drains the requests of all threads and kicks once per batch.
+ *
+ * @rpvdev: device initialized by rpmsg_init_vdev()
+ * @stats: statistics of the channel, may be NULL
+ *
+ * return 0 on success, RPMSG_ERR_NO_MEM if the device is left untouched
+ */
+int rpmsg_vdev_setup(struct rpmsg_vdev *rpvdev, struct rpmsg_stats_channel *stats);
+
+/**
+ * rpmsg_vdev_cleanup - release what rpmsg_vdev_setup() allocated
+ *
+ * Must be called before rpmsg_deinit_vdev().
+ *
+ * @rpvdev: device
+ */
+void rpmsg_vdev_cleanup(struct rpmsg_vdev *rpvdev);
+
+/**
+ * rpmsg_vdev_notified - TX completion from the mailbox interrupt
+ *
+ * Wakes up the senders waiting for a TX buffer. A notification from the
+ * remote is the point where it may have returned used buffers.
+ *
+ * @rpvdev: device, NULL is ignored
+ */
+void rpmsg_vdev_notified(struct rpmsg_vdev *rpvdev);
+
+/**
+ * rpmsg_vdev_rx_poll - deliver received messages
+ *
+ * Buffers are given back to the remote with one kick per batch of up to
+ * RPMSG_VDEV_RX_BUDGET.
+ *
+ * @rpvdev: device (virtio master)
+ * @budget: maximum number of messages to deliver
+ *
+ * return number of messages delivered; equal to @budget if more may remain
+ */
+unsigned int rpmsg_vdev_rx_poll(struct rpmsg_vdev *rpvdev, unsigned int budget);
+
+/**
+ * rpmsg_vdev_rx_poll_wait - deliver received messages, or wait for the remote
+ *
+ * For a thread waiting for the answer to its own message, which may be the
+ * only thread taking messages from the RX virtqueue. Delivers what is there;
+ * if there is nothing, waits for a notification from the remote or until
+ * @until, and the caller calls again.
+ *
+ * @rpvdev: device (virtio master)
+ * @until: CLOCK_MONOTONIC time at which to stop waiting
+ *
+ * return number of messages delivered, 0 if none, -EBUSY if another thread
+ *        is taking the messages, another negative value on failure
+ */
+int rpmsg_vdev_rx_poll_wait(struct rpmsg_vdev *rpvdev, const struct timespec *until);
+
+/**
+ * rpmsg_vdev_set_busy_poll - switch a device to or from busy polling
+ *
+ * For a loop on an isolated core. VRING_AVAIL_F_NO_INTERRUPT tells the
+ * remote that it does not need to ring the doorbell for either virtqueue.
+ * Instead, platform_poll(), the blocking receive, and the senders waiting
+ * for a TX buffer or for credits spin on the used indices in vring-ctl
+ * memory, without the mailbox interrupt, the UIO and the libmetal IRQ
+ * thread on the way. Switching back delivers what came in without a
+ * doorbell.
+ *
+ * @rpvdev: device (virtio master)
+ * @on: non-zero to poll, 0 to go back to the interrupt
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_vdev_set_busy_poll(struct rpmsg_vdev *rpvdev, int on);
+
+/**
+ * rpmsg_vdev_pending - whether the remote moved a watched used index
+ *
+ * True for messages not taken from the RX virtqueue yet, and for TX
+ * buffers returned while a sender waits for one.
+ *
+ * @rpvdev: device (virtio master)
+ */
+int rpmsg_vdev_pending(struct rpmsg_vdev *rpvdev);
+
+/**
+ * rpmsg_vdev_rx_release - give received buffers back to the remote
+ *
+ * @rpvdev: device (virtio master)
+ * @hdrs: buffers taken from the RX virtqueue
+ * @n: number of buffers, notified with a single kick
+ */
+void rpmsg_vdev_rx_release(struct rpmsg_vdev *rpvdev, struct rpmsg_vdev_hdr **hdrs, unsigned int n);
+
+/**
+ * rpmsg_vdev_pull_enable - receive the messages of an endpoint by pulling
+ *
+ * Messages to the endpoint are queued, without a copy, for
+ * rpmsg_vdev_recv_batch() instead of being passed to its callback.
+ *
+ * @ept: endpoint created on a platform rpmsg device
+ *
+ * return 0 on success, RPMSG_ERR_NO_MEM if no queue is available
+ */
+int rpmsg_vdev_pull_enable(struct rpmsg_endpoint *ept);
+
+/**
+ * rpmsg_vdev_pull_disable - go back to the callback, dropping queued messages
+ *
+ * Must not be called while another thread is in rpmsg_vdev_recv_batch() on
+ * the endpoint, and must be called before the endpoint is destroyed.
+ *
+ * @ept: endpoint
+ */
+void rpmsg_vdev_pull_disable(struct rpmsg_endpoint *ept);
+
+/**
+ * rpmsg_vdev_recv_batch - fetch received messages of an endpoint
+ *
+ * Returns at once with the messages already received. Only when there is
+ * none, the caller takes new ones from the vring itself, then sleeps until
+ * the remote notifies or @timeout_ms expires. The messages stay in the
+ * vring buffers until rpmsg_vdev_recv_release().
+ *
+ * @ept: endpoint with pull enabled
+ * @msgs: returned messages
+ * @max: maximum number of messages
+ * @timeout_ms: timeout, 0 to not wait, negative to wait forever
+ *
+ * return number of messages, 0 on timeout, negative value on failure
+ */
+int rpmsg_vdev_recv_batch(struct rpmsg_endpoint *ept, struct rpmsg_vdev_msg *msgs,
+                          unsigned int max, int timeout_ms);
+
+/**
+ * rpmsg_vdev_recv_release - give the buffers of received messages back
+ *
+ * @ept: endpoint
+ * @msgs: messages returned by rpmsg_vdev_recv_batch()
+ * @n: number of messages, notified with a single kick
+ */
+void rpmsg_vdev_recv_release(struct rpmsg_endpoint *ept, struct rpmsg_vdev_msg *msgs, unsigned int n);
+
+/**
+ * rpmsg_vdev_recv - receive one message into a buffer
+ *
+ * @ept: endpoint with pull enabled
+ * @data: destination, the payload is truncated to @size
+ * @size: size of @data
+ * @src: source address, may be NULL
+ * @timeout_ms: same as rpmsg_vdev_recv_batch()
+ *
+ * return payload length, 0 on timeout, negative value on failure
+ */
+int rpmsg_vdev_recv(struct rpmsg_endpoint *ept, void *data, size_t size, uint32_t *src, int timeout_ms);
+
+/**
+ * rpmsg_vdev_trysend - send without waiting for a TX buffer
+ *
+ * @ept: endpoint
+ * @data: payload
+ * @len: payload length
+ *
+ * return number of bytes sent, -EAGAIN if no TX buffer is free,
+ * otherwise a RPMSG_ERR_* code
+ */
+int rpmsg_vdev_trysend(struct rpmsg_endpoint *ept, const void *data, int len);
+
+/**
+ * rpmsg_vdev_trysendto - send to an address without waiting for a TX buffer
+ *
+ * @ept: endpoint
+ * @data: payload
+ * @len: payload length
+ * @dst: destination address
+ *
+ * return same as rpmsg_vdev_trysend()
+ */
+int rpmsg_vdev_trysendto(struct rpmsg_endpoint *ept, const void *data, int len, uint32_t dst);
+
+/**
+ * rpmsg_vdev_set_tx_class - set the TX priority class of an endpoint
+ *
+ * Applies to the messages of the endpoint sent afterwards, whatever send
+ * function is used. Virtio master only; a remote side sends in order.
+ * Up to RPMSG_VDEV_TX_CLASS_EPT_MAX endpoints have a class other than
+ * normal; set RPMSG_VDEV_TX_NORMAL before destroying the endpoint.
+ *
+ * @ept: endpoint created on a platform rpmsg device
+ * @cls: class, RPMSG_VDEV_TX_NORMAL to go back to the default
+ *
+ * return 0 on success, RPMSG_ERR_NO_MEM if all entries are in use
+ */
+int rpmsg_vdev_set_tx_class(struct rpmsg_endpoint *ept, enum rpmsg_vdev_tx_class cls);
+
+/**
+ * rpmsg_vdev_credit_enable - enable credit-based flow control on an endpoint
+ *
+ * Each side may have @window messages to the other endpoint that were not
+ * consumed yet. A sender out of credits blocks like rpmsg_send() waiting
+ * for a TX buffer, or gets -EAGAIN from rpmsg_vdev_trysend() and the TX
+ * space available callback once credits come in. A message buffer taken
+ * with rpmsg_vdev_get_tx_buffer() holds a credit until it is sent or
+ * given back. The other endpoints keep sending meanwhile.
+ *
+ * A received message is consumed once its buffer goes back to the remote.
+ * Consumed messages are granted back in the header of the next message of
+ * the endpoint (RPMSG_VDEV_HDR_CREDIT, count in the reserved field), or
+ * in an empty message once half the window is owed. The remote side must
+ * use the same convention and window. Virtio master only.
+ *
+ * @ept: endpoint created on a platform rpmsg device
+ * @window: credits, 0 for the TX ring size / RPMSG_VDEV_CREDIT_EPT_MAX
+ *
+ * return 0 on success, RPMSG_ERR_NO_MEM if all entries are in use
+ */
+int rpmsg_vdev_credit_enable(struct rpmsg_endpoint *ept, unsigned int window);
+
+/**
+ * rpmsg_vdev_credit_disable - disable the flow control of an endpoint
+ *
+ * Must not be called while another thread sends on the endpoint, and must
+ * be called before the endpoint is destroyed.
+ *
+ * @ept: endpoint
+ */
+void rpmsg_vdev_credit_disable(struct rpmsg_endpoint *ept);
+
+/**
+ * rpmsg_vdev_sendto_deadline - send, waiting for a TX buffer, with a deadline
+ *
+ * Among the blocked senders of a class, the earliest deadline gets the
+ * next TX buffer (EDF). A missed deadline is only counted; the message is
+ * still sent.
+ *
+ * @ept: endpoint
+ * @data: payload
+ * @len: payload length
+ * @dst: destination address
+ * @deadline_us: CLOCK_MONOTONIC time in microseconds, see
+ *               rpmsg_vdev_deadline_in()
+ *
+ * return number of bytes sent, negative value on failure
+ */
+int rpmsg_vdev_sendto_deadline(struct rpmsg_endpoint *ept, const void *data, int len,
+                               uint32_t dst, uint64_t deadline_us);
+
+/**
+ * rpmsg_vdev_send_deadline - same as rpmsg_vdev_sendto_deadline() to the bound address
+ */
+int rpmsg_vdev_send_deadline(struct rpmsg_endpoint *ept, const void *data, int len, uint64_t deadline_us);
+
+/**
+ * rpmsg_vdev_deadline_in - deadline @usec microseconds from now
+ */
+static inline uint64_t rpmsg_vdev_deadline_in(uint32_t usec)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000U + (uint64_t)now.tv_nsec / 1000U + usec;
+}
+
+/**
+ * rpmsg_vdev_get_tx_buffer - take a TX buffer to build a message in place
+ *
+ * The payload is written directly into the shared memory buffer, then sent
+ * with rpmsg_vdev_send_nocopy() or given back with
+ * rpmsg_vdev_release_tx_buffer(). Virtio master only.
+ *
+ * @ept: endpoint
+ * @size: returns the payload capacity, may be NULL
+ * @wait: block like rpmsg_send() if no buffer is free; otherwise return
+ *        NULL and arm the TX space available callback like
+ *        rpmsg_vdev_trysend()
+ *
+ * return payload pointer, NULL if no buffer could be taken
+ */
+void *rpmsg_vdev_get_tx_buffer(struct rpmsg_endpoint *ept, uint32_t *size, int wait);
+
+/**
+ * rpmsg_vdev_send_nocopy - send a buffer taken with rpmsg_vdev_get_tx_buffer()
+ *
+ * The buffer belongs to the remote afterwards, unless RPMSG_ERR_PARAM or
+ * RPMSG_ERR_BUFF_SIZE is returned.
+ *
+ * @ept: endpoint
+ * @data: payload pointer returned by rpmsg_vdev_get_tx_buffer()
+ * @len: payload length
+ *
+ * return number of bytes sent, negative value on failure
+ */
+int rpmsg_vdev_send_nocopy(struct rpmsg_endpoint *ept, void *data, int len);
+
+/**
+ * rpmsg_vdev_sendto_nocopy - same as rpmsg_vdev_send_nocopy() to an address
+ */
+int rpmsg_vdev_sendto_nocopy(struct rpmsg_endpoint *ept, void *data, int len, uint32_t dst);
+
+/**
+ * rpmsg_vdev_release_tx_buffer - give back an unsent TX buffer
+ *
+ * @ept: endpoint
+ * @data: payload pointer returned by rpmsg_vdev_get_tx_buffer()
+ */
+void rpmsg_vdev_release_tx_buffer(struct rpmsg_endpoint *ept, void *data);
+
+/**
+ * rpmsg_vdev_sendtov - send a message gathered from several pieces
+ *
+ * The pieces are copied straight into a TX buffer, taken like
+ * rpmsg_send() does, instead of being assembled in a local buffer first.
+ * A message fits in one RPMsg buffer; it is never split over several.
+ *
+ * @ept: endpoint
+ * @iov: pieces of the payload, in order
+ * @iovcnt: number of pieces
+ * @dst: destination address
+ *
+ * return number of bytes sent, RPMSG_ERR_BUFF_SIZE if the pieces exceed
+ *        one buffer, another negative value on failure
+ */
+int rpmsg_vdev_sendtov(struct rpmsg_endpoint *ept, const struct iovec *iov, int iovcnt, uint32_t dst);
+
+/**
+ * rpmsg_vdev_sendv - same as rpmsg_vdev_sendtov() to the bound address
+ */
+int rpmsg_vdev_sendv(struct rpmsg_endpoint *ept, const struct iovec *iov, int iovcnt);
+
+/**
+ * rpmsg_vdev_set_tx_ready_cb - register a TX space available callback
+ *
+ * Pass a NULL @cb to unregister, which must be done before the endpoint
+ * is destroyed.
+ *
+ * @ept: endpoint created on a platform rpmsg device
+ * @cb: callback, or NULL
+ * @priv: private data passed to @cb
+ *
+ * return 0 on success, RPMSG_ERR_NO_MEM if all entries are in use
+ */
+int rpmsg_vdev_set_tx_ready_cb(struct rpmsg_endpoint *ept, rpmsg_vdev_tx_ready_cb cb, void *priv);
+
+/**
+ * rpmsg_vdev_tx_fd - pollable TX space available event
+ *
+ * The eventfd becomes readable when the remote gives TX buffers back after
+ * a non-blocking send returned -EAGAIN. It is written by the mailbox
+ * interrupt handler, so it also works without platform_poll(). Read it,
+ * then retry the send or call rpmsg_vdev_tx_dispatch().
+ *
+ * @rdev: rpmsg device
+ *
+ * return file descriptor, or negative value if it is not available
+ */
+int rpmsg_vdev_tx_fd(struct rpmsg_device *rdev);
+
+/**
+ * rpmsg_vdev_tx_dispatch - run the armed TX space available callbacks
+ *
+ * Called from the TX virtqueue callback; event loops that do not call
+ * platform_poll() call it after the eventfd became readable.
+ *
+ * @rdev: rpmsg device
+ */
+void rpmsg_vdev_tx_dispatch(struct rpmsg_device *rdev);
+
+/**
+ * rpmsg_vdev_from_rdev - get the platform device of a rpmsg device
+ *
+ * @rdev: rpmsg device returned by platform_create_rpmsg_vdev()
+ *
+ * return pointer to the platform device
+ */
+static inline struct rpmsg_vdev *rpmsg_vdev_from_rdev(struct rpmsg_device *rdev)
+{
+    return (struct rpmsg_vdev *)metal_container_of(rdev, struct rpmsg_vdev, rvdev.rdev);
+}
+
+#endif /* RPMSG_VDEV_H_ */
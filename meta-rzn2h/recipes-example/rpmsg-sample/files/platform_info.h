@@ -22,6 +22,9 @@
 #include <openamp/rpmsg.h>
 #include <openamp/remoteproc.h>
 #include "OpenAMP_RPMsg_cfg.h"
+#include "rpmsg_stats.h"
+
+struct rpmsg_vdev;
 
 // Macros for printf
 #define LPRINTF(format, ...) (printf(format, ##__VA_ARGS__))
@@ -76,13 +79,61 @@
 #define SHM_DEV_NAME    "206001000.intercpu-shm"
 #endif
 
+// Remote core name used as the statistics label
+#if (RPMSG_REMOTE_CORE == 0)
+#define RPMSG_REMOTE_NAME "CR52"
+#elif (RPMSG_REMOTE_CORE == 1)
+#define RPMSG_REMOTE_NAME "CA55"
+#endif
+
 // Macros for shared memory
 #define SHM_TX_OFFSET(ch) (0x04U * ch)
 #define SHM_RX_OFFSET(ch) (0x04U * ch)
 
+// Event channels: SWINT channels the vrings do not use, carrying 32-bit
+// event codes in their shared memory slots (platform_event_send())
+#define EVENT_TX_CH     (0x2U)
+#define EVENT_RX_CH     (0x3U)
+#if MBX_IO_INDEX(EVENT_TX_CH) != MBX_IO_INDEX(MBX_TX_CH)
+#error "EVENT_TX_CH must be in the SWINT register block of MBX_TX_CH"
+#endif
+// Slot reads before platform_event_send() gives up on the remote
+#define EVENT_SEND_WAIT (60 * 1000)
+
 // The number of maximum remoteproc vdevs
 #define RPVDEV_MAX_NUM (MBX_MAX_CH)
 
+// rpmsg vdevs in the resource table of a channel (vdev_index 0 .. n - 1),
+// each with its own vring pair and notify ids; the remote firmware must
+// declare as many vdev entries
+#ifndef RSC_VDEV_NUM
+#define RSC_VDEV_NUM (1U)
+#endif
+
+// Cache line of the cores sharing the vrings. Vrings placed and aligned on
+// it keep the lines written by the driver (descriptors and avail ring) apart
+// from those written by the device (used ring)
+#define VRING_CACHE_LINE (64U)
+
+// Notification word in the shared memory slot, written by its sender only.
+// With NOTIFY_COUNT_FLAG set, field n of NOTIFY_COUNT_BITS bits counts the
+// notifications of notify id n. The receiver compares each field with the
+// word it saw last and checks the virtqueues whose count moved, so it never
+// writes the word and no notification is lost unless the sender notifies
+// one id 2^NOTIFY_COUNT_BITS times between two reads. Any other value is
+// the notify_id of the sender (legacy format) and all virtqueues are
+// checked; notify ids from NOTIFY_COUNT_IDS up are sent that way.
+#define NOTIFY_COUNT_FLAG   (0x80000000U)
+#define NOTIFY_COUNT_BITS   (7U)
+#define NOTIFY_COUNT_IDS    (4U)
+#define NOTIFY_COUNT_FIELD(id) (((1U << NOTIFY_COUNT_BITS) - 1U) << ((id) * NOTIFY_COUNT_BITS))
+// vdev feature bit: the remote offers it in dfeatures of its vdev entries
+// when it takes the counting format, the host sends that format from then
+// on and sets the bit in gfeatures. Both formats are always received.
+#define RPMSG_F_NOTIFY_COUNT (8U)
+// notify_mask value asking for all virtqueues
+#define NOTIFY_CHECK_ALL    (0x80000000U)
+
 // Macro used for translating addr from CR to CA
 #if (RPMSG_REMOTE_CORE == 0)
 #define ADDRESS_CR_DDR_BASE     (0xE0000000)
@@ -103,9 +154,13 @@ struct ipi_info {
     int registered;
     unsigned int mbx_chn[CFG_RPMSG_SVCNO];
     unsigned int chn_mask; /**< IPI channel mask */
+    uint32_t notify_seen; /**< notification word of the remote seen last, counting format */
+    uint32_t notify_sent; /**< notification word of ours, 0 while sending the legacy format */
 #ifdef __linux__
     atomic_flag sync;
-    uint32_t notify_id;
+    uint32_t notify_mask; /**< pending notify ids, NOTIFY_CHECK_ALL to check all */
+    struct rpmsg_stats_channel *stats; /**< statistics of the channel in service */
+    struct rpmsg_vdev *rpvdev[RSC_VDEV_NUM]; /**< devices in service by vdev index, woken up on notification */
 #else
     ID ipi_sem_id[CFG_RPMSG_SVCNO];
 #endif
@@ -128,6 +183,7 @@ struct vring_info {
 struct remoteproc_priv {
     unsigned int notify_id;
     unsigned int mbx_chn_id;
+    struct rpmsg_stats_channel *stats; /**< statistics of the channel */
     struct vring_info *vr_info;
 };
 
@@ -189,4 +245,43 @@ void platform_release_rpmsg_vdev(void *platform, struct rpmsg_device *rpdev);
  */
 void platform_cleanup(void *platform);
 
+/**
+ * platform_event_send - signal an event code to the remote
+ *
+ * Puts @code into the slot of the event channel, once the remote took the
+ * previous one, and rings the doorbell of the channel. No vring is
+ * involved, so an urgent event does not queue behind the messages.
+ *
+ * @code: event code, any value but 0
+ *
+ * return 0 for success, negative value if the remote does not take the
+ * previous event or the channel is not set up
+ */
+int platform_event_send(uint32_t code);
+
+/**
+ * platform_event_poll - take the event code signalled by the remote
+ *
+ * The event channel has no interrupt handler on Linux, the receiver polls
+ * the slot; taking the code lets the remote signal the next one.
+ *
+ * @code: pointer to store the event code
+ *
+ * return 1 if an event was taken, 0 if none is pending, negative value
+ * for errors
+ */
+int platform_event_poll(uint32_t *code);
+
+/**
+ * platform_event_wait - poll for an event code until one arrives
+ *
+ * Spins on platform_event_poll(), for a core dedicated to the caller.
+ *
+ * @code: pointer to store the event code
+ * @stop: returns once *stop is non-zero
+ *
+ * return 1 if an event was taken, 0 once stopped, negative value for errors
+ */
+int platform_event_wait(uint32_t *code, volatile int *stop);
+
 #endif /* PLATFORM_INFO_H_ */
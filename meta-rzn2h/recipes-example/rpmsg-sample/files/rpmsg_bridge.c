@@ -0,0 +1,417 @@
+/**
+ * @file    rpmsg_bridge.c
+ * @brief   Bridge exposing rpmsg services as Unix seqpacket sockets.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#define _GNU_SOURCE /* accept4(), recvmmsg(), sendmmsg() */
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "platform_info.h"
+#include "rpmsg_vdev.h"
+#include "rpmsg_poller.h"
+#include "rpmsg_serve.h"
+#include "rpmsg_bridge.h"
+
+// Packets moved per service and direction in one system call
+#define BRIDGE_BATCH    (16U)
+// Poller event, TX space event, then one per service
+#define BRIDGE_PFD_MAX  (2U + RPMSG_BRIDGE_SERVICE_MAX)
+
+/**
+ * @struct bridge_service
+ * @brief  announced service, its endpoint and its socket
+ */
+struct bridge_service {
+    struct rpmsg_endpoint ept;
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    int listen_fd;                  /**< -1 when the entry is free */
+    int conn;                       /**< connection, -1 if none */
+    int hup;                        /**< the peer hung up, packets may be left */
+    int tx_more;                    /**< packets may be waiting on the connection */
+    int tx_blocked;                 /**< no TX buffer, waiting for the TX ready callback */
+    int rx_blocked;                 /**< the connection is full, waiting for POLLOUT */
+    struct rpmsg_vdev_msg rx[BRIDGE_BATCH]; /**< received, not written to the connection yet */
+    unsigned int rx_num;
+};
+
+/**
+ * @struct bridge
+ * @brief  bridge of one device, only used by the thread running it
+ */
+struct bridge {
+    struct rpmsg_device *rdev;
+    struct rpmsg_poller poller;
+    const char *dir;
+    struct bridge_service service[RPMSG_BRIDGE_SERVICE_MAX];
+};
+
+/* Running bridges, for the name service callback */
+static struct rpmsg_serve_registry bridges = RPMSG_SERVE_REGISTRY_INITIALIZER;
+
+static void bridge_tx_ready(struct rpmsg_endpoint *ept, void *priv)
+{
+    struct bridge_service *s = priv;
+
+    (void)ept;
+    s->tx_blocked = 0;
+    s->tx_more = 1;
+}
+
+/* Drop the connection and the messages not written to it yet */
+static void bridge_conn_close(struct bridge_service *s)
+{
+    if (s->rx_num) {
+        rpmsg_vdev_recv_release(&s->ept, s->rx, s->rx_num);
+        s->rx_num = 0;
+    }
+    if (s->conn >= 0)
+        (void)close(s->conn);
+    s->conn = -1;
+    s->hup = 0;
+    s->tx_more = 0;
+    s->rx_blocked = 0;
+}
+
+static int bridge_service_open(struct bridge *b, struct bridge_service *s, const char *name, uint32_t dest)
+{
+    int ret;
+
+    /* The name becomes a file name */
+    if (!name[0] || (name[0] == '.') || strchr(name, '/'))
+        return RPMSG_ERR_PARAM;
+    if (snprintf(s->path, sizeof(s->path), "%s/%s", b->dir, name) >= (int)sizeof(s->path))
+        return -ENAMETOOLONG;
+
+    s->listen_fd = rpmsg_serve_listen(s->path);
+    if (s->listen_fd < 0)
+        return s->listen_fd;
+    ret = rpmsg_create_ept(&s->ept, b->rdev, name, RPMSG_ADDR_ANY, dest, rpmsg_serve_ept_cb, rpmsg_serve_unbind_cb);
+    if (ret)
+        goto err_close;
+    ret = rpmsg_vdev_pull_enable(&s->ept);
+    if (!ret)
+        ret = rpmsg_vdev_set_tx_ready_cb(&s->ept, bridge_tx_ready, s);
+    if (ret) {
+        rpmsg_vdev_pull_disable(&s->ept);
+        rpmsg_destroy_ept(&s->ept);
+        goto err_close;
+    }
+    s->conn = -1;
+    s->tx_blocked = 0;
+    bridge_conn_close(s);
+
+    return 0;
+
+err_close:
+    (void)close(s->listen_fd);
+    (void)unlink(s->path);
+    s->listen_fd = -1;
+    return ret;
+}
+
+static void bridge_service_close(struct bridge_service *s)
+{
+    if (s->listen_fd < 0)
+        return;
+
+    bridge_conn_close(s);
+    (void)rpmsg_vdev_set_tx_ready_cb(&s->ept, NULL, NULL);
+    rpmsg_vdev_pull_disable(&s->ept);
+    rpmsg_destroy_ept(&s->ept);
+    (void)close(s->listen_fd);
+    (void)unlink(s->path);
+    s->listen_fd = -1;
+}
+
+/* Called on the bridge thread, from rpmsg_poller_run() or a receive */
+void rpmsg_bridge_ns_bind(struct rpmsg_device *rdev, const char *name, uint32_t dest)
+{
+    struct bridge *b;
+    unsigned int i;
+    int ret;
+
+    b = rpmsg_serve_find(&bridges, rdev);
+    if (!b)
+        return;
+
+    /* open-amp binds the names it knows itself, so this is a new service */
+    for (i = 0; i < RPMSG_BRIDGE_SERVICE_MAX; i++) {
+        if (b->service[i].listen_fd < 0)
+            break;
+    }
+    if (i == RPMSG_BRIDGE_SERVICE_MAX) {
+        LPERROR("Too many services, %s is ignored.\n", name);
+        return;
+    }
+
+    ret = bridge_service_open(b, &b->service[i], name, dest);
+    if (ret)
+        LPERROR("Failed to bridge %s: %d.\n", name, ret);
+    else
+        LPRINTF("%s bridged to %s.\n", name, b->service[i].path);
+}
+
+static void bridge_accept(struct bridge_service *s)
+{
+    int fd;
+
+    fd = accept4(s->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0)
+        return;
+    s->conn = fd;
+    s->tx_more = 1;
+}
+
+/*
+ * Read packets from the connection straight into TX buffers and send them.
+ * One buffer is taken first and twice as many on each turn the packets fill
+ * them all, so an idle connection does not hold a batch of TX buffers.
+ * Returns 1 if packets may be left for the next turn.
+ */
+static int bridge_pump_tx(struct bridge_service *s)
+{
+    struct mmsghdr mm[BRIDGE_BATCH];
+    struct iovec iov[BRIDGE_BATCH];
+    void *buf[BRIDGE_BATCH];
+    uint32_t size = 0;
+    unsigned int i, n, want = 1U, total = 0U;
+    int got, ret, eof = 0;
+
+    do {
+        for (n = 0; n < want; n++) {
+            buf[n] = rpmsg_vdev_get_tx_buffer(&s->ept, &size, 0);
+            if (!buf[n])
+                break;
+            iov[n].iov_base = buf[n];
+            iov[n].iov_len = size;
+            memset(&mm[n], 0, sizeof(mm[n]));
+            mm[n].msg_hdr.msg_iov = &iov[n];
+            mm[n].msg_hdr.msg_iovlen = 1;
+        }
+        if (!n) {
+            s->tx_blocked = 1;
+            return 0;
+        }
+
+        got = recvmmsg(s->conn, mm, n, MSG_DONTWAIT, NULL);
+        if (got < 0) {
+            if ((errno != EAGAIN) && (errno != EINTR))
+                eof = 1;
+            got = 0;
+        }
+
+        for (i = 0; i < n; i++) {
+            if ((i < (unsigned int)got) && mm[i].msg_len && !(mm[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+                ret = rpmsg_vdev_send_nocopy(&s->ept, buf[i], (int)mm[i].msg_len);
+                if ((ret == RPMSG_ERR_PARAM) || (ret == RPMSG_ERR_BUFF_SIZE))
+                    rpmsg_vdev_release_tx_buffer(&s->ept, buf[i]);
+                if (ret < 0)
+                    LPERROR("Failed to send for %s: %d.\n", s->ept.name, ret);
+                continue;
+            }
+            if (i < (unsigned int)got) {
+                if (mm[i].msg_hdr.msg_flags & MSG_TRUNC)
+                    LPERROR("Packet for %s larger than %u bytes dropped.\n", s->ept.name, (unsigned int)size);
+                /* Reads return nothing once the peer is gone */
+                else if (s->hup)
+                    eof = 1;
+            }
+            rpmsg_vdev_release_tx_buffer(&s->ept, buf[i]);
+        }
+
+        if (eof) {
+            bridge_conn_close(s);
+            return 0;
+        }
+        s->tx_more = ((unsigned int)got == n);
+        total += n;
+        /* Done once the packets or the TX buffers run out */
+        if (!s->tx_more || (n < want))
+            break;
+        want = (2U * n < BRIDGE_BATCH - total) ? 2U * n : BRIDGE_BATCH - total;
+    } while (want);
+
+    return s->tx_more;
+}
+
+/*
+ * Write received messages to the connection from their vring buffers, or
+ * drop them if there is none. Returns 1 if messages may be left.
+ */
+static int bridge_pump_rx(struct bridge_service *s)
+{
+    struct mmsghdr mm[BRIDGE_BATCH];
+    struct iovec iov[BRIDGE_BATCH];
+    unsigned int i;
+    int n, sent;
+
+    if (!s->rx_num) {
+        n = rpmsg_vdev_recv_batch(&s->ept, s->rx, BRIDGE_BATCH, 0);
+        if (n <= 0)
+            return 0;
+        s->rx_num = (unsigned int)n;
+        if (s->conn < 0) {
+            rpmsg_vdev_recv_release(&s->ept, s->rx, s->rx_num);
+            s->rx_num = 0;
+            return (unsigned int)n == BRIDGE_BATCH;
+        }
+    } else if (s->rx_blocked) {
+        return 0;
+    }
+
+    for (i = 0; i < s->rx_num; i++) {
+        iov[i].iov_base = s->rx[i].data;
+        iov[i].iov_len = s->rx[i].len;
+        memset(&mm[i], 0, sizeof(mm[i]));
+        mm[i].msg_hdr.msg_iov = &iov[i];
+        mm[i].msg_hdr.msg_iovlen = 1;
+    }
+    sent = sendmmsg(s->conn, mm, s->rx_num, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent < 0) {
+        if ((errno == EAGAIN) || (errno == EINTR))
+            s->rx_blocked = 1;
+        else
+            bridge_conn_close(s);
+        return 0;
+    }
+
+    rpmsg_vdev_recv_release(&s->ept, s->rx, (unsigned int)sent);
+    s->rx_num -= (unsigned int)sent;
+    memmove(s->rx, &s->rx[sent], s->rx_num * sizeof(s->rx[0]));
+
+    return s->rx_num || ((unsigned int)sent == BRIDGE_BATCH);
+}
+
+int rpmsg_bridge_run(struct rpmsg_device *rdev, const char *dir, volatile int *stop)
+{
+    struct bridge *b;
+    struct bridge_service *s;
+    struct pollfd pfd[BRIDGE_PFD_MAX];
+    int svc_pfd[RPMSG_BRIDGE_SERVICE_MAX];
+    unsigned int i, n;
+    short revents;
+    int ret, more = 0;
+
+    if (!rdev || !dir || !stop)
+        return RPMSG_ERR_PARAM;
+
+    b = calloc(1, sizeof(*b));
+    if (!b)
+        return RPMSG_ERR_NO_MEM;
+    b->rdev = rdev;
+    b->dir = dir;
+    for (i = 0; i < RPMSG_BRIDGE_SERVICE_MAX; i++) {
+        b->service[i].listen_fd = -1;
+        b->service[i].conn = -1;
+    }
+
+    if (mkdir(dir, 0755) && (errno != EEXIST)) {
+        ret = -errno;
+        LPERROR("Failed to create %s: %d.\n", dir, ret);
+        goto err_free;
+    }
+    ret = rpmsg_poller_init(&b->poller);
+    if (ret)
+        goto err_free;
+    ret = rpmsg_serve_register(&bridges, rdev, b);
+    if (ret)
+        goto err_poller;
+    ret = rpmsg_poller_add(&b->poller, rdev, 0);
+    if (ret)
+        goto err_unregister;
+    LPRINTF("rpmsg bridge serving %s.\n", dir);
+
+    while (!*stop) {
+        n = 0;
+        pfd[n++] = (struct pollfd){ rpmsg_poller_fd(&b->poller), POLLIN, 0 };
+        pfd[n++] = (struct pollfd){ rpmsg_vdev_tx_fd(rdev), POLLIN, 0 };
+        for (i = 0; i < RPMSG_BRIDGE_SERVICE_MAX; i++) {
+            s = &b->service[i];
+            svc_pfd[i] = -1;
+            if (s->listen_fd < 0)
+                continue;
+            if (s->conn < 0) {
+                svc_pfd[i] = (int)n;
+                pfd[n++] = (struct pollfd){ s->listen_fd, POLLIN, 0 };
+                continue;
+            }
+            /* A hangup stays reported until the packets left are read */
+            if (s->hup && s->tx_blocked && !s->rx_blocked)
+                continue;
+            svc_pfd[i] = (int)n;
+            pfd[n++] = (struct pollfd){ s->conn, (short)((s->tx_blocked ? 0 : POLLIN) | (s->rx_blocked ? POLLOUT : 0)), 0 };
+        }
+
+        ret = poll(pfd, n, more ? 0 : RPMSG_BRIDGE_STOP_CHECK_MS);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            ret = -errno;
+            break;
+        }
+        ret = 0;
+
+        /* Received messages go to the pull queues, announcements open services */
+        if (pfd[0].revents & POLLIN)
+            (void)rpmsg_poller_run(&b->poller);
+        if (pfd[1].revents & POLLIN)
+            rpmsg_vdev_tx_dispatch(rdev);
+        for (i = 0; i < RPMSG_BRIDGE_SERVICE_MAX; i++) {
+            s = &b->service[i];
+            if (svc_pfd[i] < 0)
+                continue;
+            revents = pfd[svc_pfd[i]].revents;
+            if (s->conn < 0) {
+                if (revents & POLLIN)
+                    bridge_accept(s);
+                continue;
+            }
+            if (revents & (POLLHUP | POLLERR))
+                s->hup = 1;
+            if (revents & (POLLIN | POLLHUP | POLLERR))
+                s->tx_more = 1;
+            if (revents & (POLLOUT | POLLERR))
+                s->rx_blocked = 0;
+        }
+
+        more = 0;
+        for (i = 0; i < RPMSG_BRIDGE_SERVICE_MAX; i++) {
+            s = &b->service[i];
+            if (s->listen_fd < 0)
+                continue;
+            if ((s->conn >= 0) && s->tx_more && !s->tx_blocked)
+                more |= bridge_pump_tx(s);
+            more |= bridge_pump_rx(s);
+        }
+    }
+
+    for (i = 0; i < RPMSG_BRIDGE_SERVICE_MAX; i++)
+        bridge_service_close(&b->service[i]);
+    rpmsg_poller_remove(&b->poller, rdev);
+err_unregister:
+    rpmsg_serve_unregister(&bridges, b);
+err_poller:
+    rpmsg_poller_deinit(&b->poller);
+    (void)rmdir(dir);
+err_free:
+    free(b);
+
+    return ret;
+}
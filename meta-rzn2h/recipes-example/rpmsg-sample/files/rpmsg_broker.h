@@ -0,0 +1,62 @@
+/**
+ * @file    rpmsg_broker.h
+ * @brief   Broker sharing one rpmsg device between Linux processes.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * The process owning the platform runs one broker per rpmsg device. Each
+ * client process opens its endpoints through the broker socket (see
+ * rpmsg_broker_proto.h and rpmsg_broker_client.h) and exchanges messages
+ * through shared memory rings, so several services talk to the remote
+ * side concurrently without a process of their own relaying them.
+ *
+ * A message is copied once on each way, between the client ring and the
+ * vring buffer. Received messages stay in their vring buffer until the
+ * client ring has room, so a slow client throttles the remote side
+ * instead of losing messages.
+ */
+
+#ifndef RPMSG_BROKER_H_
+#define RPMSG_BROKER_H_
+
+#include <stdint.h>
+#include <openamp/rpmsg.h>
+#include "rpmsg_broker_proto.h"
+
+// Endpoints of one broker; each takes a pull queue and a TX ready entry
+#define RPMSG_BROKER_CLIENT_MAX     (8U)
+// Name service announcements remembered for endpoints opened later
+#define RPMSG_BROKER_NAME_MAX       (16U)
+// Interval at which the event loop checks the stop flag
+#define RPMSG_BROKER_STOP_CHECK_MS  (100)
+
+/**
+ * rpmsg_broker_ns_bind - name service callback of a brokered device
+ *
+ * Pass it to platform_create_rpmsg_vdev() for a device served by
+ * rpmsg_broker_run().
+ */
+void rpmsg_broker_ns_bind(struct rpmsg_device *rdev, const char *name, uint32_t dest);
+
+/**
+ * rpmsg_broker_run - serve a device to client processes
+ *
+ * Runs the event loop of the broker in the calling thread. The device is
+ * served by an rpmsg_poller of the broker, platform_poll() is not needed.
+ *
+ * @rdev: device, virtio master
+ * @path: path of the socket to listen on
+ * @stop: the broker returns once *stop is non-zero
+ *
+ * return 0 once stopped, negative value on failure
+ */
+int rpmsg_broker_run(struct rpmsg_device *rdev, const char *path, volatile int *stop);
+
+#endif /* RPMSG_BROKER_H_ */
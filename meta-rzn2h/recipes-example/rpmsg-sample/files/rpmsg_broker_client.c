@@ -0,0 +1,303 @@
+/**
+ * @file    rpmsg_broker_client.c
+ * @brief   Client side of the rpmsg broker.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "rpmsg_broker_client.h"
+
+static void chan_kick(struct rpmsg_broker_chan *ch)
+{
+    uint64_t one = 1;
+
+    (void)write(ch->kick_fd, &one, sizeof(one));
+}
+
+static void deadline_set(struct timespec *deadline, int timeout_ms)
+{
+    (void)clock_gettime(CLOCK_MONOTONIC, deadline);
+    if (timeout_ms <= 0)
+        return;
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+/*
+ * Sleep until the broker wakes the channel. Returns 0 when woken (or
+ * interrupted), -ETIMEDOUT once the deadline passed, -EPIPE if the broker
+ * went away.
+ */
+static int chan_wait(struct rpmsg_broker_chan *ch, int timeout_ms, const struct timespec *deadline)
+{
+    struct pollfd pfd[2];
+    struct timespec now;
+    long left = -1;
+    uint64_t cnt;
+    int ret;
+
+    if (timeout_ms >= 0) {
+        (void)clock_gettime(CLOCK_MONOTONIC, &now);
+        left = (deadline->tv_sec - now.tv_sec) * 1000L + (deadline->tv_nsec - now.tv_nsec) / 1000000L;
+        if (left <= 0)
+            return -ETIMEDOUT;
+    }
+
+    pfd[0].fd = ch->wake_fd;
+    pfd[0].events = POLLIN;
+    /* The broker never writes to the socket after the reply: readable means closed */
+    pfd[1].fd = ch->sock;
+    pfd[1].events = POLLIN;
+    ret = poll(pfd, 2, (int)left);
+    if (ret < 0)
+        return (errno == EINTR) ? 0 : -errno;
+    if (pfd[1].revents)
+        return -EPIPE;
+    if (pfd[0].revents & POLLIN)
+        (void)read(ch->wake_fd, &cnt, sizeof(cnt));
+
+    return 0;
+}
+
+static int chan_request(struct rpmsg_broker_chan *ch, const char *name, uint32_t src, uint32_t dst, int *fds)
+{
+    struct rpmsg_broker_open req;
+    struct rpmsg_broker_reply reply;
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int) * RPMSG_BROKER_FDS)];
+    } ctl;
+    ssize_t len;
+
+    memset(&req, 0, sizeof(req));
+    req.version = RPMSG_BROKER_VERSION;
+    req.src = src;
+    req.dst = dst;
+    strncpy(req.name, name, sizeof(req.name) - 1);
+    if (send(ch->sock, &req, sizeof(req), MSG_NOSIGNAL) != (ssize_t)sizeof(req))
+        return -errno;
+
+    iov.iov_base = &reply;
+    iov.iov_len = sizeof(reply);
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl.buf;
+    msg.msg_controllen = sizeof(ctl.buf);
+    len = recvmsg(ch->sock, &msg, MSG_CMSG_CLOEXEC);
+    if (len < 0)
+        return -errno;
+    if (len != (ssize_t)sizeof(reply))
+        return -EPROTO;
+    if (reply.status)
+        return reply.status;
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || (cmsg->cmsg_level != SOL_SOCKET) || (cmsg->cmsg_type != SCM_RIGHTS) ||
+        (cmsg->cmsg_len != CMSG_LEN(sizeof(int) * RPMSG_BROKER_FDS)))
+        return -EPROTO;
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * RPMSG_BROKER_FDS);
+    ch->src = reply.src;
+
+    return 0;
+}
+
+int rpmsg_broker_open(struct rpmsg_broker_chan *ch, const char *path, const char *name,
+                      uint32_t src, uint32_t dst)
+{
+    struct sockaddr_un addr;
+    int fds[RPMSG_BROKER_FDS];
+    void *shm;
+    int ret;
+
+    if (!ch || !path || !name || (strlen(path) >= sizeof(addr.sun_path)))
+        return -EINVAL;
+
+    ch->kick_fd = -1;
+    ch->wake_fd = -1;
+    ch->shm = NULL;
+    ch->sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (ch->sock < 0)
+        return -errno;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (connect(ch->sock, (struct sockaddr *)&addr, sizeof(addr))) {
+        ret = -errno;
+        goto err;
+    }
+
+    ret = chan_request(ch, name, src, dst, fds);
+    if (ret)
+        goto err;
+    ch->kick_fd = fds[1];
+    ch->wake_fd = fds[2];
+    shm = mmap(NULL, sizeof(*ch->shm), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    (void)close(fds[0]);
+    if (shm == MAP_FAILED) {
+        ret = -errno;
+        goto err;
+    }
+    ch->shm = shm;
+    if (ch->shm->version != RPMSG_BROKER_VERSION) {
+        ret = -EPROTO;
+        goto err;
+    }
+
+    return 0;
+
+err:
+    rpmsg_broker_close(ch);
+    return ret;
+}
+
+void rpmsg_broker_close(struct rpmsg_broker_chan *ch)
+{
+    if (ch->shm)
+        (void)munmap(ch->shm, sizeof(*ch->shm));
+    if (ch->kick_fd >= 0)
+        (void)close(ch->kick_fd);
+    if (ch->wake_fd >= 0)
+        (void)close(ch->wake_fd);
+    if (ch->sock >= 0)
+        (void)close(ch->sock);
+    ch->shm = NULL;
+    ch->kick_fd = -1;
+    ch->wake_fd = -1;
+    ch->sock = -1;
+}
+
+int rpmsg_broker_ready(struct rpmsg_broker_chan *ch)
+{
+    return __atomic_load_n(&ch->shm->dst, __ATOMIC_ACQUIRE) != RPMSG_BROKER_ADDR_ANY;
+}
+
+int rpmsg_broker_wait_ready(struct rpmsg_broker_chan *ch, int timeout_ms)
+{
+    struct timespec deadline;
+    int ret;
+
+    deadline_set(&deadline, timeout_ms);
+    while (!rpmsg_broker_ready(ch)) {
+        ret = chan_wait(ch, timeout_ms, &deadline);
+        if (ret)
+            return ret;
+    }
+
+    return 0;
+}
+
+void *rpmsg_broker_get_tx_buffer(struct rpmsg_broker_chan *ch, int timeout_ms)
+{
+    struct rpmsg_broker_ring *r = &ch->shm->tx;
+    struct timespec deadline;
+
+    deadline_set(&deadline, timeout_ms);
+    for (;;) {
+        if (rpmsg_broker_ring_space(r))
+            return rpmsg_broker_ring_free_slot(r, 0)->data;
+        if (!rpmsg_broker_ring_wait_space(r))
+            continue;
+        if (!timeout_ms || chan_wait(ch, timeout_ms, &deadline))
+            return NULL;
+    }
+}
+
+int rpmsg_broker_send_nocopy(struct rpmsg_broker_chan *ch, void *data, uint32_t len, uint32_t dst)
+{
+    struct rpmsg_broker_ring *r = &ch->shm->tx;
+    struct rpmsg_broker_slot *slot;
+
+    if (len > RPMSG_BROKER_MSG_MAX)
+        return -EMSGSIZE;
+    if (!rpmsg_broker_ring_space(r))
+        return -EINVAL;
+    slot = rpmsg_broker_ring_free_slot(r, 0);
+    if (data != slot->data)
+        return -EINVAL;
+
+    slot->len = len;
+    slot->addr = dst;
+    if (rpmsg_broker_ring_commit(r, 1U))
+        chan_kick(ch);
+
+    return (int)len;
+}
+
+int rpmsg_broker_send(struct rpmsg_broker_chan *ch, const void *data, uint32_t len, int timeout_ms)
+{
+    void *buf;
+
+    if (len > RPMSG_BROKER_MSG_MAX)
+        return -EMSGSIZE;
+    buf = rpmsg_broker_get_tx_buffer(ch, timeout_ms);
+    if (!buf)
+        return -ETIMEDOUT;
+    memcpy(buf, data, len);
+
+    return rpmsg_broker_send_nocopy(ch, buf, len, RPMSG_BROKER_ADDR_ANY);
+}
+
+int rpmsg_broker_recv(struct rpmsg_broker_chan *ch, struct rpmsg_broker_msg *msgs,
+                      unsigned int max, int timeout_ms)
+{
+    struct rpmsg_broker_ring *r = &ch->shm->rx;
+    struct rpmsg_broker_slot *slot;
+    struct timespec deadline;
+    uint32_t i, n;
+    int ret;
+
+    deadline_set(&deadline, timeout_ms);
+    for (;;) {
+        n = rpmsg_broker_ring_count(r);
+        if (n)
+            break;
+        /* Armed even without waiting, for callers polling rpmsg_broker_fd() */
+        if (!rpmsg_broker_ring_wait_data(r))
+            continue;
+        if (!timeout_ms)
+            return 0;
+        ret = chan_wait(ch, timeout_ms, &deadline);
+        if (ret)
+            return (ret == -ETIMEDOUT) ? 0 : ret;
+    }
+
+    if (n > max)
+        n = max;
+    for (i = 0; i < n; i++) {
+        slot = rpmsg_broker_ring_used_slot(r, i);
+        msgs[i].data = slot->data;
+        msgs[i].len = (slot->len < RPMSG_BROKER_MSG_MAX) ? slot->len : RPMSG_BROKER_MSG_MAX;
+        msgs[i].src = slot->addr;
+    }
+
+    return (int)n;
+}
+
+void rpmsg_broker_recv_release(struct rpmsg_broker_chan *ch, unsigned int n)
+{
+    if (n && rpmsg_broker_ring_release(&ch->shm->rx, n))
+        chan_kick(ch);
+}
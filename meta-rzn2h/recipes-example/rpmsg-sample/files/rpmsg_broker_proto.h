@@ -0,0 +1,166 @@
+/**
+ * @file    rpmsg_broker_proto.h
+ * @brief   Protocol between the rpmsg broker and its client processes.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * A client connects to the SOCK_SEQPACKET socket of a broker and sends one
+ * struct rpmsg_broker_open. The broker creates the endpoint and answers
+ * with a struct rpmsg_broker_reply carrying three file descriptors:
+ * - a memfd holding struct rpmsg_broker_shm
+ * - the kick eventfd, written by the client to wake the broker
+ * - the wake eventfd, written by the broker to wake the client
+ *
+ * Messages then go through the two single-producer single-consumer rings
+ * of the shared memory. A side only writes an eventfd when the other side
+ * asked for it, so a busy channel needs no system call per message.
+ * Closing the socket closes the endpoint.
+ */
+
+#ifndef RPMSG_BROKER_PROTO_H_
+#define RPMSG_BROKER_PROTO_H_
+
+#include <stdint.h>
+
+// Socket of the broker serving rpmsg device <id>
+#define RPMSG_BROKER_PATH_FMT   "/run/rpmsg-broker-%lu.sock"
+#define RPMSG_BROKER_VERSION    (1U)
+// Same value as RPMSG_ADDR_ANY
+#define RPMSG_BROKER_ADDR_ANY   (0xFFFFFFFFU)
+// Same size as RPMSG_NAME_SIZE
+#define RPMSG_BROKER_NAME_SIZE  (32U)
+// Largest message (RPMsg buffer minus its header)
+#define RPMSG_BROKER_MSG_MAX    (512U - 16U)
+// Slots of each ring, a power of two
+#define RPMSG_BROKER_SLOTS      (32U)
+// Number of file descriptors passed with a successful reply
+#define RPMSG_BROKER_FDS        (3U)
+
+/**
+ * @struct rpmsg_broker_open
+ * @brief  request opening an endpoint
+ */
+struct rpmsg_broker_open {
+    uint32_t version;                   /**< RPMSG_BROKER_VERSION */
+    uint32_t src;                       /**< local address, or RPMSG_BROKER_ADDR_ANY */
+    uint32_t dst;                       /**< remote address, or RPMSG_BROKER_ADDR_ANY to bind by name */
+    char name[RPMSG_BROKER_NAME_SIZE];  /**< service name */
+};
+
+/**
+ * @struct rpmsg_broker_reply
+ * @brief  answer of the broker, with the file descriptors on success
+ */
+struct rpmsg_broker_reply {
+    int32_t status;  /**< 0, or a negative RPMSG_ERR_* / errno value */
+    uint32_t src;    /**< address of the endpoint */
+};
+
+/**
+ * @struct rpmsg_broker_slot
+ * @brief  one message in a ring
+ */
+struct rpmsg_broker_slot {
+    uint32_t len;
+    uint32_t addr;   /**< TX: destination, RPMSG_BROKER_ADDR_ANY for the bound one; RX: source */
+    unsigned char data[RPMSG_BROKER_MSG_MAX];
+};
+
+/**
+ * @struct rpmsg_broker_ring
+ * @brief  single-producer single-consumer ring of messages
+ *
+ * Indexes run freely and are taken modulo RPMSG_BROKER_SLOTS. Each index
+ * has its own cache line so that the two processes do not share one.
+ */
+struct rpmsg_broker_ring {
+    uint32_t head __attribute__((aligned(64)));             /**< next slot to fill, written by the producer */
+    uint32_t producer_waiting;                              /**< the producer wants a wakeup on space */
+    uint32_t tail __attribute__((aligned(64)));             /**< next slot to read, written by the consumer */
+    uint32_t consumer_waiting;                              /**< the consumer wants a wakeup on data */
+    struct rpmsg_broker_slot slot[RPMSG_BROKER_SLOTS] __attribute__((aligned(64)));
+};
+
+/**
+ * @struct rpmsg_broker_shm
+ * @brief  shared memory of one endpoint
+ */
+struct rpmsg_broker_shm {
+    uint32_t version;               /**< RPMSG_BROKER_VERSION */
+    uint32_t dst;                   /**< bound remote address, RPMSG_BROKER_ADDR_ANY until bound */
+    struct rpmsg_broker_ring tx;    /**< client to remote */
+    struct rpmsg_broker_ring rx;    /**< remote to client */
+};
+
+/* Producer: free slots, more than RPMSG_BROKER_SLOTS if the ring is corrupt */
+static inline uint32_t rpmsg_broker_ring_space(struct rpmsg_broker_ring *r)
+{
+    return RPMSG_BROKER_SLOTS - (r->head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE));
+}
+
+/* Producer: i-th free slot */
+static inline struct rpmsg_broker_slot *rpmsg_broker_ring_free_slot(struct rpmsg_broker_ring *r, uint32_t i)
+{
+    return &r->slot[(r->head + i) % RPMSG_BROKER_SLOTS];
+}
+
+/* Producer: publish n filled slots, return 1 if the consumer must be woken */
+static inline int rpmsg_broker_ring_commit(struct rpmsg_broker_ring *r, uint32_t n)
+{
+    __atomic_store_n(&r->head, r->head + n, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return __atomic_load_n(&r->consumer_waiting, __ATOMIC_RELAXED) &&
+           __atomic_exchange_n(&r->consumer_waiting, 0U, __ATOMIC_ACQ_REL);
+}
+
+/* Consumer: filled slots, more than RPMSG_BROKER_SLOTS if the ring is corrupt */
+static inline uint32_t rpmsg_broker_ring_count(struct rpmsg_broker_ring *r)
+{
+    return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - r->tail;
+}
+
+/* Consumer: i-th filled slot */
+static inline struct rpmsg_broker_slot *rpmsg_broker_ring_used_slot(struct rpmsg_broker_ring *r, uint32_t i)
+{
+    return &r->slot[(r->tail + i) % RPMSG_BROKER_SLOTS];
+}
+
+/* Consumer: give n slots back, return 1 if the producer must be woken */
+static inline int rpmsg_broker_ring_release(struct rpmsg_broker_ring *r, uint32_t n)
+{
+    __atomic_store_n(&r->tail, r->tail + n, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return __atomic_load_n(&r->producer_waiting, __ATOMIC_RELAXED) &&
+           __atomic_exchange_n(&r->producer_waiting, 0U, __ATOMIC_ACQ_REL);
+}
+
+/*
+ * Ask for a wakeup before sleeping. Return 0 if the ring changed meanwhile,
+ * in which case the caller looks again instead of sleeping.
+ */
+static inline int rpmsg_broker_ring_wait_data(struct rpmsg_broker_ring *r)
+{
+    __atomic_store_n(&r->consumer_waiting, 1U, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return !rpmsg_broker_ring_count(r);
+}
+
+static inline int rpmsg_broker_ring_wait_space(struct rpmsg_broker_ring *r)
+{
+    __atomic_store_n(&r->producer_waiting, 1U, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return !rpmsg_broker_ring_space(r);
+}
+
+#endif /* RPMSG_BROKER_PROTO_H_ */
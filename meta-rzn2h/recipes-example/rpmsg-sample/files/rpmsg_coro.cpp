@@ -0,0 +1,397 @@
+/**
+ * @file    rpmsg_coro.cpp
+ * @brief   C++20 coroutine client library over rpmsg endpoints.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include "rpmsg_coro.hpp"
+
+namespace rpmsg {
+
+/* Frame of a spawned coroutine, freed when it completes */
+struct executor::detached {
+    struct promise_type {
+        detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+executor::detached executor::drive(executor &ex, task<void> t)
+{
+    co_await ex.yield();
+    co_await t;
+    ex.live_--;
+}
+
+executor::executor() : live_(0), stop_(false)
+{
+    poller_ok_ = !rpmsg_poller_init(&poller_);
+}
+
+executor::~executor()
+{
+    if (poller_ok_)
+        rpmsg_poller_deinit(&poller_);
+}
+
+int executor::add(struct rpmsg_device *rdev, unsigned int budget)
+{
+    int ret;
+
+    if (!poller_ok_)
+        return RPMSG_ERR_INIT;
+    ret = rpmsg_poller_add(&poller_, rdev, budget);
+    if (!ret)
+        devs_.push_back(rdev);
+
+    return ret;
+}
+
+void executor::spawn(task<void> t)
+{
+    live_++;
+    (void)drive(*this, std::move(t));
+}
+
+void executor::fire_timers()
+{
+    clock::time_point now = clock::now();
+
+    while (!timers_.empty() && (timers_.begin()->first <= now)) {
+        std::function<void()> fn = std::move(timers_.begin()->second);
+
+        timers_.erase(timers_.begin());
+        fn();
+    }
+}
+
+int executor::run()
+{
+    std::vector<struct pollfd> fds;
+    std::vector<std::coroutine_handle<>> woken;
+    int timeout, ret;
+    size_t i;
+
+    stop_ = false;
+    fds.push_back({ rpmsg_poller_fd(&poller_), POLLIN, 0 });
+    for (struct rpmsg_device *rdev : devs_)
+        fds.push_back({ rpmsg_vdev_tx_fd(rdev), POLLIN, 0 });
+
+    while (live_ && !stop_) {
+        while (!ready_.empty()) {
+            std::coroutine_handle<> h = ready_.front();
+
+            ready_.pop_front();
+            h.resume();
+        }
+        if (!live_ || stop_)
+            break;
+
+        timeout = -1;
+        if (!timers_.empty()) {
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(timers_.begin()->first - clock::now());
+            timeout = (wait.count() > 0) ? static_cast<int>(wait.count()) : 0;
+        }
+        ret = poll(fds.data(), fds.size(), timeout);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+
+        /* Endpoint callbacks run here and post the coroutines they complete */
+        if (fds[0].revents & POLLIN)
+            (void)rpmsg_poller_run(&poller_);
+        for (i = 1; i < fds.size(); i++) {
+            if (fds[i].revents & POLLIN)
+                rpmsg_vdev_tx_dispatch(devs_[i - 1]);
+        }
+        fire_timers();
+
+        if (ret > 0) {
+            woken.swap(event_waiters_);
+            for (std::coroutine_handle<> h : woken)
+                post(h);
+            woken.clear();
+        }
+    }
+
+    return 0;
+}
+
+int endpoint::open(struct rpmsg_device *rdev, const char *name, uint32_t src, uint32_t dst)
+{
+    int ret;
+
+    if (opened_)
+        return RPMSG_ERR_PARAM;
+
+    /* Set before creation, a message may arrive right away */
+    ept_.priv = this;
+    ret = rpmsg_create_ept(&ept_, rdev, name, src, dst, rx_cb, unbind_cb);
+    if (ret)
+        return ret;
+    ept_.priv = this;
+
+    ret = rpmsg_vdev_set_tx_ready_cb(&ept_, tx_ready_cb, this);
+    if (ret) {
+        rpmsg_destroy_ept(&ept_);
+        return ret;
+    }
+    opened_ = true;
+
+    return 0;
+}
+
+void endpoint::close()
+{
+    message msg;
+
+    if (!opened_)
+        return;
+
+    (void)rpmsg_vdev_set_tx_ready_cb(&ept_, nullptr, nullptr);
+    rpmsg_destroy_ept(&ept_);
+    opened_ = false;
+    inbox_.clear();
+
+    msg.status = RPMSG_ERR_INIT;
+    while (!receivers_.empty()) {
+        recv_awaiter *r = receivers_.front();
+
+        receivers_.pop_front();
+        complete_recv(r, message(msg));
+    }
+    for (auto &call : calls_) {
+        call_state *st = call.second;
+
+        st->result.status = RPMSG_ERR_INIT;
+        st->done = true;
+        if (st->h) {
+            ex_.cancel_timer(st->timer);
+            ex_.post(st->h);
+        }
+    }
+    calls_.clear();
+    for (std::coroutine_handle<> h : senders_)
+        ex_.post(h);
+    senders_.clear();
+}
+
+task<void> endpoint::wait_ready()
+{
+    while (opened_ && !is_rpmsg_ept_ready(&ept_))
+        co_await ex_.next_event();
+}
+
+task<int> endpoint::send(const void *data, size_t len)
+{
+    struct awaiter {
+        endpoint &ep;
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { ep.senders_.push_back(h); }
+        void await_resume() noexcept {}
+    };
+    int ret;
+
+    for (;;) {
+        if (!opened_)
+            co_return RPMSG_ERR_INIT;
+        ret = rpmsg_vdev_trysend(&ept_, data, static_cast<int>(len));
+        if (ret != -EAGAIN)
+            co_return ret;
+        /* The endpoint is armed, tx_ready_cb() resumes us */
+        co_await awaiter{*this};
+    }
+}
+
+bool endpoint::recv_awaiter::await_ready()
+{
+    if (!ep.inbox_.empty()) {
+        msg = std::move(ep.inbox_.front());
+        ep.inbox_.pop_front();
+        return true;
+    }
+    if (!ep.opened_) {
+        msg.status = RPMSG_ERR_INIT;
+        return true;
+    }
+    if (timeout.count() <= 0) {
+        msg.status = -ETIMEDOUT;
+        return true;
+    }
+
+    return false;
+}
+
+void endpoint::recv_awaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    h = handle;
+    ep.receivers_.push_back(this);
+    if (timeout != std::chrono::milliseconds::max()) {
+        timed = true;
+        timer = ep.ex_.add_timer(clock::now() + timeout, [this] {
+            for (auto it = ep.receivers_.begin(); it != ep.receivers_.end(); ++it) {
+                if (*it == this) {
+                    ep.receivers_.erase(it);
+                    break;
+                }
+            }
+            timed = false;
+            msg.status = -ETIMEDOUT;
+            ep.ex_.post(h);
+        });
+    }
+}
+
+void endpoint::complete_recv(recv_awaiter *r, message &&msg)
+{
+    if (r->timed) {
+        ex_.cancel_timer(r->timer);
+        r->timed = false;
+    }
+    r->msg = std::move(msg);
+    ex_.post(r->h);
+}
+
+task<rpc_result> endpoint::call(uint16_t op, const void *data, size_t len, std::chrono::milliseconds timeout)
+{
+    struct awaiter {
+        endpoint &ep;
+        call_state &st;
+        uint32_t id;
+        clock::time_point deadline;
+
+        bool await_ready() noexcept { return st.done; }
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            st.h = h;
+            st.timer = ep.ex_.add_timer(deadline, [this] {
+                ep.calls_.erase(id);
+                st.result.status = -ETIMEDOUT;
+                st.done = true;
+                ep.ex_.post(st.h);
+            });
+        }
+        void await_resume() noexcept {}
+    };
+    struct rpmsg_rpc_hdr hdr;
+    std::vector<unsigned char> buf;
+    call_state st;
+    clock::time_point deadline = clock::now() + timeout;
+    int ret;
+
+    if (len > RPMSG_RPC_PAYLOAD_MAX) {
+        st.result.status = RPMSG_ERR_BUFF_SIZE;
+        co_return std::move(st.result);
+    }
+
+    if (!++seq_)
+        seq_ = 1U;
+    hdr.id = seq_;
+    hdr.op = op;
+    hdr.flags = 0U;
+    hdr.status = 0;
+    buf.resize(sizeof(hdr) + len);
+    std::memcpy(buf.data(), &hdr, sizeof(hdr));
+    if (len)
+        std::memcpy(buf.data() + sizeof(hdr), data, len);
+
+    calls_[hdr.id] = &st;
+    ret = co_await send(buf.data(), buf.size());
+    if (ret < 0) {
+        calls_.erase(hdr.id);
+        st.result.status = ret;
+        co_return std::move(st.result);
+    }
+    co_await awaiter{*this, st, hdr.id, deadline};
+
+    co_return std::move(st.result);
+}
+
+/* Hand a response to its call, false if the message is not one */
+bool endpoint::complete_call(const void *data, size_t len)
+{
+    struct rpmsg_rpc_hdr hdr;
+    call_state *st;
+
+    if (calls_.empty() || (len < sizeof(hdr)))
+        return false;
+    std::memcpy(&hdr, data, sizeof(hdr));
+    if (!(hdr.flags & RPMSG_RPC_FLAG_RESP))
+        return false;
+
+    auto it = calls_.find(hdr.id);
+    if (it == calls_.end())
+        return true; /* late response of a call that timed out */
+    st = it->second;
+    calls_.erase(it);
+
+    st->result.status = hdr.status;
+    st->result.data.assign(static_cast<const unsigned char *>(data) + sizeof(hdr),
+                           static_cast<const unsigned char *>(data) + len);
+    st->done = true;
+    if (st->h) {
+        ex_.cancel_timer(st->timer);
+        ex_.post(st->h);
+    }
+
+    return true;
+}
+
+int endpoint::rx_cb(struct rpmsg_endpoint *ept, void *data, size_t len, uint32_t src, void *priv)
+{
+    endpoint *ep = static_cast<endpoint *>(priv);
+    message msg;
+
+    (void)ept;
+    if (!ep || ep->complete_call(data, len))
+        return RPMSG_SUCCESS;
+
+    msg.src = src;
+    msg.data.assign(static_cast<unsigned char *>(data), static_cast<unsigned char *>(data) + len);
+    if (!ep->receivers_.empty()) {
+        recv_awaiter *r = ep->receivers_.front();
+
+        ep->receivers_.pop_front();
+        ep->complete_recv(r, std::move(msg));
+    } else {
+        ep->inbox_.push_back(std::move(msg));
+    }
+
+    return RPMSG_SUCCESS;
+}
+
+void endpoint::tx_ready_cb(struct rpmsg_endpoint *ept, void *priv)
+{
+    endpoint *ep = static_cast<endpoint *>(priv);
+
+    (void)ept;
+    for (std::coroutine_handle<> h : ep->senders_)
+        ep->ex_.post(h);
+    ep->senders_.clear();
+}
+
+void endpoint::unbind_cb(struct rpmsg_endpoint *ept)
+{
+    endpoint *ep = static_cast<endpoint *>(ept->priv);
+
+    if (ep)
+        ep->close();
+}
+
+} // namespace rpmsg
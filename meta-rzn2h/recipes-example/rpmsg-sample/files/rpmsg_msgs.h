@@ -0,0 +1,29 @@
+/**
+ * @file    rpmsg_msgs.h
+ * @brief   Messages of the sample, shared with the remote side.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#ifndef RPMSG_MSGS_H_
+#define RPMSG_MSGS_H_
+
+#include "rpmsg_schema.h"
+
+/*
+ * Echo test payload: this header, then size bytes of 0xA5. The remote side
+ * sends the message back unchanged.
+ */
+#define RPMSG_ECHO_HDR_FIELDS(F) \
+    F(U32, num)                  \
+    F(U32, size)
+RPMSG_SCHEMA(rpmsg_echo_hdr, RPMSG_ECHO_HDR_FIELDS)
+
+#endif /* RPMSG_MSGS_H_ */
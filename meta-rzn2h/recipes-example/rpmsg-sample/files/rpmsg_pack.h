@@ -0,0 +1,205 @@
+/**
+ * @file    rpmsg_pack.h
+ * @brief   Packing of small messages into shared RPMsg buffers.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * An endpoint carrying small messages (a few dozen bytes) packs them into
+ * one RPMsg buffer each, rather than spending a buffer, a descriptor and
+ * a doorbell per message. Every message is a struct rpmsg_pack_rec
+ * followed by its payload, padded to 4 bytes. A buffer is sent once the
+ * next message does not fit, once the oldest message in it waited for the
+ * flush interval, or on rpmsg_pack_flush(). The receiving endpoint hands
+ * the messages of a buffer to the callback one by one. The remote side
+ * packs and unpacks the same way.
+ *
+ * @code
+ *     rpmsg_create_ept(&ept, rdev, "rpmsg-pack", RPMSG_ADDR_ANY, RPMSG_ADDR_ANY,
+ *                      rpmsg_pack_ept_cb, NULL);
+ *     rpmsg_pack_init(&pack, &ept, 200, on_message, priv);
+ *
+ *     rpmsg_pack_send(&pack, &sample, sizeof(sample));
+ * @endcode
+ */
+
+#ifndef RPMSG_PACK_H_
+#define RPMSG_PACK_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <openamp/rpmsg.h>
+#include "rpmsg_vdev.h"
+
+// Payload of an RPMsg buffer (buffer minus its header)
+#define RPMSG_PACK_BUF_SIZE     (RPMSG_BUFFER_SIZE - sizeof(struct rpmsg_vdev_hdr))
+// Alignment of the records in a buffer
+#define RPMSG_PACK_ALIGN        (4U)
+
+/**
+ * @struct rpmsg_pack_rec
+ * @brief  header of every message in a buffer
+ */
+struct rpmsg_pack_rec {
+    uint16_t len;       /**< payload length */
+    uint16_t reserved;
+} __attribute__((packed));
+
+// Largest packed message
+#define RPMSG_PACK_MSG_MAX      (RPMSG_PACK_BUF_SIZE - sizeof(struct rpmsg_pack_rec))
+
+/**
+ * rpmsg_pack_rec_size - room taken in a buffer by a message of @len bytes
+ */
+static inline uint32_t rpmsg_pack_rec_size(uint32_t len)
+{
+    return (uint32_t)sizeof(struct rpmsg_pack_rec) + ((len + RPMSG_PACK_ALIGN - 1U) & ~(RPMSG_PACK_ALIGN - 1U));
+}
+
+/**
+ * rpmsg_pack_put - append a message to a buffer
+ *
+ * @buf: buffer
+ * @cap: buffer size
+ * @used: bytes in use, updated
+ * @data: payload
+ * @len: payload length
+ *
+ * return 0 on success, -1 if the message does not fit
+ */
+static inline int rpmsg_pack_put(void *buf, uint32_t cap, uint32_t *used, const void *data, uint32_t len)
+{
+    struct rpmsg_pack_rec *rec = (struct rpmsg_pack_rec *)((unsigned char *)buf + *used);
+    uint32_t size = rpmsg_pack_rec_size(len);
+
+    if (size > cap - *used)
+        return -1;
+    rec->len = (uint16_t)len;
+    rec->reserved = 0U;
+    memcpy(rec + 1, data, len);
+    *used += size;
+
+    return 0;
+}
+
+/**
+ * rpmsg_pack_next - get the next message of a received buffer
+ *
+ * @buf: buffer
+ * @len: buffer length
+ * @off: offset of the next record, from 0, updated
+ * @msg_len: returns the payload length
+ *
+ * return payload pointer, NULL at the end of the buffer or on a malformed
+ *        record, which leaves @off short of @len
+ */
+static inline const void *rpmsg_pack_next(const void *buf, size_t len, size_t *off, uint32_t *msg_len)
+{
+    const struct rpmsg_pack_rec *rec = (const struct rpmsg_pack_rec *)((const unsigned char *)buf + *off);
+    size_t size;
+
+    if (len - *off < sizeof(*rec))
+        return NULL;
+    size = rpmsg_pack_rec_size(rec->len);
+    if (size > len - *off)
+        return NULL;
+    *off += size;
+    *msg_len = rec->len;
+
+    return rec + 1;
+}
+
+/**
+ * rpmsg_pack_cb - message unpacked from a received buffer
+ *
+ * @priv: argument given to rpmsg_pack_init()
+ * @data: payload, only valid during the call
+ * @len: payload length
+ */
+typedef void (*rpmsg_pack_cb)(void *priv, const void *data, size_t len);
+
+/**
+ * @struct rpmsg_pack
+ * @brief  packing endpoint
+ */
+struct rpmsg_pack {
+    struct rpmsg_endpoint *ept;
+    rpmsg_pack_cb cb;
+    void *priv;
+    uint32_t flush_us;          /**< longest wait of a message in the buffer, 0 for none */
+    pthread_mutex_t lock;       /**< protects the members below */
+    pthread_cond_t cond;        /**< signalled when a buffer gets its first message */
+    pthread_t timer;
+    int stop;
+    void *buf;                  /**< buffer being filled, NULL if none */
+    uint32_t cap;               /**< size of buf */
+    uint32_t used;              /**< bytes in use in buf */
+    uint64_t first_us;          /**< time of the first message in buf */
+    unsigned char local[RPMSG_PACK_BUF_SIZE]; /**< buffer of a virtio slave */
+    unsigned long msgs;         /**< messages sent */
+    unsigned long bufs;         /**< buffers sent */
+    unsigned long rx_malformed; /**< received buffers with a malformed record */
+};
+
+/**
+ * rpmsg_pack_init - set up packing on an endpoint
+ *
+ * The endpoint must be created with rpmsg_pack_ept_cb() as callback; its
+ * private data is set to @p. As a virtio master the messages are written
+ * straight into a TX buffer, as a slave into a local one.
+ *
+ * @p: packing endpoint
+ * @ept: endpoint
+ * @flush_us: longest time a message waits for more to share its buffer,
+ *            0 to send on size and rpmsg_pack_flush() only
+ * @cb: callback of the received messages
+ * @priv: argument of @cb
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_pack_init(struct rpmsg_pack *p, struct rpmsg_endpoint *ept, uint32_t flush_us,
+                    rpmsg_pack_cb cb, void *priv);
+
+/**
+ * rpmsg_pack_deinit - flush and stop the flush timer
+ *
+ * @p: packing endpoint
+ */
+void rpmsg_pack_deinit(struct rpmsg_pack *p);
+
+/**
+ * rpmsg_pack_ept_cb - endpoint callback of a packing endpoint
+ */
+int rpmsg_pack_ept_cb(struct rpmsg_endpoint *ept, void *data, size_t len, uint32_t src, void *priv);
+
+/**
+ * rpmsg_pack_send - queue a message in the buffer being filled
+ *
+ * Sends the buffer first if the message does not fit anymore. Blocks like
+ * rpmsg_send() while no TX buffer is free.
+ *
+ * @p: packing endpoint
+ * @data: payload
+ * @len: payload length, up to RPMSG_PACK_MSG_MAX
+ *
+ * return @len on success, negative value on failure
+ */
+int rpmsg_pack_send(struct rpmsg_pack *p, const void *data, size_t len);
+
+/**
+ * rpmsg_pack_flush - send the buffer being filled, if any
+ *
+ * @p: packing endpoint
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_pack_flush(struct rpmsg_pack *p);
+
+#endif /* RPMSG_PACK_H_ */
@@ -0,0 +1,130 @@
+/**
+ * @file    rpmsg_poller.h
+ * @brief   Budgeted round-robin RX dispatch over several rpmsg devices.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#ifndef RPMSG_POLLER_H_
+#define RPMSG_POLLER_H_
+
+#include <openamp/rpmsg.h>
+
+// Maximum number of devices serviced by one poller
+#define RPMSG_POLLER_DEV_MAX    (4U)
+// Default number of messages a device may handle per turn
+#ifndef RPMSG_POLLER_BUDGET
+#define RPMSG_POLLER_BUDGET     (16U)
+#endif
+
+struct rpmsg_vdev;
+
+/**
+ * @struct rpmsg_poller
+ * @brief  RX scheduler of one event loop thread
+ */
+struct rpmsg_poller {
+    struct rpmsg_vdev *dev[RPMSG_POLLER_DEV_MAX]; /**< attached devices */
+    unsigned int budget[RPMSG_POLLER_DEV_MAX];   /**< messages per turn */
+    unsigned int num;                            /**< attached devices */
+    unsigned int ready[RPMSG_POLLER_DEV_MAX];    /**< round-robin queue of device indexes */
+    unsigned int head;                           /**< first entry of ready */
+    unsigned int count;                          /**< entries in ready */
+    unsigned int queued;                         /**< bit n: device n is in ready */
+    unsigned int pending;                        /**< bit n: device n was notified */
+    int fd;                                      /**< eventfd, readable when there is work */
+};
+
+/**
+ * rpmsg_poller_init - initialize a poller
+ *
+ * @poller: poller
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_poller_init(struct rpmsg_poller *poller);
+
+/**
+ * rpmsg_poller_deinit - release a poller, detaching all devices
+ *
+ * @poller: poller
+ */
+void rpmsg_poller_deinit(struct rpmsg_poller *poller);
+
+/**
+ * rpmsg_poller_add - service a device from the poller
+ *
+ * From now on, notifications of the device only schedule it on the poller
+ * and its messages are delivered by rpmsg_poller_run(). platform_poll()
+ * is not needed for the device any more. Devices are added and removed by
+ * the thread running the poller.
+ *
+ * @poller: poller
+ * @rdev: device returned by platform_create_rpmsg_vdev()
+ * @budget: messages the device may handle per turn, 0 for the default
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_poller_add(struct rpmsg_poller *poller, struct rpmsg_device *rdev, unsigned int budget);
+
+/**
+ * rpmsg_poller_remove - stop servicing a device
+ *
+ * @poller: poller
+ * @rdev: device
+ */
+void rpmsg_poller_remove(struct rpmsg_poller *poller, struct rpmsg_device *rdev);
+
+/**
+ * rpmsg_poller_fd - event to wait for in the event loop
+ *
+ * @poller: poller
+ *
+ * return eventfd, readable when rpmsg_poller_run() has work to do
+ */
+static inline int rpmsg_poller_fd(struct rpmsg_poller *poller)
+{
+    return poller->fd;
+}
+
+/**
+ * rpmsg_poller_run - give one turn to every ready device
+ *
+ * Ready devices are served round-robin, each with at most its budget.
+ * A device that used up its budget goes to the back of the queue and the
+ * eventfd is re-armed, so its remaining messages are handled on the next
+ * call without waiting for another interrupt.
+ *
+ * @poller: poller
+ *
+ * return number of messages delivered
+ */
+unsigned int rpmsg_poller_run(struct rpmsg_poller *poller);
+
+/**
+ * rpmsg_poller_wait - wait for work
+ *
+ * @poller: poller
+ * @timeout_ms: timeout, negative to wait forever
+ *
+ * return 1 if there is work, 0 on timeout, negative value on failure
+ */
+int rpmsg_poller_wait(struct rpmsg_poller *poller, int timeout_ms);
+
+/**
+ * rpmsg_poller_schedule - schedule a device that has work
+ *
+ * Called on notification of the device, from any thread.
+ *
+ * @rpvdev: device attached to a poller
+ */
+void rpmsg_poller_schedule(struct rpmsg_vdev *rpvdev);
+
+#endif /* RPMSG_POLLER_H_ */
@@ -0,0 +1,514 @@
+/**
+ * @file    rpmsg_raii.hpp
+ * @brief   Header-only RAII types for the platform, rpmsg devices, endpoints
+ *          and zero-copy vring buffers.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * Buffers are move-only handles on vring buffers in shared memory: a TX
+ * buffer is given back unless it was sent, an RX buffer goes back to the
+ * remote when its handle is destroyed. Messages are trivially copyable
+ * structs built in place, so neither a staging copy nor a heap buffer is
+ * needed. Messages defined with RPMSG_SCHEMA() are encoded into and
+ * decoded from the buffers in place as well.
+ *
+ * @code
+ *     rpmsg::platform plat(proc_id, rsc_id);
+ *     rpmsg::device dev(plat);
+ *     rpmsg::endpoint_handle ept(dev, CFG_RPMSG_SVC_NAME0, APP_EPT_ADDR);
+ *
+ *     while (!ept.ready())
+ *         plat.poll();
+ *     ept.send_in_place<request>(OP_START, 42U);
+ *     if (auto rx = ept.recv(100))
+ *         handle(*rx.as<response>());
+ * @endcode
+ */
+
+#ifndef RPMSG_RAII_HPP_
+#define RPMSG_RAII_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* The sample headers have no C++ guards of their own */
+extern "C" {
+#include "platform_info.h"
+#include "rpmsg_vdev.h"
+}
+#include "rpmsg_schema.h"
+
+namespace rpmsg {
+
+namespace detail {
+
+template <typename F>
+struct first_arg;
+
+template <typename R, typename A>
+struct first_arg<R (*)(A)> {
+    using type = A;
+};
+
+} // namespace detail
+
+/* struct remoteproc * on RZ/G2L and RZ/G3S, void * on RZ/N2H and RZ/T2H */
+using platform_ptr = detail::first_arg<decltype(&platform_cleanup)>::type;
+
+/* Payload capacity of a vring buffer; the buffer size is fixed by open-amp */
+inline constexpr std::size_t max_payload = RPMSG_BUFFER_SIZE - sizeof(struct rpmsg_vdev_hdr);
+/* Payloads follow the 16 byte header of buffers aligned to their size */
+inline constexpr std::size_t payload_align = sizeof(struct rpmsg_vdev_hdr);
+
+/* Requirements of a message type built in or read from shared memory */
+template <typename T>
+constexpr void check_message()
+{
+    static_assert(std::is_trivially_copyable_v<T>, "messages must be trivially copyable");
+    static_assert(sizeof(T) <= max_payload, "message larger than the vring buffer payload");
+    static_assert(alignof(T) <= payload_align, "message alignment exceeds the payload alignment");
+}
+
+/**
+ * @class platform
+ * @brief platform_init() / platform_cleanup()
+ */
+class platform {
+public:
+    /* Arguments of platform_init() of the layer, without the result pointer */
+    template <typename... Args>
+    explicit platform(Args... args) : ret_(platform_init(args..., &handle_))
+    {
+    }
+    ~platform() { reset(); }
+
+    platform(platform &&other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)), ret_(other.ret_)
+    {
+    }
+    platform &operator=(platform &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            handle_ = std::exchange(other.handle_, nullptr);
+            ret_ = other.ret_;
+        }
+        return *this;
+    }
+    platform(const platform &) = delete;
+    platform &operator=(const platform &) = delete;
+
+    explicit operator bool() const { return !ret_ && handle_; }
+    int error() const { return ret_; }
+    platform_ptr get() const { return handle_; }
+    int poll() { return platform_poll(handle_); }
+
+private:
+    void reset()
+    {
+        if (handle_ && !ret_)
+            platform_cleanup(handle_);
+        handle_ = nullptr;
+    }
+
+    platform_ptr handle_ = nullptr; /* declared first, platform_init() sets it */
+    int ret_;
+};
+
+/**
+ * @class device
+ * @brief platform_create_rpmsg_vdev() / platform_release_rpmsg_vdev()
+ */
+class device {
+public:
+    explicit device(platform &plat, unsigned int index = 0, unsigned int role = VIRTIO_DEV_MASTER,
+                    rpmsg_ns_bind_cb ns_bind = nullptr)
+        : plat_(plat.get()),
+          rdev_(platform_create_rpmsg_vdev(plat_, index, role, nullptr, ns_bind))
+    {
+    }
+    ~device() { reset(); }
+
+    device(device &&other) noexcept
+        : plat_(other.plat_), rdev_(std::exchange(other.rdev_, nullptr))
+    {
+    }
+    device &operator=(device &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            plat_ = other.plat_;
+            rdev_ = std::exchange(other.rdev_, nullptr);
+        }
+        return *this;
+    }
+    device(const device &) = delete;
+    device &operator=(const device &) = delete;
+
+    explicit operator bool() const { return rdev_ != nullptr; }
+    struct rpmsg_device *get() const { return rdev_; }
+
+private:
+    void reset()
+    {
+        if (rdev_)
+            platform_release_rpmsg_vdev(plat_, rdev_);
+        rdev_ = nullptr;
+    }
+
+    platform_ptr plat_;
+    struct rpmsg_device *rdev_;
+};
+
+/**
+ * @class tx_buffer
+ * @brief TX vring buffer, given back on destruction unless sent
+ */
+class tx_buffer {
+public:
+    tx_buffer() = default;
+    tx_buffer(struct rpmsg_endpoint *ept, void *data, uint32_t capacity)
+        : ept_(ept), data_(data), capacity_(capacity)
+    {
+    }
+    ~tx_buffer() { reset(); }
+
+    tx_buffer(tx_buffer &&other) noexcept
+        : ept_(other.ept_), data_(std::exchange(other.data_, nullptr)), capacity_(other.capacity_)
+    {
+    }
+    tx_buffer &operator=(tx_buffer &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            ept_ = other.ept_;
+            data_ = std::exchange(other.data_, nullptr);
+            capacity_ = other.capacity_;
+        }
+        return *this;
+    }
+    tx_buffer(const tx_buffer &) = delete;
+    tx_buffer &operator=(const tx_buffer &) = delete;
+
+    explicit operator bool() const { return data_ != nullptr; }
+    void *data() const { return data_; }
+    std::size_t capacity() const { return capacity_; }
+
+    /* Construct the message in the shared memory buffer */
+    template <typename T, typename... Args>
+    T *emplace(Args &&...args)
+    {
+        check_message<T>();
+        return ::new (data_) T{std::forward<Args>(args)...};
+    }
+
+    /**
+     * Send the first len bytes. The buffer belongs to the remote afterwards,
+     * unless RPMSG_ERR_PARAM or RPMSG_ERR_BUFF_SIZE is returned.
+     */
+    int send(std::size_t len)
+    {
+        int ret = rpmsg_vdev_send_nocopy(ept_, data_, static_cast<int>(len));
+
+        if ((ret != RPMSG_ERR_PARAM) && (ret != RPMSG_ERR_BUFF_SIZE))
+            data_ = nullptr;
+        return ret;
+    }
+
+    /* Send the message built with emplace<T>() */
+    template <typename T>
+    int send()
+    {
+        check_message<T>();
+        return send(sizeof(T));
+    }
+
+    /* Encode a schema message at the start of the buffer, return its size */
+    template <typename M>
+    std::size_t encode(const M &m)
+    {
+        static_assert(rpmsg_schema<M>::wire_size <= max_payload, "message larger than the vring buffer payload");
+        return rpmsg_schema<M>::encode(m, data_);
+    }
+
+private:
+    void reset()
+    {
+        if (data_)
+            rpmsg_vdev_release_tx_buffer(ept_, data_);
+        data_ = nullptr;
+    }
+
+    struct rpmsg_endpoint *ept_ = nullptr;
+    void *data_ = nullptr;
+    uint32_t capacity_ = 0;
+};
+
+/**
+ * @class rx_view
+ * @brief received message inside a vring buffer, valid while its owner lives
+ */
+class rx_view {
+public:
+    explicit rx_view(const struct rpmsg_vdev_msg &msg) : msg_(msg) {}
+
+    const void *data() const { return msg_.data; }
+    std::size_t size() const { return msg_.len; }
+    uint32_t src() const { return msg_.src; }
+
+    /* The message as a T, nullptr if it is too short */
+    template <typename T>
+    const T *as() const
+    {
+        check_message<T>();
+        return (msg_.len >= sizeof(T)) ? static_cast<const T *>(msg_.data) : nullptr;
+    }
+
+    /* Decode a schema message, false if the message is too short */
+    template <typename M>
+    bool decode(M &m) const
+    {
+        return rpmsg_schema<M>::decode(m, msg_.data, msg_.len) != 0U;
+    }
+
+private:
+    struct rpmsg_vdev_msg msg_;
+};
+
+/**
+ * @class rx_buffer
+ * @brief received message, its vring buffer goes back on destruction
+ */
+class rx_buffer {
+public:
+    rx_buffer() = default;
+    rx_buffer(struct rpmsg_endpoint *ept, const struct rpmsg_vdev_msg &msg) : ept_(ept), msg_(msg) {}
+    ~rx_buffer() { reset(); }
+
+    rx_buffer(rx_buffer &&other) noexcept : ept_(std::exchange(other.ept_, nullptr)), msg_(other.msg_) {}
+    rx_buffer &operator=(rx_buffer &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            ept_ = std::exchange(other.ept_, nullptr);
+            msg_ = other.msg_;
+        }
+        return *this;
+    }
+    rx_buffer(const rx_buffer &) = delete;
+    rx_buffer &operator=(const rx_buffer &) = delete;
+
+    explicit operator bool() const { return ept_ != nullptr; }
+    const void *data() const { return msg_.data; }
+    std::size_t size() const { return msg_.len; }
+    uint32_t src() const { return msg_.src; }
+
+    template <typename T>
+    const T *as() const
+    {
+        return rx_view(msg_).as<T>();
+    }
+
+    template <typename M>
+    bool decode(M &m) const
+    {
+        return rx_view(msg_).decode(m);
+    }
+
+private:
+    void reset()
+    {
+        if (ept_)
+            rpmsg_vdev_recv_release(ept_, &msg_, 1U);
+        ept_ = nullptr;
+    }
+
+    struct rpmsg_endpoint *ept_ = nullptr;
+    struct rpmsg_vdev_msg msg_ {};
+};
+
+/**
+ * @class rx_batch
+ * @brief received messages, given back together with one kick
+ */
+class rx_batch {
+public:
+    rx_batch() = default;
+    rx_batch(struct rpmsg_endpoint *ept, std::vector<struct rpmsg_vdev_msg> &&msgs)
+        : ept_(ept), msgs_(std::move(msgs))
+    {
+    }
+    ~rx_batch() { reset(); }
+
+    rx_batch(rx_batch &&other) noexcept
+        : ept_(std::exchange(other.ept_, nullptr)), msgs_(std::move(other.msgs_))
+    {
+    }
+    rx_batch &operator=(rx_batch &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            ept_ = std::exchange(other.ept_, nullptr);
+            msgs_ = std::move(other.msgs_);
+        }
+        return *this;
+    }
+    rx_batch(const rx_batch &) = delete;
+    rx_batch &operator=(const rx_batch &) = delete;
+
+    std::size_t size() const { return msgs_.size(); }
+    bool empty() const { return msgs_.empty(); }
+    rx_view operator[](std::size_t i) const { return rx_view(msgs_[i]); }
+
+private:
+    void reset()
+    {
+        if (ept_ && !msgs_.empty())
+            rpmsg_vdev_recv_release(ept_, msgs_.data(), static_cast<unsigned int>(msgs_.size()));
+        ept_ = nullptr;
+        msgs_.clear();
+    }
+
+    struct rpmsg_endpoint *ept_ = nullptr;
+    std::vector<struct rpmsg_vdev_msg> msgs_;
+};
+
+/**
+ * @class endpoint_handle
+ * @brief rpmsg endpoint, destroyed with its handle
+ *
+ * Without a callback, received messages are pulled with recv() and
+ * recv_batch() (rpmsg_vdev_pull_enable()).
+ */
+class endpoint_handle {
+public:
+    endpoint_handle() = default;
+    endpoint_handle(device &dev, const char *name, uint32_t src = RPMSG_ADDR_ANY,
+                    uint32_t dst = RPMSG_ADDR_ANY, rpmsg_ept_cb cb = nullptr,
+                    rpmsg_ns_unbind_cb unbind = nullptr)
+        : ept_(new (std::nothrow) struct rpmsg_endpoint())
+    {
+        if (!ept_) {
+            ret_ = RPMSG_ERR_NO_MEM;
+            return;
+        }
+        ret_ = rpmsg_create_ept(ept_.get(), dev.get(), name, src, dst, cb, unbind);
+        if (!ret_ && !cb) {
+            ret_ = rpmsg_vdev_pull_enable(ept_.get());
+            if (ret_)
+                rpmsg_destroy_ept(ept_.get());
+        }
+        if (ret_)
+            ept_.reset();
+        pull_ = !cb;
+    }
+    ~endpoint_handle() { reset(); }
+
+    endpoint_handle(endpoint_handle &&other) noexcept
+        : ept_(std::move(other.ept_)), ret_(other.ret_), pull_(other.pull_)
+    {
+    }
+    endpoint_handle &operator=(endpoint_handle &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            ept_ = std::move(other.ept_);
+            ret_ = other.ret_;
+            pull_ = other.pull_;
+        }
+        return *this;
+    }
+    endpoint_handle(const endpoint_handle &) = delete;
+    endpoint_handle &operator=(const endpoint_handle &) = delete;
+
+    explicit operator bool() const { return ept_ != nullptr; }
+    int error() const { return ret_; }
+    struct rpmsg_endpoint *get() const { return ept_.get(); }
+    bool ready() const { return ept_ && is_rpmsg_ept_ready(ept_.get()); }
+
+    /* TX buffer to build a message in, empty if none (wait = false) */
+    tx_buffer get_tx_buffer(bool wait = true)
+    {
+        uint32_t capacity = 0;
+        void *data = rpmsg_vdev_get_tx_buffer(ept_.get(), &capacity, wait);
+
+        return data ? tx_buffer(ept_.get(), data, capacity) : tx_buffer();
+    }
+
+    /* Build a T in a TX buffer and send it */
+    template <typename T, typename... Args>
+    int send_in_place(Args &&...args)
+    {
+        tx_buffer buf = get_tx_buffer();
+
+        if (!buf)
+            return RPMSG_ERR_NO_BUFF;
+        buf.emplace<T>(std::forward<Args>(args)...);
+        return buf.send<T>();
+    }
+
+    /* Encode a schema message in a TX buffer and send it */
+    template <typename M>
+    int send_message(const M &m)
+    {
+        tx_buffer buf = get_tx_buffer();
+
+        if (!buf)
+            return RPMSG_ERR_NO_BUFF;
+        return buf.send(buf.encode(m));
+    }
+
+    /* One message, empty on timeout (0: do not wait, negative: forever) */
+    rx_buffer recv(int timeout_ms, int *err = nullptr)
+    {
+        struct rpmsg_vdev_msg msg;
+        int ret = rpmsg_vdev_recv_batch(ept_.get(), &msg, 1U, timeout_ms);
+
+        if (err)
+            *err = (ret < 0) ? ret : 0;
+        return (ret > 0) ? rx_buffer(ept_.get(), msg) : rx_buffer();
+    }
+
+    /* Up to max messages already received, waiting only if there is none */
+    rx_batch recv_batch(unsigned int max, int timeout_ms, int *err = nullptr)
+    {
+        std::vector<struct rpmsg_vdev_msg> msgs(max);
+        int ret = rpmsg_vdev_recv_batch(ept_.get(), msgs.data(), max, timeout_ms);
+
+        if (err)
+            *err = (ret < 0) ? ret : 0;
+        msgs.resize((ret > 0) ? static_cast<std::size_t>(ret) : 0U);
+        return rx_batch(ept_.get(), std::move(msgs));
+    }
+
+private:
+    void reset()
+    {
+        if (!ept_)
+            return;
+        if (pull_)
+            rpmsg_vdev_pull_disable(ept_.get());
+        rpmsg_destroy_ept(ept_.get());
+        ept_.reset();
+    }
+
+    std::unique_ptr<struct rpmsg_endpoint> ept_;
+    int ret_ = 0;
+    bool pull_ = false;
+};
+
+} // namespace rpmsg
+
+#endif /* RPMSG_RAII_HPP_ */
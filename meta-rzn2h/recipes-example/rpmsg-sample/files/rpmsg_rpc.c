@@ -0,0 +1,345 @@
+/**
+ * @file    rpmsg_rpc.c
+ * @brief   Request/response calls with correlation IDs over one endpoint.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "platform_info.h"
+#include "rpmsg_rpc.h"
+#include "rpmsg_vdev.h"
+
+// Interval at which a waiting future checks the deadlines
+#define RPC_RECHECK_MS      (10U)
+// The low bits of an id index the pending table, the others count up
+#define RPC_SLOT_BITS       (8U)
+#define RPC_SLOT_MASK       ((1U << RPC_SLOT_BITS) - 1U)
+
+/* Completed request, called back once the lock is released */
+struct rpc_done {
+    rpmsg_rpc_done_cb cb;
+    void *priv;
+};
+
+static void timespec_add_ms(struct timespec *ts, unsigned int ms)
+{
+    ts->tv_sec += ms / 1000U;
+    ts->tv_nsec += (long)(ms % 1000U) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+static int timespec_before(const struct timespec *a, const struct timespec *b)
+{
+    return (a->tv_sec < b->tv_sec) || ((a->tv_sec == b->tv_sec) && (a->tv_nsec < b->tv_nsec));
+}
+
+/* Entry of an id in flight, NULL if it completed or expired. Called with lock held. */
+static struct rpmsg_rpc_pending *pending_find(struct rpmsg_rpc *rpc, uint32_t id)
+{
+    uint32_t slot = id & RPC_SLOT_MASK;
+
+    if (!id || (slot >= RPMSG_RPC_PENDING_MAX) || (rpc->pending[slot].id != id))
+        return NULL;
+
+    return &rpc->pending[slot];
+}
+
+/* Take the entry of a completed request. Called with lock held. */
+static void pending_take(struct rpmsg_rpc *rpc, struct rpmsg_rpc_pending *p, struct rpc_done *done)
+{
+    done->cb = p->cb;
+    done->priv = p->priv;
+    memset(p, 0, sizeof(*p));
+    rpc->num--;
+}
+
+static int rpc_send(struct rpmsg_rpc *rpc, const struct rpmsg_rpc_hdr *hdr, const void *data, size_t len)
+{
+    unsigned char buf[RPMSG_RPC_MSG_MAX];
+    int ret;
+
+    if (len > RPMSG_RPC_PAYLOAD_MAX)
+        return RPMSG_ERR_BUFF_SIZE;
+
+    memcpy(buf, hdr, sizeof(*hdr));
+    if (len)
+        memcpy(buf + sizeof(*hdr), data, len);
+    ret = rpmsg_send(rpc->ept, buf, (int)(sizeof(*hdr) + len));
+
+    return (ret < 0) ? ret : 0;
+}
+
+int rpmsg_rpc_init(struct rpmsg_rpc *rpc, struct rpmsg_endpoint *ept,
+                   rpmsg_rpc_req_cb req_cb, void *req_priv)
+{
+    pthread_condattr_t attr;
+
+    if (!rpc || !ept)
+        return RPMSG_ERR_PARAM;
+
+    memset(rpc->pending, 0, sizeof(rpc->pending));
+    rpc->num = 0U;
+    rpc->seq = 0U;
+    rpc->req_cb = req_cb;
+    rpc->req_priv = req_priv;
+    pthread_mutex_init(&rpc->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&rpc->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    rpc->ept = ept;
+    ept->priv = rpc;
+
+    return 0;
+}
+
+void rpmsg_rpc_deinit(struct rpmsg_rpc *rpc)
+{
+    struct rpc_done done[RPMSG_RPC_PENDING_MAX];
+    unsigned int i, n = 0;
+
+    pthread_mutex_lock(&rpc->lock);
+    for (i = 0; i < RPMSG_RPC_PENDING_MAX; i++) {
+        if (rpc->pending[i].id)
+            pending_take(rpc, &rpc->pending[i], &done[n++]);
+    }
+    pthread_mutex_unlock(&rpc->lock);
+
+    for (i = 0; i < n; i++)
+        done[i].cb(done[i].priv, -ECANCELED, NULL, 0);
+
+    rpc->ept->priv = NULL;
+    pthread_cond_destroy(&rpc->cond);
+    pthread_mutex_destroy(&rpc->lock);
+}
+
+unsigned int rpmsg_rpc_expire(struct rpmsg_rpc *rpc)
+{
+    struct rpc_done done[RPMSG_RPC_PENDING_MAX];
+    struct timespec now;
+    unsigned int i, n = 0;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&rpc->lock);
+    for (i = 0; (i < RPMSG_RPC_PENDING_MAX) && rpc->num; i++) {
+        if (rpc->pending[i].id && !timespec_before(&now, &rpc->pending[i].deadline))
+            pending_take(rpc, &rpc->pending[i], &done[n++]);
+    }
+    pthread_mutex_unlock(&rpc->lock);
+
+    for (i = 0; i < n; i++)
+        done[i].cb(done[i].priv, -ETIMEDOUT, NULL, 0);
+
+    return n;
+}
+
+int rpmsg_rpc_ept_cb(struct rpmsg_endpoint *ept, void *data, size_t len, uint32_t src, void *priv)
+{
+    struct rpmsg_rpc *rpc = priv;
+    struct rpmsg_rpc_hdr hdr;
+    struct rpmsg_rpc_pending *p;
+    struct rpc_done done = { NULL, NULL };
+
+    (void)ept;
+    (void)src;
+
+    if (!rpc)
+        return RPMSG_SUCCESS;
+    if (len < sizeof(hdr)) {
+        LPERROR("Short RPC message of %u bytes.\n", (unsigned int)len);
+        return RPMSG_SUCCESS;
+    }
+    memcpy(&hdr, data, sizeof(hdr));
+    data = (unsigned char *)data + sizeof(hdr);
+    len -= sizeof(hdr);
+
+    if (hdr.flags & RPMSG_RPC_FLAG_RESP) {
+        pthread_mutex_lock(&rpc->lock);
+        p = pending_find(rpc, hdr.id);
+        if (p)
+            pending_take(rpc, p, &done);
+        pthread_mutex_unlock(&rpc->lock);
+
+        /* A response after the deadline finds no entry and is dropped */
+        if (done.cb)
+            done.cb(done.priv, hdr.status, data, len);
+    } else if (rpc->req_cb) {
+        rpc->req_cb(rpc->req_priv, &hdr, data, len);
+    } else {
+        (void)rpmsg_rpc_reply(rpc, &hdr, -ENOSYS, NULL, 0);
+    }
+
+    (void)rpmsg_rpc_expire(rpc);
+
+    return RPMSG_SUCCESS;
+}
+
+int rpmsg_rpc_call_async(struct rpmsg_rpc *rpc, uint16_t op, const void *data, size_t len,
+                         unsigned int timeout_ms, rpmsg_rpc_done_cb cb, void *priv)
+{
+    struct rpmsg_rpc_pending *p = NULL;
+    struct rpmsg_rpc_hdr hdr;
+    unsigned int i;
+    int ret;
+
+    if (!rpc || !cb || (len > RPMSG_RPC_PAYLOAD_MAX))
+        return RPMSG_ERR_PARAM;
+
+    (void)rpmsg_rpc_expire(rpc);
+
+    pthread_mutex_lock(&rpc->lock);
+    for (i = 0; i < RPMSG_RPC_PENDING_MAX; i++) {
+        if (!rpc->pending[i].id) {
+            p = &rpc->pending[i];
+            break;
+        }
+    }
+    if (p) {
+        /* The entry is taken before sending, the response may come back at once */
+        rpc->seq = (rpc->seq + 1U) & ((uint32_t)INT32_MAX >> RPC_SLOT_BITS);
+        if (!rpc->seq)
+            rpc->seq = 1U;
+        p->id = (rpc->seq << RPC_SLOT_BITS) | i;
+        p->op = op;
+        p->cb = cb;
+        p->priv = priv;
+        (void)clock_gettime(CLOCK_MONOTONIC, &p->deadline);
+        timespec_add_ms(&p->deadline, timeout_ms);
+        rpc->num++;
+        hdr.id = p->id;
+    }
+    pthread_mutex_unlock(&rpc->lock);
+
+    if (!p)
+        return -EAGAIN;
+
+    hdr.op = op;
+    hdr.flags = 0U;
+    hdr.status = 0;
+    ret = rpc_send(rpc, &hdr, data, len);
+    if (ret < 0) {
+        pthread_mutex_lock(&rpc->lock);
+        p = pending_find(rpc, hdr.id);
+        if (p) {
+            memset(p, 0, sizeof(*p));
+            rpc->num--;
+        }
+        pthread_mutex_unlock(&rpc->lock);
+        return ret;
+    }
+
+    return (int)hdr.id;
+}
+
+static void future_done(void *priv, int status, const void *data, size_t len)
+{
+    struct rpmsg_rpc_future *f = priv;
+
+    if (f->resp && data)
+        memcpy(f->resp, data, (len < f->size) ? len : f->size);
+    f->len = len;
+    f->status = status;
+
+    pthread_mutex_lock(&f->rpc->lock);
+    f->done = 1;
+    pthread_cond_broadcast(&f->rpc->cond);
+    pthread_mutex_unlock(&f->rpc->lock);
+}
+
+int rpmsg_rpc_submit(struct rpmsg_rpc *rpc, uint16_t op, const void *data, size_t len,
+                     unsigned int timeout_ms, struct rpmsg_rpc_future *f)
+{
+    if (!f)
+        return RPMSG_ERR_PARAM;
+
+    f->rpc = rpc;
+    f->len = 0U;
+    f->status = 0;
+    f->done = 0;
+
+    return rpmsg_rpc_call_async(rpc, op, data, len, timeout_ms, future_done, f);
+}
+
+int rpmsg_rpc_wait(struct rpmsg_rpc_future *f)
+{
+    struct rpmsg_rpc *rpc = f->rpc;
+    struct rpmsg_vdev *rpvdev = rpmsg_vdev_from_rdev(rpc->ept->rdev);
+    struct timespec until;
+    int ret;
+
+    pthread_mutex_lock(&rpc->lock);
+    while (!f->done) {
+        (void)clock_gettime(CLOCK_MONOTONIC, &until);
+        timespec_add_ms(&until, RPC_RECHECK_MS);
+        /*
+         * The caller may be the thread that normally polls the device, so
+         * take the response from the RX virtqueue unless another thread does
+         */
+        pthread_mutex_unlock(&rpc->lock);
+        ret = rpmsg_vdev_rx_poll_wait(rpvdev, &until);
+        pthread_mutex_lock(&rpc->lock);
+        if (ret < 0) {
+            /* That thread completes the future */
+            while (!f->done) {
+                if (pthread_cond_timedwait(&rpc->cond, &rpc->lock, &until) == ETIMEDOUT)
+                    break;
+            }
+        }
+        if (!f->done) {
+            /* Completes this future with -ETIMEDOUT once it is due */
+            pthread_mutex_unlock(&rpc->lock);
+            (void)rpmsg_rpc_expire(rpc);
+            pthread_mutex_lock(&rpc->lock);
+        }
+    }
+    pthread_mutex_unlock(&rpc->lock);
+
+    return f->status;
+}
+
+int rpmsg_rpc_call(struct rpmsg_rpc *rpc, uint16_t op, const void *data, size_t len,
+                   void *resp, size_t size, unsigned int timeout_ms)
+{
+    struct rpmsg_rpc_future f;
+    int ret;
+
+    f.resp = resp;
+    f.size = size;
+    ret = rpmsg_rpc_submit(rpc, op, data, len, timeout_ms, &f);
+    if (ret < 0)
+        return ret;
+
+    ret = rpmsg_rpc_wait(&f);
+
+    return ret ? ret : (int)f.len;
+}
+
+int rpmsg_rpc_reply(struct rpmsg_rpc *rpc, const struct rpmsg_rpc_hdr *req, int status,
+                    const void *data, size_t len)
+{
+    struct rpmsg_rpc_hdr hdr;
+
+    if (!rpc || !req)
+        return RPMSG_ERR_PARAM;
+
+    hdr.id = req->id;
+    hdr.op = req->op;
+    hdr.flags = RPMSG_RPC_FLAG_RESP;
+    hdr.status = status;
+
+    return rpc_send(rpc, &hdr, data, len);
+}
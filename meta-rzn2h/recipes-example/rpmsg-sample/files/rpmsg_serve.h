@@ -0,0 +1,83 @@
+/**
+ * @file    rpmsg_serve.h
+ * @brief   Helpers shared by the servers exposing an rpmsg device on Unix sockets.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * The bridge and the broker both run an event loop per device, find it
+ * again from the name service callback of the device, listen on a
+ * SOCK_SEQPACKET socket and pull the messages of their endpoints.
+ */
+
+#ifndef RPMSG_SERVE_H_
+#define RPMSG_SERVE_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <openamp/rpmsg.h>
+#include "rpmsg_poller.h"
+
+// Pending connections on a listening socket
+#define RPMSG_SERVE_BACKLOG     (4)
+
+/**
+ * @struct rpmsg_serve_registry
+ * @brief  running servers by device, for the name service callback
+ */
+struct rpmsg_serve_registry {
+    pthread_mutex_t lock;
+    struct rpmsg_device *rdev[RPMSG_POLLER_DEV_MAX];
+    void *server[RPMSG_POLLER_DEV_MAX];
+};
+
+#define RPMSG_SERVE_REGISTRY_INITIALIZER { PTHREAD_MUTEX_INITIALIZER, { NULL }, { NULL } }
+
+/**
+ * rpmsg_serve_register - publish the server of a device
+ *
+ * return 0 on success, -ENOSPC if RPMSG_POLLER_DEV_MAX servers run
+ */
+int rpmsg_serve_register(struct rpmsg_serve_registry *reg, struct rpmsg_device *rdev, void *server);
+
+/**
+ * rpmsg_serve_unregister - withdraw a server published by rpmsg_serve_register()
+ */
+void rpmsg_serve_unregister(struct rpmsg_serve_registry *reg, void *server);
+
+/**
+ * rpmsg_serve_find - server of a device, NULL if none runs
+ */
+void *rpmsg_serve_find(struct rpmsg_serve_registry *reg, struct rpmsg_device *rdev);
+
+/**
+ * rpmsg_serve_listen - listen on a non-blocking SOCK_SEQPACKET socket
+ *
+ * A file left at @path by a previous instance is removed first.
+ *
+ * return socket, negative errno on failure
+ */
+int rpmsg_serve_listen(const char *path);
+
+/**
+ * rpmsg_serve_ept_cb - endpoint callback of a server pulling its messages
+ *
+ * Only runs if a message cannot be queued for the pull; it is dropped.
+ */
+int rpmsg_serve_ept_cb(struct rpmsg_endpoint *ept, void *data, size_t len, uint32_t src, void *priv);
+
+/**
+ * rpmsg_serve_unbind_cb - unbind callback of a server endpoint
+ *
+ * Does nothing: the endpoint stays open until the server closes it, and
+ * the remote side may announce the service again.
+ */
+void rpmsg_serve_unbind_cb(struct rpmsg_endpoint *ept);
+
+#endif /* RPMSG_SERVE_H_ */
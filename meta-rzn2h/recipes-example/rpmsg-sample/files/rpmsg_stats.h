@@ -0,0 +1,195 @@
+/**
+ * @file    rpmsg_stats.h
+ * @brief   Per-channel and per-endpoint IPC statistics.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#ifndef RPMSG_STATS_H_
+#define RPMSG_STATS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Maximum number of channels and endpoints per channel that are tracked
+#define RPMSG_STATS_CHN_MAX     (8U)
+#define RPMSG_STATS_EPT_MAX     (8U)
+
+// Histogram buckets: upper bounds 1, 2, 4, ... 2^(n-2), then +Inf
+#define RPMSG_STATS_HIST_BUCKETS (16U)
+
+// Cache line size of the CA55 (and of the CM33/CR52 side of the shared memory)
+#define RPMSG_STATS_CACHE_LINE  (64U)
+
+// Prometheus text file written by the export thread
+#ifndef RPMSG_STATS_PATH
+#define RPMSG_STATS_PATH        "/run/rpmsg_sample_client.prom"
+#endif
+#ifndef RPMSG_STATS_PERIOD_MS
+#define RPMSG_STATS_PERIOD_MS   (1000U)
+#endif
+
+/** @enum rpmsg_stats_id - per-channel counters */
+enum rpmsg_stats_id {
+    RPMSG_STATS_TX_MSGS,            /**< messages sent to the remote */
+    RPMSG_STATS_TX_BYTES,           /**< payload bytes sent to the remote */
+    RPMSG_STATS_RX_MSGS,            /**< messages received from the remote */
+    RPMSG_STATS_RX_BYTES,           /**< payload bytes received from the remote */
+    RPMSG_STATS_DOORBELLS,          /**< doorbells rung towards the remote */
+    RPMSG_STATS_DOORBELLS_COALESCED,/**< kicks that found the previous doorbell still pending */
+    RPMSG_STATS_IRQS,               /**< mailbox interrupts taken */
+    RPMSG_STATS_IRQS_SPURIOUS,      /**< interrupts carrying an invalid notify_id */
+    RPMSG_STATS_TX_NOBUF,           /**< sends that found no free TX buffer */
+    RPMSG_STATS_NOTIFY_STS_WAITS,   /**< iterations spent waiting for the doorbell status */
+    RPMSG_STATS_TX_WAITS,           /**< blocking waits for a free TX buffer */
+    RPMSG_STATS_TX_WAKEUPS,         /**< waiters woken up by a notification from the remote */
+    RPMSG_STATS_TX_WAIT_TIMEOUTS,   /**< waits that ran into the timeout */
+    RPMSG_STATS_TX_WAIT_USEC,       /**< time spent blocked for a TX buffer */
+    RPMSG_STATS_TX_AGAIN,           /**< non-blocking sends that found no TX buffer */
+    RPMSG_STATS_TX_READY,           /**< TX space available events delivered */
+    RPMSG_STATS_TX_BATCHES,         /**< batches drained from the TX submission queue */
+    RPMSG_STATS_TX_DEADLINE_MISSES, /**< messages sent after their deadline */
+    RPMSG_STATS_TX_CREDIT_WAITS,    /**< sends that found the remote endpoint out of credits */
+    RPMSG_STATS_CREDIT_UPDATES,     /**< empty messages sent to grant credits */
+    RPMSG_STATS_ID_MAX,
+};
+
+/** @enum rpmsg_stats_ept_id - per-endpoint counters */
+enum rpmsg_stats_ept_id {
+    RPMSG_STATS_EPT_TX_MSGS,
+    RPMSG_STATS_EPT_TX_BYTES,
+    RPMSG_STATS_EPT_RX_MSGS,
+    RPMSG_STATS_EPT_RX_BYTES,
+    RPMSG_STATS_EPT_ID_MAX,
+};
+
+/** @enum rpmsg_stats_hist_id - per-channel histograms */
+enum rpmsg_stats_hist_id {
+    RPMSG_STATS_HIST_RX_BATCH,      /**< buffers handled per RX batch */
+    RPMSG_STATS_HIST_WORKER_DEPTH,  /**< worker queue depth seen by a new message */
+    RPMSG_STATS_HIST_WORKER_WAIT,   /**< microseconds a message waited for its worker */
+    RPMSG_STATS_HIST_HANDLER_USEC,  /**< microseconds spent in an endpoint callback on a worker */
+    RPMSG_STATS_HIST_TX_DELAY_URGENT, /**< microseconds until a TX buffer, one per TX class */
+    RPMSG_STATS_HIST_TX_DELAY_NORMAL,
+    RPMSG_STATS_HIST_TX_DELAY_BULK,
+    RPMSG_STATS_HIST_ECHO_IRQ_USEC, /**< microseconds from a send to its echo, woken by the doorbell */
+    RPMSG_STATS_HIST_ECHO_POLL_USEC,/**< same, busy polling the vrings */
+    RPMSG_STATS_HIST_ID_MAX,
+};
+
+struct rpmsg_stats_channel;
+struct rpmsg_stats_ept;
+
+/**
+ * rpmsg_stats_channel_get - look up or register a channel
+ *
+ * Channels are identified by the remote core name and the channel number.
+ * Registering the same pair again returns the existing entry, so counters
+ * survive a platform re-initialization.
+ *
+ * @remote: remote core name used as the "remote" label
+ * @channel: channel number used as the "channel" label
+ *
+ * return pointer to the channel entry or NULL if the registry is full
+ */
+struct rpmsg_stats_channel *rpmsg_stats_channel_get(const char *remote, unsigned int channel);
+
+/**
+ * rpmsg_stats_ept_get - look up or register an endpoint of a channel
+ *
+ * @chn: channel the endpoint belongs to
+ * @addr: local endpoint address
+ * @name: endpoint (service) name
+ *
+ * return pointer to the endpoint entry or NULL if the registry is full
+ */
+struct rpmsg_stats_ept *rpmsg_stats_ept_get(struct rpmsg_stats_channel *chn, uint32_t addr, const char *name);
+
+/**
+ * rpmsg_stats_ept_index - row of an endpoint entry in its channel
+ *
+ * Entries are never removed, so the row identifies the entry for good.
+ *
+ * @ept: endpoint entry
+ *
+ * return row, below RPMSG_STATS_EPT_MAX
+ */
+unsigned int rpmsg_stats_ept_index(const struct rpmsg_stats_ept *ept);
+
+/**
+ * rpmsg_stats_ept_at - endpoint entry of a row
+ *
+ * @chn: channel
+ * @index: row returned by rpmsg_stats_ept_index()
+ *
+ * return pointer to the endpoint entry or NULL if the row is not in use
+ */
+struct rpmsg_stats_ept *rpmsg_stats_ept_at(struct rpmsg_stats_channel *chn, unsigned int index);
+
+/**
+ * rpmsg_stats_add - add a value to a channel counter
+ *
+ * The counter lives in a cache-line aligned slab owned by the calling
+ * thread, so no atomic read-modify-write or cache line transfer is needed.
+ *
+ * @chn: channel, NULL is ignored
+ * @id: counter
+ * @val: value to add
+ */
+void rpmsg_stats_add(struct rpmsg_stats_channel *chn, enum rpmsg_stats_id id, uint64_t val);
+
+/**
+ * rpmsg_stats_ept_add - add a value to an endpoint counter
+ *
+ * @ept: endpoint, NULL is ignored
+ * @id: counter
+ * @val: value to add
+ */
+void rpmsg_stats_ept_add(struct rpmsg_stats_ept *ept, enum rpmsg_stats_ept_id id, uint64_t val);
+
+/**
+ * rpmsg_stats_observe - record a value in a channel histogram
+ *
+ * @chn: channel, NULL is ignored
+ * @id: histogram
+ * @val: observed value
+ */
+void rpmsg_stats_observe(struct rpmsg_stats_channel *chn, enum rpmsg_stats_hist_id id, uint64_t val);
+
+#define rpmsg_stats_inc(chn, id) rpmsg_stats_add((chn), (id), 1U)
+
+/**
+ * rpmsg_stats_write - write all counters in the Prometheus text format
+ *
+ * @fp: output stream
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_stats_write(FILE *fp);
+
+/**
+ * rpmsg_stats_start - start the export thread
+ *
+ * The thread rewrites @path atomically every @period_ms milliseconds, which
+ * makes it suitable for the node_exporter textfile collector.
+ *
+ * @path: output file
+ * @period_ms: export period
+ *
+ * return 0 on success, negative value on failure
+ */
+int rpmsg_stats_start(const char *path, unsigned int period_ms);
+
+/**
+ * rpmsg_stats_stop - stop the export thread after a final export
+ */
+void rpmsg_stats_stop(void);
+
+#endif /* RPMSG_STATS_H_ */
@@ -0,0 +1,1664 @@
+/**
+ * @file    rpmsg_vdev.c
+ * @brief   RPMsg virtio device with platform-side TX/RX hooks.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <metal/list.h>
+#include <metal/mutex.h>
+#include <metal/utilities.h>
+#include <openamp/rpmsg_virtio.h>
+#include "rpmsg_vdev.h"
+#include "rpmsg_poller.h"
+#include "rpmsg_workers.h"
+
+/* Look up an endpoint by its local address. Called with rdev->lock held. */
+static struct rpmsg_endpoint *ept_from_addr(struct rpmsg_device *rdev, uint32_t addr)
+{
+    struct metal_list *node;
+    struct rpmsg_endpoint *ept;
+
+    metal_list_for_each(&rdev->endpoints, node) {
+        ept = metal_container_of(node, struct rpmsg_endpoint, node);
+        if (ept->addr == addr)
+            return ept;
+    }
+
+    return NULL;
+}
+
+/*
+ * Remember the statistics row of a local address. A full registry is
+ * remembered too (row RPMSG_STATS_EPT_MAX), rows are never given back.
+ */
+static void ept_stats_cache(struct rpmsg_vdev *rpvdev, uint32_t addr, struct rpmsg_stats_ept *sept)
+{
+    uint64_t *slot = &rpvdev->ept_stats[addr % RPMSG_VDEV_EPT_STATS_NUM];
+    uint64_t val;
+
+    val = ((uint64_t)addr << 32) | ((sept ? rpmsg_stats_ept_index(sept) : RPMSG_STATS_EPT_MAX) + 1U);
+    if (__atomic_load_n(slot, __ATOMIC_RELAXED) != val)
+        __atomic_store_n(slot, val, __ATOMIC_RELAXED);
+}
+
+/*
+ * Statistics of a local address for the send path. The endpoint name is
+ * only looked up under rdev->lock the first time an address sends; the RX
+ * path refreshes the slot when the address is taken by a new endpoint.
+ */
+static struct rpmsg_stats_ept *ept_stats(struct rpmsg_vdev *rpvdev, uint32_t addr)
+{
+    struct rpmsg_device *rdev = &rpvdev->rvdev.rdev;
+    struct rpmsg_endpoint *ept;
+    struct rpmsg_stats_ept *sept;
+    char name[RPMSG_NAME_SIZE] = "";
+    uint64_t val;
+
+    if (!rpvdev->stats)
+        return NULL;
+
+    val = __atomic_load_n(&rpvdev->ept_stats[addr % RPMSG_VDEV_EPT_STATS_NUM], __ATOMIC_RELAXED);
+    if (val && ((uint32_t)(val >> 32) == addr))
+        return rpmsg_stats_ept_at(rpvdev->stats, (unsigned int)(val & 0xFFFFFFFFU) - 1U);
+
+    metal_mutex_acquire(&rdev->lock);
+    ept = ept_from_addr(rdev, addr);
+    if (ept)
+        memcpy(name, ept->name, sizeof(name) - 1);
+    metal_mutex_release(&rdev->lock);
+
+    sept = rpmsg_stats_ept_get(rpvdev->stats, addr, name);
+    ept_stats_cache(rpvdev, addr, sept);
+
+    return sept;
+}
+
+/* Operations of the TX submission queue */
+enum tx_op {
+    TX_OP_COPY, /* copy the payload into a TX buffer and send it */
+    TX_OP_GET,  /* take a TX buffer for a message built in place */
+    TX_OP_SEND, /* send a buffer taken with TX_OP_GET */
+    TX_OP_PUT,  /* give back a buffer taken with TX_OP_GET */
+    TX_OP_CREDIT, /* grant the credits owed by an endpoint in an empty message */
+};
+
+/**
+ * @struct tx_req
+ * @brief  send request queued on the TX submission queue
+ */
+struct tx_req {
+    struct rpmsg_txq_node node;
+    enum tx_op op;
+    uint32_t src;
+    uint32_t dst;
+    const void *data;
+    int size;
+    void *buf; /**< TX buffer (header included) of TX_OP_GET/SEND/PUT */
+    unsigned int cls; /**< TX class of TX_OP_COPY/GET */
+    uint64_t deadline; /**< CLOCK_MONOTONIC microseconds, RPMSG_VDEV_NO_DEADLINE if none */
+    unsigned int seq; /**< arrival order while blocked */
+    struct metal_list wait; /**< entry of tx_wait_list while blocked */
+};
+
+/* TX class of an endpoint address; senders read the table without the lock */
+static unsigned int tx_class_of(struct rpmsg_vdev *rpvdev, uint32_t addr)
+{
+    uint64_t entry;
+    unsigned int i;
+
+    for (i = 0; i < RPMSG_VDEV_TX_CLASS_EPT_MAX; i++) {
+        entry = __atomic_load_n(&rpvdev->tx_class[i], __ATOMIC_RELAXED);
+        if (entry && ((uint32_t)(entry >> 32) == addr))
+            return (unsigned int)(entry & 0xFFU) - 1U;
+    }
+
+    return RPMSG_VDEV_TX_NORMAL;
+}
+
+/* Flow control state of an endpoint address; senders look it up without the lock */
+static struct rpmsg_vdev_credit *credit_find(struct rpmsg_vdev *rpvdev, uint32_t addr)
+{
+    struct rpmsg_vdev_credit *c;
+    unsigned int i;
+
+    if (!__atomic_load_n(&rpvdev->credit_num, __ATOMIC_ACQUIRE))
+        return NULL;
+
+    for (i = 0; i < RPMSG_VDEV_CREDIT_EPT_MAX; i++) {
+        c = &rpvdev->credit[i];
+        if (__atomic_load_n(&c->window, __ATOMIC_ACQUIRE) && (c->addr == addr))
+            return c;
+    }
+
+    return NULL;
+}
+
+static int credit_try(struct rpmsg_vdev_credit *c)
+{
+    unsigned int n = __atomic_load_n(&c->tx, __ATOMIC_RELAXED);
+
+    while (n) {
+        if (__atomic_compare_exchange_n(&c->tx, &n, n - 1U, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return 1;
+    }
+
+    return 0;
+}
+
+static int tx_req_waiting(struct tx_req *req)
+{
+    return req->wait.next != &req->wait;
+}
+
+/* Whether blocked request a takes a TX buffer before request b */
+static int tx_before(struct tx_req *a, struct tx_req *b)
+{
+    if (a->cls != b->cls)
+        return a->cls < b->cls;
+    if (a->deadline != b->deadline)
+        return a->deadline < b->deadline;
+    /* Blocked senders keep their arrival order and go before new ones */
+    return !tx_req_waiting(b) || ((int)(a->seq - b->seq) < 0);
+}
+
+/*
+ * TX buffers held neither by the remote nor by a sender building a message
+ * in place. Called by the TX drainer only.
+ */
+static unsigned int tx_avail(struct rpmsg_vdev *rpvdev)
+{
+    struct virtqueue *svq = rpvdev->rvdev.svq;
+    unsigned int n;
+
+    n = svq->vq_free_cnt +
+        (uint16_t)(__atomic_load_n(&svq->vq_ring.used->idx, __ATOMIC_ACQUIRE) - svq->vq_used_cons_idx);
+
+    return (n > rpvdev->tx_held) ? n - rpvdev->tx_held : 0U;
+}
+
+/*
+ * Whether a request may take one of @avail TX buffers: the share of the
+ * ring reserved for the more urgent classes, and one buffer for each
+ * blocked sender going first, stay available.
+ */
+static int tx_admit(struct rpmsg_vdev *rpvdev, struct tx_req *req, unsigned int avail)
+{
+    unsigned int need = req->cls * (rpvdev->rvdev.svq->vq_nentries >> RPMSG_VDEV_TX_RESERVE_SHIFT);
+    struct metal_list *node;
+
+    if (avail <= need)
+        return 0;
+    if (!__atomic_load_n(&rpvdev->tx_waiters, __ATOMIC_SEQ_CST))
+        return 1;
+
+    pthread_mutex_lock(&rpvdev->tx_lock);
+    metal_list_for_each(&rpvdev->tx_wait_list, node) {
+        if (tx_before(metal_container_of(node, struct tx_req, wait), req) &&
+            (node != &req->wait))
+            need++;
+    }
+    pthread_mutex_unlock(&rpvdev->tx_lock);
+
+    return avail > need;
+}
+
+/*
+ * Same buffer selection as open-amp, limited to the ring length (patch 0006).
+ * Buffers given back unused are taken first. Called by the TX drainer only.
+ */
+static void *tx_get_buffer(struct rpmsg_vdev *rpvdev)
+{
+    struct rpmsg_virtio_device *rvdev = &rpvdev->rvdev;
+    struct virtqueue *svq = rvdev->svq;
+    void *buf;
+    uint32_t len;
+    uint16_t idx;
+
+    if (rpvdev->tx_spare_num)
+        return rpvdev->tx_spare[--rpvdev->tx_spare_num];
+
+    buf = virtqueue_get_buffer(svq, &len, &idx);
+    if (!buf && svq->vq_free_cnt)
+        buf = rpmsg_virtio_shm_pool_get_buffer(rvdev->shpool, RPMSG_BUFFER_SIZE);
+
+    return buf;
+}
+
+/*
+ * Drain function of the TX submission queue. Runs on one sender thread at a
+ * time, so the send virtqueue needs no lock. All buffers of the batch are
+ * made available before the single kick.
+ */
+static void tx_drain(void *arg, struct rpmsg_txq_node **nodes, unsigned int n)
+{
+    struct rpmsg_vdev *rpvdev = arg;
+    struct rpmsg_virtio_device *rvdev = &rpvdev->rvdev;
+    struct rpmsg_vdev_hdr hdr;
+    struct virtqueue_buf vqbuf;
+    struct tx_req *req;
+    struct rpmsg_vdev_credit *c;
+    unsigned long off;
+    unsigned int i, queued = 0;
+    unsigned int credits;
+    unsigned int avail = tx_avail(rpvdev);
+    unsigned int failed = RPMSG_VDEV_TX_CLASS_NUM;
+    void *buf;
+
+    for (i = 0; i < n; i++) {
+        req = metal_container_of(nodes[i], struct tx_req, node);
+        if (req->op == TX_OP_PUT) {
+            rpvdev->tx_spare[rpvdev->tx_spare_num++] = req->buf;
+            if (rpvdev->tx_held)
+                rpvdev->tx_held--;
+            req->node.result = 0;
+            continue;
+        }
+        c = credit_find(rpvdev, req->src);
+        if (req->op == TX_OP_CREDIT) {
+            /* Nothing to do if the credits went out with a message meanwhile */
+            credits = c ? __atomic_exchange_n(&c->grant, 0U, __ATOMIC_ACQ_REL) : 0U;
+            req->node.result = 0;
+            if (!credits)
+                continue;
+            /*
+             * Not held back by the class reserve, the remote may be waiting
+             * for them, but never the descriptor of a buffer held in place
+             */
+            buf = avail ? tx_get_buffer(rpvdev) : NULL;
+            if (!buf) {
+                __atomic_add_fetch(&c->grant, credits, __ATOMIC_RELEASE);
+                req->node.result = RPMSG_ERR_NO_BUFF;
+                continue;
+            }
+            avail--;
+        } else {
+            buf = req->buf;
+            if (req->op != TX_OP_SEND) {
+                /*
+                 * Once a class is out of buffers, its later requests and those
+                 * of the less urgent classes fail too, so that the order is kept
+                 */
+                buf = NULL;
+                if ((req->cls < failed) && tx_admit(rpvdev, req, avail))
+                    buf = tx_get_buffer(rpvdev);
+                if (!buf) {
+                    if (req->cls < failed)
+                        failed = req->cls;
+                    req->node.result = RPMSG_ERR_NO_BUFF;
+                    continue;
+                }
+                avail--;
+                if (req->op == TX_OP_GET) {
+                    rpvdev->tx_held++;
+                    req->buf = buf;
+                    req->node.result = 0;
+                    continue;
+                }
+            } else if (rpvdev->tx_held) {
+                rpvdev->tx_held--;
+            }
+            /* Credits owed to the remote endpoint go along with a message to it */
+            credits = (c && (req->dst == __atomic_load_n(&c->dst, __ATOMIC_RELAXED))) ?
+                      __atomic_exchange_n(&c->grant, 0U, __ATOMIC_ACQ_REL) : 0U;
+        }
+
+        hdr.src = req->src;
+        hdr.dst = req->dst;
+        hdr.reserved = credits;
+        hdr.len = (uint16_t)req->size;
+        hdr.flags = credits ? RPMSG_VDEV_HDR_CREDIT : 0U;
+        off = metal_io_virt_to_offset(rvdev->shbuf_io, buf);
+        (void)metal_io_block_write(rvdev->shbuf_io, off, &hdr, sizeof(hdr));
+        if (req->op == TX_OP_COPY)
+            (void)metal_io_block_write(rvdev->shbuf_io, off + sizeof(hdr), req->data, req->size);
+
+        vqbuf.buf = buf;
+        vqbuf.len = RPMSG_BUFFER_SIZE;
+        if (virtqueue_add_buffer(rvdev->svq, &vqbuf, 1, 0, buf) != VQUEUE_SUCCESS) {
+            req->node.result = RPMSG_ERR_NO_BUFF;
+            if ((req->op == TX_OP_COPY) && (req->cls < failed))
+                failed = req->cls;
+            if (credits)
+                __atomic_add_fetch(&c->grant, credits, __ATOMIC_RELEASE);
+            rpvdev->tx_spare[rpvdev->tx_spare_num++] = buf;
+            continue;
+        }
+        req->node.result = (req->op == TX_OP_CREDIT) ? (int)credits : req->size;
+        queued++;
+    }
+
+    if (queued) {
+        virtqueue_kick(rvdev->svq);
+        rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_BATCHES);
+    }
+}
+
+/* Run a request once without waiting for a TX buffer */
+static int tx_submit(struct rpmsg_vdev *rpvdev, struct tx_req *req)
+{
+    /* Only the master owns the TX ring; only copying sends get here otherwise */
+    if (rpvdev->rvdev.vdev->role != VIRTIO_DEV_MASTER)
+        return rpvdev->send_offchannel_raw(&rpvdev->rvdev.rdev, req->src, req->dst,
+                                           req->data, req->size, 0);
+
+    return rpmsg_txq_submit(&rpvdev->txq, &req->node);
+}
+
+static void tx_req_init(struct rpmsg_vdev *rpvdev, struct tx_req *req, enum tx_op op,
+                        uint32_t src, uint32_t dst, const void *data, int size, void *buf)
+{
+    req->op = op;
+    req->src = src;
+    req->dst = dst;
+    req->data = data;
+    req->size = size;
+    req->buf = buf;
+    req->cls = ((op == TX_OP_COPY) || (op == TX_OP_GET)) ? tx_class_of(rpvdev, src) : 0U;
+    req->deadline = RPMSG_VDEV_NO_DEADLINE;
+    req->seq = 0U;
+    metal_list_init(&req->wait);
+}
+
+static uint64_t elapsed_usec(const struct timespec *from, const struct timespec *to)
+{
+    return (uint64_t)(to->tv_sec - from->tv_sec) * 1000000U
+           + (uint64_t)((to->tv_nsec - from->tv_nsec) / 1000);
+}
+
+static void timespec_add_ms(struct timespec *ts, unsigned int ms)
+{
+    ts->tv_sec += ms / 1000U;
+    ts->tv_nsec += (long)(ms % 1000U) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+static int timespec_before(const struct timespec *a, const struct timespec *b)
+{
+    return (a->tv_sec < b->tv_sec) || ((a->tv_sec == b->tv_sec) && (a->tv_nsec < b->tv_nsec));
+}
+
+/* The clock is only read if the delay is exported or the deadline checked */
+static void tx_clock(struct rpmsg_vdev *rpvdev, struct tx_req *req, struct timespec *ts)
+{
+    if (rpvdev->stats || (req->deadline != RPMSG_VDEV_NO_DEADLINE))
+        (void)clock_gettime(CLOCK_MONOTONIC, ts);
+}
+
+/* Queueing delay of a request that got its TX buffer, by class */
+static void tx_account_delay(struct rpmsg_vdev *rpvdev, struct tx_req *req, const struct timespec *start)
+{
+    struct timespec now;
+
+    if (!rpvdev->stats && (req->deadline == RPMSG_VDEV_NO_DEADLINE))
+        return;
+
+    tx_clock(rpvdev, req, &now);
+    rpmsg_stats_observe(rpvdev->stats, (enum rpmsg_stats_hist_id)(RPMSG_STATS_HIST_TX_DELAY_URGENT + req->cls),
+                        elapsed_usec(start, &now));
+    if ((uint64_t)now.tv_sec * 1000000U + (uint64_t)now.tv_nsec / 1000U > req->deadline)
+        rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_DEADLINE_MISSES);
+}
+
+/*
+ * Whether a TX buffer can be obtained: either the remote has returned used
+ * buffers, or the ring still has descriptors for new pool buffers.
+ */
+static int tx_space(struct rpmsg_vdev *rpvdev)
+{
+    struct virtqueue *svq = rpvdev->rvdev.svq;
+
+    return rpvdev->tx_spare_num || svq->vq_free_cnt ||
+           (__atomic_load_n(&svq->vq_ring.used->idx, __ATOMIC_ACQUIRE) != svq->vq_used_cons_idx);
+}
+
+/* Whether the remote added used buffers to the RX virtqueue that were not taken yet */
+static int rx_pending(struct rpmsg_vdev *rpvdev)
+{
+    struct virtqueue *rvq = rpvdev->rvdev.rvq;
+
+    return __atomic_load_n(&rvq->vq_ring.used->idx, __ATOMIC_ACQUIRE) != rvq->vq_used_cons_idx;
+}
+
+/*
+ * Busy polling: spin until ready() or until the given time, in place of a
+ * wait for the notification. Returns whether ready() became true.
+ */
+static int busy_wait(struct rpmsg_vdev *rpvdev, int (*ready)(struct rpmsg_vdev *rpvdev),
+                     const struct timespec *until)
+{
+    struct timespec now;
+
+    do {
+        if (ready(rpvdev))
+            return 1;
+        (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    } while (timespec_before(&now, until));
+
+    return 0;
+}
+
+/*
+ * Run a request, blocking until the remote returns a TX buffer. The
+ * notification sequence is sampled before each attempt, so a notification
+ * arriving between a failed attempt and the wait is never lost. While
+ * blocked, the request is on tx_wait_list, where the TX drainer finds the
+ * senders that go first.
+ */
+static int tx_wait_submit(struct rpmsg_vdev *rpvdev, struct tx_req *req)
+{
+    struct timespec start, now, deadline, until;
+    unsigned int seq;
+    int ret;
+
+    rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_WAITS);
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    deadline = start;
+    timespec_add_ms(&deadline, RPMSG_VDEV_TX_TIMEOUT_MS);
+
+    pthread_mutex_lock(&rpvdev->tx_lock);
+    req->seq = rpvdev->tx_wait_seq++;
+    metal_list_add_tail(&rpvdev->tx_wait_list, &req->wait);
+    pthread_mutex_unlock(&rpvdev->tx_lock);
+    __atomic_add_fetch(&rpvdev->tx_waiters, 1U, __ATOMIC_SEQ_CST);
+    for (;;) {
+        seq = __atomic_load_n(&rpvdev->tx_seq, __ATOMIC_SEQ_CST);
+        ret = tx_submit(rpvdev, req);
+        if (ret != RPMSG_ERR_NO_BUFF)
+            break;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &now);
+        if (!timespec_before(&now, &deadline)) {
+            rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_WAIT_TIMEOUTS);
+            break;
+        }
+        until = now;
+        timespec_add_ms(&until, RPMSG_VDEV_TX_RECHECK_MS);
+        if (timespec_before(&deadline, &until))
+            until = deadline;
+
+        if (__atomic_load_n(&rpvdev->busy_poll, __ATOMIC_RELAXED)) {
+            (void)busy_wait(rpvdev, tx_space, &until);
+            continue;
+        }
+        pthread_mutex_lock(&rpvdev->tx_lock);
+        while (seq == rpvdev->tx_seq) {
+            if (pthread_cond_timedwait(&rpvdev->tx_cond, &rpvdev->tx_lock, &until) == ETIMEDOUT)
+                break;
+        }
+        if (seq != rpvdev->tx_seq)
+            rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_WAKEUPS);
+        pthread_mutex_unlock(&rpvdev->tx_lock);
+    }
+    __atomic_sub_fetch(&rpvdev->tx_waiters, 1U, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&rpvdev->tx_lock);
+    metal_list_del(&req->wait);
+    pthread_mutex_unlock(&rpvdev->tx_lock);
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    rpmsg_stats_add(rpvdev->stats, RPMSG_STATS_TX_WAIT_USEC, elapsed_usec(&start, &now));
+
+    return ret;
+}
+
+static void tx_fd_signal(struct rpmsg_vdev *rpvdev)
+{
+    uint64_t one = 1U;
+
+    if (rpvdev->tx_fd >= 0)
+        (void)write(rpvdev->tx_fd, &one, sizeof(one));
+}
+
+/* Wake the senders waiting for a TX buffer or for credits */
+static void tx_wake(struct rpmsg_vdev *rpvdev)
+{
+    __atomic_add_fetch(&rpvdev->tx_seq, 1U, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&rpvdev->tx_waiters, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&rpvdev->tx_lock);
+        pthread_cond_broadcast(&rpvdev->tx_cond);
+        pthread_mutex_unlock(&rpvdev->tx_lock);
+    }
+    if (__atomic_load_n(&rpvdev->tx_armed, __ATOMIC_SEQ_CST) && tx_space(rpvdev))
+        tx_fd_signal(rpvdev);
+}
+
+void rpmsg_vdev_notified(struct rpmsg_vdev *rpvdev)
+{
+    if (!rpvdev)
+        return;
+
+    tx_wake(rpvdev);
+    if (__atomic_load_n(&rpvdev->rx_waiters, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&rpvdev->rx_lock);
+        pthread_cond_broadcast(&rpvdev->rx_cond);
+        pthread_mutex_unlock(&rpvdev->rx_lock);
+    }
+    if (__atomic_load_n(&rpvdev->poller, __ATOMIC_ACQUIRE))
+        rpmsg_poller_schedule(rpvdev);
+}
+
+static unsigned int rx_poll_locked(struct rpmsg_vdev *rpvdev, unsigned int budget);
+
+/*
+ * Take a credit of a flow controlled endpoint. Credits come in with the
+ * messages of the remote endpoint, so while no other thread takes them
+ * from the RX virtqueue, the waiting sender does, like
+ * rpmsg_vdev_recv_batch().
+ */
+static int credit_take(struct rpmsg_vdev *rpvdev, struct rpmsg_vdev_credit *c, int wait)
+{
+    struct timespec now, deadline, until;
+    unsigned int seq;
+    int ret = RPMSG_ERR_NO_BUFF;
+
+    if (credit_try(c))
+        return 0;
+    if (!wait)
+        return RPMSG_ERR_NO_BUFF;
+
+    rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_CREDIT_WAITS);
+    (void)clock_gettime(CLOCK_MONOTONIC, &deadline);
+    timespec_add_ms(&deadline, RPMSG_VDEV_TX_TIMEOUT_MS);
+
+    __atomic_add_fetch(&rpvdev->tx_waiters, 1U, __ATOMIC_SEQ_CST);
+    for (;;) {
+        seq = __atomic_load_n(&rpvdev->tx_seq, __ATOMIC_SEQ_CST);
+        if (!pthread_mutex_trylock(&rpvdev->rx_poll_lock)) {
+            (void)rx_poll_locked(rpvdev, UINT_MAX);
+            pthread_mutex_unlock(&rpvdev->rx_poll_lock);
+        }
+        if (credit_try(c)) {
+            ret = 0;
+            break;
+        }
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &now);
+        if (!timespec_before(&now, &deadline)) {
+            rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_WAIT_TIMEOUTS);
+            break;
+        }
+        until = now;
+        timespec_add_ms(&until, RPMSG_VDEV_TX_RECHECK_MS);
+        if (timespec_before(&deadline, &until))
+            until = deadline;
+
+        if (__atomic_load_n(&rpvdev->busy_poll, __ATOMIC_RELAXED)) {
+            /* The credits come with the messages */
+            (void)busy_wait(rpvdev, rx_pending, &until);
+            continue;
+        }
+        pthread_mutex_lock(&rpvdev->tx_lock);
+        while (seq == rpvdev->tx_seq) {
+            if (pthread_cond_timedwait(&rpvdev->tx_cond, &rpvdev->tx_lock, &until) == ETIMEDOUT)
+                break;
+        }
+        pthread_mutex_unlock(&rpvdev->tx_lock);
+    }
+    __atomic_sub_fetch(&rpvdev->tx_waiters, 1U, __ATOMIC_SEQ_CST);
+
+    return ret;
+}
+
+/* Give back a credit taken for a message that was not sent */
+static void credit_put(struct rpmsg_vdev *rpvdev, struct rpmsg_vdev_credit *c)
+{
+    if (!c)
+        return;
+
+    __atomic_add_fetch(&c->tx, 1U, __ATOMIC_RELEASE);
+    tx_wake(rpvdev);
+}
+
+/* Whether the endpoint may send as far as its flow control is concerned */
+static int credit_ready(struct rpmsg_vdev *rpvdev, uint32_t addr)
+{
+    struct rpmsg_vdev_credit *c = credit_find(rpvdev, addr);
+
+    return !c || __atomic_load_n(&c->tx, __ATOMIC_RELAXED);
+}
+
+/* Grant the owed credits in an empty message once half a window is due */
+static void credit_flush(struct rpmsg_vdev *rpvdev)
+{
+    struct rpmsg_vdev_credit *c;
+    struct tx_req req;
+    unsigned int i, window;
+
+    if (!__atomic_load_n(&rpvdev->credit_num, __ATOMIC_ACQUIRE))
+        return;
+
+    for (i = 0; i < RPMSG_VDEV_CREDIT_EPT_MAX; i++) {
+        c = &rpvdev->credit[i];
+        window = __atomic_load_n(&c->window, __ATOMIC_ACQUIRE);
+        if (!window || (__atomic_load_n(&c->grant, __ATOMIC_ACQUIRE) < (window + 1U) / 2U))
+            continue;
+        /* Left owed without a TX buffer, retried on the next release or TX completion */
+        tx_req_init(rpvdev, &req, TX_OP_CREDIT, c->addr, __atomic_load_n(&c->dst, __ATOMIC_RELAXED),
+                    NULL, 0, NULL);
+        if (tx_submit(rpvdev, &req) > 0)
+            rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_CREDIT_UPDATES);
+    }
+}
+
+static struct rpmsg_vdev_tx_ready *tx_ready_find(struct rpmsg_vdev *rpvdev, struct rpmsg_endpoint *ept)
+{
+    unsigned int i;
+
+    for (i = 0; i < RPMSG_VDEV_TX_READY_MAX; i++) {
+        if (rpvdev->tx_ready[i].ept == ept)
+            return &rpvdev->tx_ready[i];
+    }
+
+    return NULL;
+}
+
+/* Arm the TX space available callback of an endpoint that found no buffer */
+static void tx_arm(struct rpmsg_vdev *rpvdev, struct rpmsg_endpoint *ept)
+{
+    struct rpmsg_vdev_tx_ready *entry;
+
+    rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_AGAIN);
+
+    pthread_mutex_lock(&rpvdev->tx_lock);
+    entry = tx_ready_find(rpvdev, ept);
+    if (entry && !entry->armed) {
+        entry->armed = 1;
+        __atomic_add_fetch(&rpvdev->tx_armed, 1U, __ATOMIC_SEQ_CST);
+    }
+    pthread_mutex_unlock(&rpvdev->tx_lock);
+
+    /* Buffers or credits returned between the attempt and arming would not raise an event */
+    if (tx_space(rpvdev) && credit_ready(rpvdev, ept->addr))
+        tx_fd_signal(rpvdev);
+}
+
+int rpmsg_vdev_trysendto(struct rpmsg_endpoint *ept, const void *data, int len, uint32_t dst)
+{
+    struct rpmsg_vdev *rpvdev;
+    int ret;
+
+    if (!ept || !ept->rdev)
+        return RPMSG_ERR_PARAM;
+    rpvdev = rpmsg_vdev_from_rdev(ept->rdev);
+
+    ret = rpmsg_send_offchannel_raw(ept, ept->addr, dst, data, len, 0);
+    if (ret != RPMSG_ERR_NO_BUFF)
+        return ret;
+
+    tx_arm(rpvdev, ept);
+
+    return -EAGAIN;
+}
+
+int rpmsg_vdev_trysend(struct rpmsg_endpoint *ept, const void *data, int len)
+{
+    if (!ept)
+        return RPMSG_ERR_PARAM;
+
+    return rpmsg_vdev_trysendto(ept, data, len, ept->dest_addr);
+}
+
+int rpmsg_vdev_set_tx_ready_cb(struct rpmsg_endpoint *ept, rpmsg_vdev_tx_ready_cb cb, void *priv)
+{
+    struct rpmsg_vdev *rpvdev;
+    struct rpmsg_vdev_tx_ready *entry;
+    int ret = 0;
+
+    if (!ept || !ept->rdev)
+        return RPMSG_ERR_PARAM;
+    rpvdev = rpmsg_vdev_from_rdev(ept->rdev);
+
+    pthread_mutex_lock(&rpvdev->tx_lock);
+    entry = tx_ready_find(rpvdev, ept);
+    if (!cb) {
+        if (entry) {
+            if (entry->armed)
+                __atomic_sub_fetch(&rpvdev->tx_armed, 1U, __ATOMIC_SEQ_CST);
+            memset(entry, 0, sizeof(*entry));
+        }
+    } else {
+        if (!entry)
+            entry = tx_ready_find(rpvdev, NULL);
+        if (entry) {
+            entry->ept = ept;
+            entry->cb = cb;
+            entry->priv = priv;
+        } else {
+            ret = RPMSG_ERR_NO_MEM;
+        }
+    }
+    pthread_mutex_unlock(&rpvdev->tx_lock);
+
+    return ret;
+}
+
+int rpmsg_vdev_tx_fd(struct rpmsg_device *rdev)
+{
+    return rpmsg_vdev_from_rdev(rdev)->tx_fd;
+}
+
+void rpmsg_vdev_tx_dispatch(struct rpmsg_device *rdev)
+{
+    struct rpmsg_vdev *rpvdev = rpmsg_vdev_from_rdev(rdev);
+    struct rpmsg_vdev_tx_ready fire[RPMSG_VDEV_TX_READY_MAX];
+    unsigned int i, n = 0;
+    uint64_t cnt;
+
+    if (rpvdev->tx_fd >= 0)
+        (void)read(rpvdev->tx_fd, &cnt, sizeof(cnt));
+
+    credit_flush(rpvdev);
+    if (!__atomic_load_n(&rpvdev->tx_armed, __ATOMIC_SEQ_CST) || !tx_space(rpvdev))
+        return;
+
+    /*
+     * Callbacks are one-shot and run without the lock, so that they can send.
+     * Endpoints out of credits stay armed until the remote grants more.
+     */
+    pthread_mutex_lock(&rpvdev->tx_lock);
+    for (i = 0; i < RPMSG_VDEV_TX_READY_MAX; i++) {
+        if (rpvdev->tx_ready[i].armed && credit_ready(rpvdev, rpvdev->tx_ready[i].ept->addr)) {
+            rpvdev->tx_ready[i].armed = 0;
+            __atomic_sub_fetch(&rpvdev->tx_armed, 1U, __ATOMIC_SEQ_CST);
+            fire[n++] = rpvdev->tx_ready[i];
+        }
+    }
+    pthread_mutex_unlock(&rpvdev->tx_lock);
+
+    for (i = 0; i < n; i++) {
+        rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_READY);
+        fire[i].cb(fire[i].ept, fire[i].priv);
+    }
+}
+
+/* TX virtqueue callback: the remote has given TX buffers back */
+static void rpmsg_vdev_tx_callback(struct virtqueue *vq)
+{
+    struct rpmsg_virtio_device *rvdev = vq->vq_dev->priv;
+
+    rpmsg_vdev_tx_dispatch(&rvdev->rdev);
+}
+
+static void tx_account(struct rpmsg_vdev *rpvdev, uint32_t src, int size)
+{
+    struct rpmsg_stats_ept *ept;
+
+    rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_MSGS);
+    rpmsg_stats_add(rpvdev->stats, RPMSG_STATS_TX_BYTES, (uint64_t)size);
+    ept = ept_stats(rpvdev, src);
+    rpmsg_stats_ept_add(ept, RPMSG_STATS_EPT_TX_MSGS, 1U);
+    rpmsg_stats_ept_add(ept, RPMSG_STATS_EPT_TX_BYTES, (uint64_t)size);
+}
+
+/* Copy a message into a TX buffer and send it */
+static int tx_send(struct rpmsg_vdev *rpvdev, uint32_t src, uint32_t dst,
+                   const void *data, int size, int wait, uint64_t deadline)
+{
+    struct rpmsg_vdev_credit *c;
+    struct timespec start;
+    struct tx_req req;
+    int ret;
+
+    if ((rpvdev->rvdev.vdev->role == VIRTIO_DEV_MASTER) &&
+        ((size < 0) || ((size_t)size > RPMSG_BUFFER_SIZE - sizeof(struct rpmsg_vdev_hdr))))
+        return RPMSG_ERR_BUFF_SIZE;
+
+    /* Credits first: a sender waiting for them holds no TX buffer */
+    c = credit_find(rpvdev, src);
+    if (c) {
+        ret = credit_take(rpvdev, c, wait);
+        if (ret < 0)
+            return ret;
+    }
+
+    tx_req_init(rpvdev, &req, TX_OP_COPY, src, dst, data, size, NULL);
+    req.deadline = deadline;
+    tx_clock(rpvdev, &req, &start);
+
+    /* Never let open-amp sleep-poll for a buffer, block on the TX completion instead */
+    ret = tx_submit(rpvdev, &req);
+    if ((ret == RPMSG_ERR_NO_BUFF) && wait) {
+        rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_NOBUF);
+        ret = tx_wait_submit(rpvdev, &req);
+    }
+
+    if (ret >= 0) {
+        tx_account(rpvdev, src, size);
+        tx_account_delay(rpvdev, &req, &start);
+    } else {
+        credit_put(rpvdev, c);
+    }
+
+    return ret;
+}
+
+static int rpmsg_vdev_send_offchannel_raw(struct rpmsg_device *rdev, uint32_t src, uint32_t dst,
+                                          const void *data, int size, int wait)
+{
+    return tx_send(rpmsg_vdev_from_rdev(rdev), src, dst, data, size, wait, RPMSG_VDEV_NO_DEADLINE);
+}
+
+int rpmsg_vdev_set_tx_class(struct rpmsg_endpoint *ept, enum rpmsg_vdev_tx_class cls)
+{
+    struct rpmsg_vdev *rpvdev;
+    uint64_t entry;
+    unsigned int i, slot = RPMSG_VDEV_TX_CLASS_EPT_MAX;
+    int ret = 0;
+
+    if (!ept || !ept->rdev || ((unsigned int)cls >= RPMSG_VDEV_TX_CLASS_NUM))
+        return RPMSG_ERR_PARAM;
+    rpvdev = rpmsg_vdev_from_rdev(ept->rdev);
+
+    /* Writers are serialized by tx_lock, senders read the table without it */
+    pthread_mutex_lock(&rpvdev->tx_lock);
+    for (i = 0; i < RPMSG_VDEV_TX_CLASS_EPT_MAX; i++) {
+        entry = rpvdev->tx_class[i];
+        if (entry && ((uint32_t)(entry >> 32) == ept->addr)) {
+            slot = i;
+            break;
+        }
+        if (!entry && (slot == RPMSG_VDEV_TX_CLASS_EPT_MAX))
+            slot = i;
+    }
+    if (slot == RPMSG_VDEV_TX_CLASS_EPT_MAX) {
+        if (cls != RPMSG_VDEV_TX_NORMAL)
+            ret = RPMSG_ERR_NO_MEM;
+    } else if (cls == RPMSG_VDEV_TX_NORMAL) {
+        __atomic_store_n(&rpvdev->tx_class[slot], 0U, __ATOMIC_RELAXED);
+    } else {
+        __atomic_store_n(&rpvdev->tx_class[slot], ((uint64_t)ept->addr << 32) | ((uint64_t)cls + 1U),
+                         __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&rpvdev->tx_lock);
+
+    return ret;
+}
+
+int rpmsg_vdev_sendto_deadline(struct rpmsg_endpoint *ept, const void *data, int len,
+                               uint32_t dst, uint64_t deadline_us)
+{
+    if (!ept || !ept->rdev)
+        return RPMSG_ERR_PARAM;
+
+    return tx_send(rpmsg_vdev_from_rdev(ept->rdev), ept->addr, dst, data, len, 1, deadline_us);
+}
+
+int rpmsg_vdev_send_deadline(struct rpmsg_endpoint *ept, const void *data, int len, uint64_t deadline_us)
+{
+    if (!ept)
+        return RPMSG_ERR_PARAM;
+
+    return rpmsg_vdev_sendto_deadline(ept, data, len, ept->dest_addr, deadline_us);
+}
+
+void *rpmsg_vdev_get_tx_buffer(struct rpmsg_endpoint *ept, uint32_t *size, int wait)
+{
+    struct rpmsg_vdev *rpvdev;
+    struct rpmsg_vdev_credit *c;
+    struct timespec start;
+    struct tx_req req;
+    int ret;
+
+    if (!ept || !ept->rdev)
+        return NULL;
+    rpvdev = rpmsg_vdev_from_rdev(ept->rdev);
+    if (rpvdev->rvdev.vdev->role != VIRTIO_DEV_MASTER)
+        return NULL;
+
+    /* The buffer holds a credit until it is sent or given back */
+    c = credit_find(rpvdev, ept->addr);
+    if (c && (credit_take(rpvdev, c, wait) < 0)) {
+        if (!wait)
+            tx_arm(rpvdev, ept);
+        return NULL;
+    }
+
+    tx_req_init(rpvdev, &req, TX_OP_GET, ept->addr, 0U, NULL, 0, NULL);
+    tx_clock(rpvdev, &req, &start);
+    ret = tx_submit(rpvdev, &req);
+    if ((ret == RPMSG_ERR_NO_BUFF) && wait) {
+        rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_TX_NOBUF);
+        ret = tx_wait_submit(rpvdev, &req);
+    }
+    if (ret < 0) {
+        credit_put(rpvdev, c);
+        if (!wait)
+            tx_arm(rpvdev, ept);
+        return NULL;
+    }
+    tx_account_delay(rpvdev, &req, &start);
+
+    if (size)
+        *size = RPMSG_BUFFER_SIZE - sizeof(struct rpmsg_vdev_hdr);
+
+    return (struct rpmsg_vdev_hdr *)req.buf + 1;
+}
+
+int rpmsg_vdev_sendto_nocopy(struct rpmsg_endpoint *ept, void *data, int len, uint32_t dst)
+{
+    struct rpmsg_vdev *rpvdev;
+    struct tx_req req;
+    int ret;
+
+    if (!ept || !ept->rdev || !data)
+        return RPMSG_ERR_PARAM;
+    if ((len < 0) || ((size_t)len > RPMSG_BUFFER_SIZE - sizeof(struct rpmsg_vdev_hdr)))
+        return RPMSG_ERR_BUFF_SIZE;
+    rpvdev = rpmsg_vdev_from_rdev(ept->rdev);
+
+    tx_req_init(rpvdev, &req, TX_OP_SEND, ept->addr, dst, NULL, len, (struct rpmsg_vdev_hdr *)data - 1);
+    ret = rpmsg_txq_submit(&rpvdev->txq, &req.node);
+    if (ret >= 0) {
+        tx_account(rpvdev, ept->addr, len);
+    } else {
+        /* The drainer took the buffer back, its credit goes back too */
+        credit_put(rpvdev, credit_find(rpvdev, ept->addr));
+    }
+
+    return ret;
+}
+
+int rpmsg_vdev_send_nocopy(struct rpmsg_endpoint *ept, void *data, int len)
+{
+    if (!ept)
+        return RPMSG_ERR_PARAM;
+
+    return rpmsg_vdev_sendto_nocopy(ept, data, len, ept->dest_addr);
+}
+
+/* Copy the pieces of a message one after the other */
+static void iov_gather(unsigned char *buf, const struct iovec *iov, int iovcnt)
+{
+    int i;
+
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(buf, iov[i].iov_base, iov[i].iov_len);
+        buf += iov[i].iov_len;
+    }
+}
+
+int rpmsg_vdev_sendtov(struct rpmsg_endpoint *ept, const struct iovec *iov, int iovcnt, uint32_t dst)
+{
+    unsigned char local[RPMSG_BUFFER_SIZE - sizeof(struct rpmsg_vdev_hdr)];
+    unsigned char *buf;
+    size_t len = 0U;
+    int i;
+
+    if (!ept || !ept->rdev || (iovcnt < 0) || (!iov && iovcnt))
+        return RPMSG_ERR_PARAM;
+    for (i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+        if (len > sizeof(local))
+            return RPMSG_ERR_BUFF_SIZE;
+    }
+
+    /* A virtio slave cannot take a TX buffer, its pieces are assembled here */
+    if (rpmsg_vdev_from_rdev(ept->rdev)->rvdev.vdev->role != VIRTIO_DEV_MASTER) {
+        iov_gather(local, iov, iovcnt);
+        return rpmsg_sendto(ept, local, (int)len, dst);
+    }
+
+    buf = rpmsg_vdev_get_tx_buffer(ept, NULL, 1);
+    if (!buf)
+        return RPMSG_ERR_NO_BUFF;
+    iov_gather(buf, iov, iovcnt);
+
+    return rpmsg_vdev_sendto_nocopy(ept, buf, (int)len, dst);
+}
+
+int rpmsg_vdev_sendv(struct rpmsg_endpoint *ept, const struct iovec *iov, int iovcnt)
+{
+    if (!ept)
+        return RPMSG_ERR_PARAM;
+
+    return rpmsg_vdev_sendtov(ept, iov, iovcnt, ept->dest_addr);
+}
+
+void rpmsg_vdev_release_tx_buffer(struct rpmsg_endpoint *ept, void *data)
+{
+    struct rpmsg_vdev *rpvdev;
+    struct tx_req req;
+
+    if (!ept || !ept->rdev || !data)
+        return;
+    rpvdev = rpmsg_vdev_from_rdev(ept->rdev);
+
+    tx_req_init(rpvdev, &req, TX_OP_PUT, 0U, 0U, NULL, 0, (struct rpmsg_vdev_hdr *)data - 1);
+    (void)rpmsg_txq_submit(&rpvdev->txq, &req.node);
+    credit_put(rpvdev, credit_find(rpvdev, ept->addr));
+}
+
+int rpmsg_vdev_credit_enable(struct rpmsg_endpoint *ept, unsigned int window)
+{
+    struct rpmsg_vdev *rpvdev;
+    struct rpmsg_vdev_credit *c;
+    unsigned int i;
+
+    if (!ept || !ept->rdev)
+        return RPMSG_ERR_PARAM;
+    rpvdev = rpmsg_vdev_from_rdev(ept->rdev);
+    /* Credits are piggybacked by the TX drainer, which only the master has */
+    if (rpvdev->rvdev.vdev->role != VIRTIO_DEV_MASTER)
+        return RPMSG_ERR_PARAM;
+    if (!window)
+        window = rpvdev->rvdev.svq->vq_nentries / RPMSG_VDEV_CREDIT_EPT_MAX;
+    if (!window)
+        window = 1U;
+
+    /* Writers are serialized by tx_lock, senders and the RX path look up without it */
+    pthread_mutex_lock(&rpvdev->tx_lock);
+    c = credit_find(rpvdev, ept->addr);
+    for (i = 0; !c && (i < RPMSG_VDEV_CREDIT_EPT_MAX); i++) {
+        if (!rpvdev->credit[i].window) {
+            c = &rpvdev->credit[i];
+            c->addr = ept->addr;
+            c->dst = ept->dest_addr;
+            c->tx = window;
+            c->grant = 0U;
+            __atomic_store_n(&c->window, window, __ATOMIC_RELEASE);
+            __atomic_add_fetch(&rpvdev->credit_num, 1U, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&rpvdev->tx_lock);
+
+    return c ? 0 : RPMSG_ERR_NO_MEM;
+}
+
+void rpmsg_vdev_credit_disable(struct rpmsg_endpoint *ept)
+{
+    struct rpmsg_vdev *rpvdev;
+    struct rpmsg_vdev_credit *c;
+
+    if (!ept || !ept->rdev)
+        return;
+    rpvdev = rpmsg_vdev_from_rdev(ept->rdev);
+
+    pthread_mutex_lock(&rpvdev->tx_lock);
+    c = credit_find(rpvdev, ept->addr);
+    if (c) {
+        __atomic_store_n(&c->window, 0U, __ATOMIC_RELEASE);
+        __atomic_sub_fetch(&rpvdev->credit_num, 1U, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&rpvdev->tx_lock);
+}
+
+/* Queue a message for a pull endpoint. Returns 0 if the endpoint does not pull. */
+static int pull_enqueue(struct rpmsg_vdev *rpvdev, struct rpmsg_endpoint *ept, struct rpmsg_vdev_hdr *hdr)
+{
+    struct rpmsg_vdev_pullq *q;
+    unsigned int i;
+    int ret = 0;
+
+    if (!__atomic_load_n(&rpvdev->pull_num, __ATOMIC_ACQUIRE))
+        return 0;
+
+    pthread_mutex_lock(&rpvdev->rx_lock);
+    for (i = 0; i < RPMSG_VDEV_PULL_MAX; i++) {
+        q = &rpvdev->pullq[i];
+        if ((q->ept == ept) && (q->count < q->size)) {
+            q->hdr[(q->head + q->count) % q->size] = hdr;
+            q->count++;
+            if (rpvdev->rx_waiters)
+                pthread_cond_broadcast(&rpvdev->rx_cond);
+            ret = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&rpvdev->rx_lock);
+
+    return ret;
+}
+
+/*
+ * Deliver one received message to its endpoint. Returns 1 if the buffer
+ * was handed over to a worker or a pull queue, which give it back later.
+ */
+static int rx_dispatch(struct rpmsg_vdev *rpvdev, struct rpmsg_vdev_hdr *hdr)
+{
+    struct rpmsg_device *rdev = &rpvdev->rvdev.rdev;
+    struct rpmsg_endpoint *ept;
+    struct rpmsg_workers *workers;
+    struct rpmsg_vdev_credit *c;
+
+    if (hdr->flags & RPMSG_VDEV_HDR_CREDIT) {
+        c = credit_find(rpvdev, hdr->dst);
+        if (c && hdr->reserved) {
+            __atomic_add_fetch(&c->tx, hdr->reserved, __ATOMIC_RELEASE);
+            tx_wake(rpvdev);
+        }
+        /* An empty message only carries credits */
+        if (!hdr->len)
+            return 0;
+    }
+
+    metal_mutex_acquire(&rdev->lock);
+    ept = ept_from_addr(rdev, hdr->dst);
+    metal_mutex_release(&rdev->lock);
+
+    rpmsg_stats_inc(rpvdev->stats, RPMSG_STATS_RX_MSGS);
+    rpmsg_stats_add(rpvdev->stats, RPMSG_STATS_RX_BYTES, hdr->len);
+
+    if (!ept)
+        return 0;
+
+    if (ept->dest_addr == RPMSG_ADDR_ANY) {
+        /* First message from the remote side, update the destination address */
+        ept->dest_addr = hdr->src;
+    }
+    if (rpvdev->stats) {
+        struct rpmsg_stats_ept *sept = rpmsg_stats_ept_get(rpvdev->stats, ept->addr, ept->name);
+
+        ept_stats_cache(rpvdev, ept->addr, sept);
+        rpmsg_stats_ept_add(sept, RPMSG_STATS_EPT_RX_MSGS, 1U);
+        rpmsg_stats_ept_add(sept, RPMSG_STATS_EPT_RX_BYTES, hdr->len);
+    }
+
+    if (pull_enqueue(rpvdev, ept, hdr))
+        return 1;
+    if (!ept->cb)
+        return 0;
+
+    workers = __atomic_load_n(&rpvdev->workers, __ATOMIC_ACQUIRE);
+    if (workers) {
+        rpmsg_workers_submit(workers, ept, hdr);
+        return 1;
+    }
+    (void)ept->cb(ept, (void *)(hdr + 1), hdr->len, hdr->src, ept->priv);
+
+    return 0;
+}
+
+/*
+ * Count the released messages of flow controlled endpoints as credits owed
+ * to their senders; credit updates themselves are not. Returns whether any
+ * was counted. Must run before the buffers go back to the remote.
+ */
+static int credit_consumed(struct rpmsg_vdev *rpvdev, struct rpmsg_vdev_hdr **hdrs, unsigned int n)
+{
+    struct rpmsg_vdev_credit *c;
+    unsigned int i;
+    int owed = 0;
+
+    if (!__atomic_load_n(&rpvdev->credit_num, __ATOMIC_ACQUIRE))
+        return 0;
+
+    for (i = 0; i < n; i++) {
+        if ((hdrs[i]->flags & RPMSG_VDEV_HDR_CREDIT) && !hdrs[i]->len)
+            continue;
+        c = credit_find(rpvdev, hdrs[i]->dst);
+        if (c) {
+            __atomic_store_n(&c->dst, hdrs[i]->src, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&c->grant, 1U, __ATOMIC_RELEASE);
+            owed = 1;
+        }
+    }
+
+    return owed;
+}
+
+void rpmsg_vdev_rx_release(struct rpmsg_vdev *rpvdev, struct rpmsg_vdev_hdr **hdrs, unsigned int n)
+{
+    struct rpmsg_device *rdev = &rpvdev->rvdev.rdev;
+    struct virtqueue_buf vqbuf;
+    unsigned int i;
+    int owed;
+
+    if (!n)
+        return;
+    owed = credit_consumed(rpvdev, hdrs, n);
+
+    /* Return the buffers to the remote side, one notification for all */
+    metal_mutex_acquire(&rdev->lock);
+    for (i = 0; i < n; i++) {
+        vqbuf.buf = hdrs[i];
+        vqbuf.len = RPMSG_BUFFER_SIZE;
+        (void)virtqueue_add_buffer(rpvdev->rvdev.rvq, &vqbuf, 0, 1, hdrs[i]);
+    }
+    virtqueue_kick(rpvdev->rvdev.rvq);
+    metal_mutex_release(&rdev->lock);
+
+    if (owed)
+        credit_flush(rpvdev);
+}
+
+/* Take and deliver up to budget messages. Called with rx_poll_lock held. */
+static unsigned int rx_poll_locked(struct rpmsg_vdev *rpvdev, unsigned int budget)
+{
+    struct virtqueue *vq = rpvdev->rvdev.rvq;
+    struct rpmsg_device *rdev = &rpvdev->rvdev.rdev;
+    struct rpmsg_vdev_hdr *batch[RPMSG_VDEV_RX_BUDGET];
+    unsigned int i, n, max, ret;
+    unsigned int done = 0U;
+    uint32_t len;
+    uint16_t idx;
+
+    do {
+        max = budget - done;
+        if (max > RPMSG_VDEV_RX_BUDGET)
+            max = RPMSG_VDEV_RX_BUDGET;
+
+        metal_mutex_acquire(&rdev->lock);
+        for (n = 0; n < max; n++) {
+            batch[n] = virtqueue_get_buffer(vq, &len, &idx);
+            if (!batch[n])
+                break;
+        }
+        metal_mutex_release(&rdev->lock);
+        if (!n)
+            break;
+
+        /* Buffers held by workers are given back by them */
+        for (i = 0, ret = 0; i < n; i++) {
+            if (!rx_dispatch(rpvdev, batch[i]))
+                batch[ret++] = batch[i];
+        }
+        rpmsg_vdev_rx_release(rpvdev, batch, ret);
+
+        rpmsg_stats_observe(rpvdev->stats, RPMSG_STATS_HIST_RX_BATCH, n);
+        done += n;
+    } while ((n == max) && (done < budget));
+
+    return done;
+}
+
+unsigned int rpmsg_vdev_rx_poll(struct rpmsg_vdev *rpvdev, unsigned int budget)
+{
+    unsigned int n;
+
+    pthread_mutex_lock(&rpvdev->rx_poll_lock);
+    n = rx_poll_locked(rpvdev, budget);
+    pthread_mutex_unlock(&rpvdev->rx_poll_lock);
+
+    return n;
+}
+
+int rpmsg_vdev_rx_poll_wait(struct rpmsg_vdev *rpvdev, const struct timespec *until)
+{
+    unsigned int seq, n;
+
+    if (!rpvdev || !until || (rpvdev->rvdev.vdev->role != VIRTIO_DEV_MASTER))
+        return RPMSG_ERR_PARAM;
+
+    seq = __atomic_load_n(&rpvdev->tx_seq, __ATOMIC_SEQ_CST);
+    if (pthread_mutex_trylock(&rpvdev->rx_poll_lock))
+        return -EBUSY;
+    n = rx_poll_locked(rpvdev, UINT_MAX);
+    pthread_mutex_unlock(&rpvdev->rx_poll_lock);
+    if (n)
+        return (int)n;
+
+    if (__atomic_load_n(&rpvdev->busy_poll, __ATOMIC_RELAXED)) {
+        (void)busy_wait(rpvdev, rx_pending, until);
+        return 0;
+    }
+    /* Same wake-up as rpmsg_vdev_recv_batch() */
+    pthread_mutex_lock(&rpvdev->rx_lock);
+    __atomic_add_fetch(&rpvdev->rx_waiters, 1U, __ATOMIC_SEQ_CST);
+    while (seq == __atomic_load_n(&rpvdev->tx_seq, __ATOMIC_SEQ_CST)) {
+        if (pthread_cond_timedwait(&rpvdev->rx_cond, &rpvdev->rx_lock, until) == ETIMEDOUT)
+            break;
+    }
+    __atomic_sub_fetch(&rpvdev->rx_waiters, 1U, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&rpvdev->rx_lock);
+
+    return 0;
+}
+
+int rpmsg_vdev_set_busy_poll(struct rpmsg_vdev *rpvdev, int on)
+{
+    struct rpmsg_virtio_device *rvdev;
+
+    if (!rpvdev || (rpvdev->rvdev.vdev->role != VIRTIO_DEV_MASTER))
+        return RPMSG_ERR_PARAM;
+    rvdev = &rpvdev->rvdev;
+
+    metal_mutex_acquire(&rvdev->rdev.lock);
+    if (on) {
+        virtqueue_disable_cb(rvdev->rvq);
+        virtqueue_disable_cb(rvdev->svq);
+    } else {
+        (void)virtqueue_enable_cb(rvdev->rvq);
+        (void)virtqueue_enable_cb(rvdev->svq);
+    }
+    metal_mutex_release(&rvdev->rdev.lock);
+    __atomic_store_n(&rpvdev->busy_poll, !!on, __ATOMIC_SEQ_CST);
+
+    if (!on) {
+        /* Nothing rings for what came in while the doorbell was off */
+        (void)rpmsg_vdev_rx_poll(rpvdev, UINT_MAX);
+        rpmsg_vdev_notified(rpvdev);
+    }
+
+    return 0;
+}
+
+int rpmsg_vdev_pending(struct rpmsg_vdev *rpvdev)
+{
+    return rx_pending(rpvdev) ||
+           (__atomic_load_n(&rpvdev->tx_waiters, __ATOMIC_RELAXED) && tx_space(rpvdev));
+}
+
+static struct rpmsg_vdev_pullq *pullq_find(struct rpmsg_vdev *rpvdev, struct rpmsg_endpoint *ept)
+{
+    unsigned int i;
+
+    for (i = 0; i < RPMSG_VDEV_PULL_MAX; i++) {
+        if (rpvdev->pullq[i].ept == ept)
+            return &rpvdev->pullq[i];
+    }
+
+    return NULL;
+}
+
+int rpmsg_vdev_pull_enable(struct rpmsg_endpoint *ept)
+{
+    struct rpmsg_vdev *rpvdev;
+    struct rpmsg_vdev_pullq *q;
+    struct rpmsg_vdev_hdr **hdr;
+    unsigned int size;
+
+    if (!ept || !ept->rdev)
+        return RPMSG_ERR_PARAM;
+    rpvdev = rpmsg_vdev_from_rdev(ept->rdev);
+    /* Received messages only go through rx_dispatch() on the virtio master */
+    if (rpvdev->rvdev.vdev->role != VIRTIO_DEV_MASTER)
+        return RPMSG_ERR_PARAM;
+    size = rpvdev->rvdev.rvq->vq_nentries;
+    hdr = calloc(size, sizeof(*hdr));
+    if (!hdr)
+        return RPMSG_ERR_NO_MEM;
+
+    pthread_mutex_lock(&rpvdev->rx_lock);
+    q = pullq_find(rpvdev, ept);
+    if (!q) {
+        q = pullq_find(rpvdev, NULL);
+        if (q) {
+            q->hdr = hdr;
+            q->size = size;
+            q->head = 0U;
+            q->count = 0U;
+            q->ept = ept;
+            hdr = NULL;
+            __atomic_add_fetch(&rpvdev->pull_num, 1U, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&rpvdev->rx_lock);
+
+    /* Not NULL if the endpoint already pulls or no queue was free */
+    free(hdr);
+
+    return q ? 0 : RPMSG_ERR_NO_MEM;
+}
+
+static void pull_drop(struct rpmsg_vdev *rpvdev, struct rpmsg_endpoint *ept)
+{
+    struct rpmsg_vdev_pullq *q;
+    struct rpmsg_vdev_pullq drop = { 0 };
+    unsigned int n;
+
+    pthread_mutex_lock(&rpvdev->rx_lock);
+    q = pullq_find(rpvdev, ept);
+    if (q) {
+        drop = *q;
+        memset(q, 0, sizeof(*q));
+        __atomic_sub_fetch(&rpvdev->pull_num, 1U, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&rpvdev->rx_lock);
+
+    if (!drop.hdr)
+        return;
+    /* Queued buffers go back to the remote, the ring may wrap around */
+    n = drop.size - drop.head;
+    if (n > drop.count)
+        n = drop.count;
+    if (n)
+        rpmsg_vdev_rx_release(rpvdev, &drop.hdr[drop.head], n);
+    if (drop.count > n)
+        rpmsg_vdev_rx_release(rpvdev, drop.hdr, drop.count - n);
+    free(drop.hdr);
+}
+
+void rpmsg_vdev_pull_disable(struct rpmsg_endpoint *ept)
+{
+    if (ept && ept->rdev)
+        pull_drop(rpmsg_vdev_from_rdev(ept->rdev), ept);
+}
+
+/* Take up to max queued messages. Called with rx_lock held. */
+static unsigned int pullq_take(struct rpmsg_vdev_pullq *q, struct rpmsg_vdev_msg *msgs, unsigned int max)
+{
+    struct rpmsg_vdev_hdr *hdr;
+    unsigned int n = 0;
+
+    while ((n < max) && q->count) {
+        hdr = q->hdr[q->head];
+        q->head = (q->head + 1U) % q->size;
+        q->count--;
+        msgs[n].data = (void *)(hdr + 1);
+        msgs[n].len = hdr->len;
+        msgs[n].src = hdr->src;
+        msgs[n].buf = hdr;
+        n++;
+    }
+
+    return n;
+}
+
+/*
+ * The receiver only sleeps when its queue is empty after it took the
+ * pending buffers from the vring itself. rx_poll_lock is only tried: if
+ * another thread holds it, that thread dispatches the buffers and queues
+ * ours, which wakes us up through rx_cond. The notification sequence is
+ * sampled before, so a notification during the harvest is not lost.
+ */
+int rpmsg_vdev_recv_batch(struct rpmsg_endpoint *ept, struct rpmsg_vdev_msg *msgs,
+                          unsigned int max, int timeout_ms)
+{
+    struct rpmsg_vdev *rpvdev;
+    struct rpmsg_vdev_pullq *q;
+    struct timespec now, deadline, until;
+    unsigned int seq, n;
+
+    if (!ept || !ept->rdev || !msgs || !max)
+        return RPMSG_ERR_PARAM;
+    rpvdev = rpmsg_vdev_from_rdev(ept->rdev);
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &deadline);
+    if (timeout_ms > 0)
+        timespec_add_ms(&deadline, (unsigned int)timeout_ms);
+
+    pthread_mutex_lock(&rpvdev->rx_lock);
+    __atomic_add_fetch(&rpvdev->rx_waiters, 1U, __ATOMIC_SEQ_CST);
+    for (;;) {
+        q = pullq_find(rpvdev, ept);
+        if (!q) {
+            n = 0;
+            break;
+        }
+        n = pullq_take(q, msgs, max);
+        if (n)
+            break;
+
+        seq = __atomic_load_n(&rpvdev->tx_seq, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&rpvdev->rx_lock);
+        if (!pthread_mutex_trylock(&rpvdev->rx_poll_lock)) {
+            (void)rx_poll_locked(rpvdev, UINT_MAX);
+            pthread_mutex_unlock(&rpvdev->rx_poll_lock);
+        }
+        pthread_mutex_lock(&rpvdev->rx_lock);
+        if (q->ept != ept)
+            continue;
+        n = pullq_take(q, msgs, max);
+        if (n)
+            break;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &now);
+        if ((timeout_ms >= 0) && !timespec_before(&now, &deadline))
+            break;
+        until = now;
+        timespec_add_ms(&until, RPMSG_VDEV_TX_RECHECK_MS);
+        if ((timeout_ms >= 0) && timespec_before(&deadline, &until))
+            until = deadline;
+        if (__atomic_load_n(&rpvdev->busy_poll, __ATOMIC_RELAXED)) {
+            pthread_mutex_unlock(&rpvdev->rx_lock);
+            (void)busy_wait(rpvdev, rx_pending, &until);
+            pthread_mutex_lock(&rpvdev->rx_lock);
+            continue;
+        }
+        while (!q->count && (seq == __atomic_load_n(&rpvdev->tx_seq, __ATOMIC_SEQ_CST))) {
+            if (pthread_cond_timedwait(&rpvdev->rx_cond, &rpvdev->rx_lock, &until) == ETIMEDOUT)
+                break;
+        }
+    }
+    __atomic_sub_fetch(&rpvdev->rx_waiters, 1U, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&rpvdev->rx_lock);
+
+    return q ? (int)n : RPMSG_ERR_PARAM;
+}
+
+void rpmsg_vdev_recv_release(struct rpmsg_endpoint *ept, struct rpmsg_vdev_msg *msgs, unsigned int n)
+{
+    struct rpmsg_vdev_hdr *hdrs[RPMSG_VDEV_RX_BUDGET];
+    unsigned int i, num;
+
+    if (!ept || !ept->rdev || !msgs)
+        return;
+
+    while (n) {
+        num = (n < RPMSG_VDEV_RX_BUDGET) ? n : RPMSG_VDEV_RX_BUDGET;
+        for (i = 0; i < num; i++)
+            hdrs[i] = msgs[i].buf;
+        rpmsg_vdev_rx_release(rpmsg_vdev_from_rdev(ept->rdev), hdrs, num);
+        msgs += num;
+        n -= num;
+    }
+}
+
+int rpmsg_vdev_recv(struct rpmsg_endpoint *ept, void *data, size_t size, uint32_t *src, int timeout_ms)
+{
+    struct rpmsg_vdev_msg msg;
+    int ret;
+
+    ret = rpmsg_vdev_recv_batch(ept, &msg, 1U, timeout_ms);
+    if (ret <= 0)
+        return ret;
+
+    memcpy(data, msg.data, (msg.len < size) ? msg.len : size);
+    if (src)
+        *src = msg.src;
+    rpmsg_vdev_recv_release(ept, &msg, 1U);
+
+    return (int)msg.len;
+}
+
+/*
+ * RX virtqueue callback. Drains the ring, unless the device is serviced by
+ * a poller, which then gets it scheduled instead.
+ */
+static void rpmsg_vdev_rx_callback(struct virtqueue *vq)
+{
+    struct rpmsg_virtio_device *rvdev = vq->vq_dev->priv;
+    struct rpmsg_vdev *rpvdev = metal_container_of(rvdev, struct rpmsg_vdev, rvdev);
+
+    if (__atomic_load_n(&rpvdev->poller, __ATOMIC_ACQUIRE))
+        rpmsg_poller_schedule(rpvdev);
+    else
+        (void)rpmsg_vdev_rx_poll(rpvdev, UINT_MAX);
+}
+
+int rpmsg_vdev_setup(struct rpmsg_vdev *rpvdev, struct rpmsg_stats_channel *stats)
+{
+    struct rpmsg_virtio_device *rvdev = &rpvdev->rvdev;
+    pthread_condattr_t attr;
+
+    rpvdev->tx_spare = NULL;
+    if (rvdev->vdev->role == VIRTIO_DEV_MASTER) {
+        /* Can hold every TX buffer: tx_drain() puts back the ones it could not send */
+        rpvdev->tx_spare = calloc(rvdev->svq->vq_nentries, sizeof(void *));
+        if (!rpvdev->tx_spare)
+            return RPMSG_ERR_NO_MEM;
+    }
+
+    rpvdev->stats = stats;
+    memset(rpvdev->ept_stats, 0, sizeof(rpvdev->ept_stats));
+
+    pthread_mutex_init(&rpvdev->tx_lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&rpvdev->tx_cond, &attr);
+    pthread_mutex_init(&rpvdev->rx_poll_lock, NULL);
+    pthread_mutex_init(&rpvdev->rx_lock, NULL);
+    pthread_cond_init(&rpvdev->rx_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    rpvdev->rx_waiters = 0U;
+    memset(rpvdev->pullq, 0, sizeof(rpvdev->pullq));
+    rpvdev->pull_num = 0U;
+    rpvdev->tx_seq = 0U;
+    rpvdev->tx_waiters = 0U;
+    memset(rpvdev->tx_ready, 0, sizeof(rpvdev->tx_ready));
+    rpvdev->tx_armed = 0U;
+    rpvdev->tx_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    rpmsg_txq_init(&rpvdev->txq, tx_drain, rpvdev);
+    rpvdev->tx_spare_num = 0U;
+    rpvdev->tx_held = 0U;
+    memset(rpvdev->tx_class, 0, sizeof(rpvdev->tx_class));
+    metal_list_init(&rpvdev->tx_wait_list);
+    rpvdev->tx_wait_seq = 0U;
+    memset(rpvdev->credit, 0, sizeof(rpvdev->credit));
+    rpvdev->credit_num = 0U;
+    rpvdev->poller = NULL;
+    rpvdev->poller_index = 0U;
+    rpvdev->workers = NULL;
+    rpvdev->busy_poll = 0;
+
+    rpvdev->send_offchannel_raw = rvdev->rdev.ops.send_offchannel_raw;
+    rvdev->rdev.ops.send_offchannel_raw = rpmsg_vdev_send_offchannel_raw;
+
+    /* Only the virtio master owns the RX buffers it gives back */
+    if (rvdev->vdev->role == VIRTIO_DEV_MASTER) {
+        rvdev->rvq->callback = rpmsg_vdev_rx_callback;
+        rvdev->svq->callback = rpmsg_vdev_tx_callback;
+    }
+
+    return 0;
+}
+
+void rpmsg_vdev_cleanup(struct rpmsg_vdev *rpvdev)
+{
+    unsigned int i;
+
+    /* Held RX buffers go back before the device is torn down */
+    rpmsg_workers_stop(&rpvdev->rvdev.rdev);
+    for (i = 0; i < RPMSG_VDEV_PULL_MAX; i++) {
+        if (rpvdev->pullq[i].ept)
+            pull_drop(rpvdev, rpvdev->pullq[i].ept);
+    }
+    if (rpvdev->tx_fd >= 0) {
+        (void)close(rpvdev->tx_fd);
+        rpvdev->tx_fd = -1;
+    }
+    free(rpvdev->tx_spare);
+    rpvdev->tx_spare = NULL;
+    pthread_cond_destroy(&rpvdev->rx_cond);
+    pthread_mutex_destroy(&rpvdev->rx_lock);
+    pthread_mutex_destroy(&rpvdev->rx_poll_lock);
+    pthread_cond_destroy(&rpvdev->tx_cond);
+    pthread_mutex_destroy(&rpvdev->tx_lock);
+}
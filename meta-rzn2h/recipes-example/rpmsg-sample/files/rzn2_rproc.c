@@ -30,6 +30,7 @@
 #include <metal/utilities.h>
 #include <openamp/rpmsg_virtio.h>
 #include "platform_info.h"
+#include "rpmsg_vdev.h"
 
 extern struct ipi_info ipi;
 extern struct shm_info shm;
@@ -95,25 +96,96 @@ err:
     return ret;
 }
 
+/*
+ * Decode the notification word of the remote into notify id bits, 0 if it
+ * is invalid or counts nothing new. In the counting format these are the
+ * ids whose count moved since the word in *seen, which takes val; the
+ * legacy format (notify_id of the sender) checks all.
+ */
+static uint32_t notify_bits(uint32_t *seen, uint32_t val)
+{
+    uint32_t moved;
+    uint32_t bits = 0U;
+    unsigned int id;
+
+    if (val & NOTIFY_COUNT_FLAG) {
+        moved = val ^ *seen;
+        *seen = val;
+        for (id = 0U; id < NOTIFY_COUNT_IDS; id++) {
+            if (moved & NOTIFY_COUNT_FIELD(id))
+                bits |= 1U << id;
+        }
+        return bits;
+    }
+
+    return (val < RPVDEV_MAX_NUM) ? NOTIFY_CHECK_ALL : 0U;
+}
+
+/*
+ * Count a notification of notify id @id in the word of ours, 0 to send the
+ * legacy format instead. Each field wraps on its own.
+ */
+static uint32_t notify_count(uint32_t *sent, uint32_t id)
+{
+    uint32_t old = __atomic_load_n(sent, __ATOMIC_RELAXED);
+    uint32_t val;
+
+    if (!old || (id >= NOTIFY_COUNT_IDS))
+        return 0U;
+    do {
+        val = (old & ~NOTIFY_COUNT_FIELD(id)) |
+              ((old + (1U << (id * NOTIFY_COUNT_BITS))) & NOTIFY_COUNT_FIELD(id));
+    } while (!__atomic_compare_exchange_n(sent, &old, val, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+    return val;
+}
+
+/*
+ * 1 with the latest word in *val if the word of ours moved on since *val:
+ * a concurrent notify may have written its word before the older *val.
+ */
+static int notify_count_stale(uint32_t *sent, uint32_t *val)
+{
+    uint32_t now = __atomic_load_n(sent, __ATOMIC_SEQ_CST);
+
+    if (now == *val)
+        return 0;
+    *val = now;
+    return 1;
+}
+
 static int rzn2_proc_irq_handler(int vect_id, void *data)
 {
     unsigned int val = 0U;
+    uint32_t bits;
+#ifdef __linux__
+    unsigned int i;
+#endif
 
     (void)vect_id;
     (void)data;
 
+    rpmsg_stats_inc(ipi.stats, RPMSG_STATS_IRQS);
+
     /* Get a message from the mailbox */
     val = metal_io_read32(shm.io, SHM_RX_OFFSET(MBX_RX_CH));
+    bits = notify_bits(&ipi.notify_seen, val);
 
-    if (val >= RPVDEV_MAX_NUM) { /* val should have the notify_id of the sender */
+    if (!bits) { /* val should have the notify_id of the sender or notify counts */
+        if (val & NOTIFY_COUNT_FLAG)
+            return METAL_IRQ_HANDLED; /* Counted in the word read for an earlier doorbell */
+        rpmsg_stats_inc(ipi.stats, RPMSG_STATS_IRQS_SPURIOUS);
         return METAL_IRQ_NOT_HANDLED; /* Invalid message arrived */
     }
 
 #ifdef __linux__
-    ipi.notify_id = val;
+    __atomic_fetch_or(&ipi.notify_mask, bits, __ATOMIC_SEQ_CST);
     atomic_flag_clear(&ipi.sync);
+    /* The vdevs of the channel share its interrupt */
+    for (i = 0; i < RSC_VDEV_NUM; i++)
+        rpmsg_vdev_notified(ipi.rpvdev[i]);
 #else /* uC3 */
-    if (ipi.ipi_sem_id[val] != E_ID) {
+    if ((val < RPVDEV_MAX_NUM) && (ipi.ipi_sem_id[val] != E_ID)) {
         isig_sem(ipi.ipi_sem_id[val]);
     }
     else
@@ -235,16 +307,68 @@ static void rzn2_proc_remove(struct remoteproc *rproc)
 static int rzn2_proc_notify(struct remoteproc *rproc, uint32_t id)
 {
     struct remoteproc_priv *prproc = rproc->priv;
-
-    /* Put a message saying "This is the notify_id of mine!" */
-    metal_io_write32(shm.io, SHM_TX_OFFSET(MBX_TX_CH), (uint64_t)prproc->notify_id);
+    uint32_t val;
+
+    val = notify_count(&ipi.notify_sent, id);
+    if (val) {
+        /* Count the notify id, leaving the word as the latest count */
+        do {
+            metal_io_write32(shm.io, SHM_TX_OFFSET(MBX_TX_CH), (uint64_t)val);
+        } while (notify_count_stale(&ipi.notify_sent, &val));
+    } else {
+        /* Put a message saying "This is the notify_id of mine!" */
+        metal_io_write32(shm.io, SHM_TX_OFFSET(MBX_TX_CH), (uint64_t)prproc->notify_id);
+    }
 
     /* Send notification */
     metal_io_write32_with_check(ipi.io, MBX_TX_OFFSET(MBX_TX_CH), MBX_TX_WRITE_VALUE(MBX_TX_CH));
+    rpmsg_stats_inc(prproc->stats, RPMSG_STATS_DOORBELLS);
+
+    return 0;
+}
+
+/*
+ * Event channels. A non-zero slot holds an event code not taken yet; the
+ * receiver clears it. SWINT has no status to read back, so the sender
+ * waits for its slot to be cleared.
+ */
+int platform_event_send(uint32_t code)
+{
+    int wait = 0;
+
+    if (!code || !ipi.io || !shm.io)
+        return -1;
+
+    /* Has the previous event been taken? */
+    while (0U != metal_io_read32(shm.io, SHM_TX_OFFSET(EVENT_TX_CH))) {
+        if ((wait++) > EVENT_SEND_WAIT) {
+            LPERROR("Event channel busy.");
+            return -1;
+        }
+    }
+
+    metal_io_write32(shm.io, SHM_TX_OFFSET(EVENT_TX_CH), (uint64_t)code);
+    metal_io_write32_with_check(ipi.io, MBX_TX_OFFSET(EVENT_TX_CH), MBX_TX_WRITE_VALUE(EVENT_TX_CH));
 
     return 0;
 }
 
+int platform_event_poll(uint32_t *code)
+{
+    uint32_t val;
+
+    if (!code || !shm.io)
+        return -1;
+
+    val = metal_io_read32(shm.io, SHM_RX_OFFSET(EVENT_RX_CH));
+    if (!val)
+        return 0;
+    metal_io_write32(shm.io, SHM_RX_OFFSET(EVENT_RX_CH), 0U);
+    *code = val;
+
+    return 1;
+}
+
 #ifdef __linux__
 /* Inline funciton to translate DDR address from CR space to CA space */
 static inline void rzn2_address_translate(metal_phys_addr_t *addr)
@@ -13,25 +13,35 @@
  *            Modification for OpenAMP 2018.10.
  *          - rev 1.2 (2020.10.27) Imada
  *            Added the license description.
+ *          - rev 1.3 (2026.10.18)
+ *            Added the IPC statistics export.
+ *          - rev 1.4 (2026.10.18)
+ *            Receive the echo with the pull API.
+ *          - rev 1.5 (2026.10.18)
+ *            Encode the echo payload with a fixed layout, in place.
+ *          - rev 1.6 (2026.10.18)
+ *            Added the broker mode (-b).
+ *          - rev 1.7 (2026.10.18)
+ *            Added the bridge mode (-s).
  ****************************************************************************
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
+#include <time.h>
 #include "metal/alloc.h"
 #include "openamp/open_amp.h"
 #include "platform_info.h"
 #include "rsc_table.h"
+#include "rpmsg_vdev.h"
+#include "rpmsg_msgs.h"
+#include "rpmsg_broker.h"
+#include "rpmsg_bridge.h"
 
 #define SHUTDOWN_MSG    (0xEF56A55A)
-
-/* Payload definition */
-struct _payload {
-    unsigned long num;
-    unsigned long size;
-    unsigned char data[];
-};
+#define RECV_TIMEOUT_MS (100)
 
 /* Payload information */
 struct payload_info {
@@ -45,18 +55,32 @@ static void rpmsg_service_bind(struct rpmsg_device *rdev, const char *name, uint
 static void rpmsg_service_unbind(struct rpmsg_endpoint *ept);
 static int rpmsg_service_cb0(struct rpmsg_endpoint *rp_ept, void *data, size_t len, uint32_t src, void *priv);
 static int payload_init(struct rpmsg_device *rdev, struct payload_info *pi);
+static int broker(struct rpmsg_device *rdev, unsigned long id);
+static int bridge(struct rpmsg_device *rdev, unsigned long id);
+static void serve_stop_handler(int signum);
 
 /* Globals */
 static struct rpmsg_endpoint rp_ept = { 0 };
-static struct _payload *i_payload;
-static int rnum = 0;
 static int err_cnt = 0;
 static char *svc_name = NULL;
+static int serve_mode = 0; /* 'b' broker, 's' bridge, 0 echo test */
+static int busy_poll = 0; /* -p: the echo test busy polls the vrings */
+static volatile int serve_stop = 0;
 
 /* External functions */
 extern void init_system();
 extern void cleanup_system();
 
+/* Microseconds elapsed since from */
+static uint64_t usec_since(const struct timespec *from)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)((now.tv_sec - from->tv_sec) * 1000000000LL +
+                      (now.tv_nsec - from->tv_nsec)) / 1000U;
+}
+
 /* Application entry point */
 int app (struct rpmsg_device *rdev, void *priv, unsigned long svcno)
 {
@@ -64,8 +88,15 @@ int app (struct rpmsg_device *rdev, void *priv, unsigned long svcno)
     int shutdown_msg = SHUTDOWN_MSG;
     int i;
     int size;
-    int expect_rnum = 0;
+    struct rpmsg_vdev_msg msg;
+    struct rpmsg_echo_hdr hdr;
+    void *buf;
+    size_t len;
     struct payload_info pi = { 0 };
+    struct rpmsg_vdev *rpvdev = rpmsg_vdev_from_rdev(rdev);
+    struct timespec sent;
+    uint64_t rtt, rtt_min = UINT64_MAX, rtt_max = 0U, rtt_sum = 0U;
+    unsigned int rtt_num = 0U;
 
     LPRINTF(" 1 - Send data to remote core, retrieve the echo");
     LPRINTF(" and validate its integrity ..\n");
@@ -96,41 +127,75 @@ int app (struct rpmsg_device *rdev, void *priv, unsigned long svcno)
         platform_poll(priv);
 
     LPRINTF("RPMSG service has created.\n");
+    if ((ret = rpmsg_vdev_pull_enable(&rp_ept))) {
+        LPERROR("Failed to enable the pull API.\n");
+        return ret;
+    }
+    /* Watch the vrings rather than wait for the doorbell */
+    if (busy_poll && rpmsg_vdev_set_busy_poll(rpvdev, 1)) {
+        LPERROR("Failed to enable busy polling.\n");
+    }
     for (i = 0, size = pi.min; i < (int)pi.num; i++, size++) {
-        i_payload->num = i;
-        i_payload->size = size;
-     
-        /* Mark the data buffer. */
-        memset(&(i_payload->data[0]), 0xA5, size);
-     
+        hdr.num = i;
+        hdr.size = size;
+
+        /* Encode the header and mark the data right in the TX buffer */
+        buf = rpmsg_vdev_get_tx_buffer(&rp_ept, NULL, 1);
+        if (!buf) {
+            LPRINTF("Error getting a TX buffer\n");
+            break;
+        }
+        len = rpmsg_echo_hdr_encode(&hdr, buf);
+        memset((unsigned char *)buf + len, 0xA5, size);
+
         LPRINTF("sending payload number %lu of size %lu\n",
-             i_payload->num, (2 * sizeof(unsigned long)) + size);
-		
-        ret = rpmsg_send(&rp_ept, i_payload,
-             (2 * sizeof(unsigned long)) + size);
+             (unsigned long)hdr.num, (unsigned long)(len + size));
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &sent);
+        ret = rpmsg_vdev_send_nocopy(&rp_ept, buf, (int)(len + size));
              
         if (ret < 0) {
             LPRINTF("Error sending data...%d\n", ret);
         break;
         }
-        LPRINTF("echo test: sent : %lu\n", (2 * sizeof(unsigned long)) + size);
      
-        expect_rnum++;
         do {
-            platform_poll(priv);
-        } while ((rnum < expect_rnum) && !err_cnt);
+            ret = rpmsg_vdev_recv_batch(&rp_ept, &msg, 1U, RECV_TIMEOUT_MS);
+        } while (!ret);
+        if (ret < 0) {
+            LPRINTF("Error receiving data...%d\n", ret);
+            break;
+        }
+        /* Round trip, taken before anything is printed */
+        rtt = usec_since(&sent);
+        rpmsg_stats_observe(rpvdev->stats, busy_poll ? RPMSG_STATS_HIST_ECHO_POLL_USEC :
+                            RPMSG_STATS_HIST_ECHO_IRQ_USEC, rtt);
+        rtt_min = (rtt < rtt_min) ? rtt : rtt_min;
+        rtt_max = (rtt > rtt_max) ? rtt : rtt_max;
+        rtt_sum += rtt;
+        rtt_num++;
+        LPRINTF("echo test: sent : %lu\n", (unsigned long)(len + size));
+        (void)rpmsg_service_cb0(&rp_ept, msg.data, msg.len, msg.src, NULL);
+        rpmsg_vdev_recv_release(&rp_ept, &msg, 1U);
         usleep(10000);
     }
 
     LPRINTF("************************************\n");
     LPRINTF(" Test Results: Error count = %d \n", err_cnt);
+    if (rtt_num) {
+        LPRINTF(" Round trip (%s): min %lu us, avg %lu us, max %lu us\n",
+                busy_poll ? "busy polling" : "doorbell", (unsigned long)rtt_min,
+                (unsigned long)(rtt_sum / rtt_num), (unsigned long)rtt_max);
+    }
     LPRINTF("************************************\n");
+    if (rpvdev->busy_poll)
+        (void)rpmsg_vdev_set_busy_poll(rpvdev, 0);
+    rpmsg_vdev_pull_disable(&rp_ept);
     /* Send shutdown message to remote */
     rpmsg_send(&rp_ept, &shutdown_msg, sizeof(int));
     sleep(1);
     LPRINTF("Quitting application .. Echo test end\n");
 
-    metal_free_memory(i_payload);
     return 0;
 }
 
@@ -164,26 +229,31 @@ static int rpmsg_service_cb0(struct rpmsg_endpoint *cb_rp_ept, void *data, size_
     (void)priv;
     int i;
     int ret = 0;
-    struct _payload *r_payload = (struct _payload *)data;
+    struct rpmsg_echo_hdr hdr;
+    const unsigned char *payload = (const unsigned char *)data + rpmsg_echo_hdr_wire_size;
 
+    if (!rpmsg_echo_hdr_decode(&hdr, data, len) || (len - rpmsg_echo_hdr_wire_size < hdr.size)) {
+        LPERROR(" Truncated payload is received.\n");
+        err_cnt++;
+        return -1;
+    }
     LPRINTF(" received payload number %lu of size %lu \r\n",
-    r_payload->num, len);
+    (unsigned long)hdr.num, (unsigned long)len);
 
-    if (r_payload->size == 0) {
+    if (hdr.size == 0) {
         LPERROR(" Invalid size of package is received.\n");
         err_cnt++;
         return -1;
     }
     /* Validate data buffer integrity. */
-    for (i = 0; i < (int)r_payload->size; i++) {
-        if (r_payload->data[i] != 0xA5) {
+    for (i = 0; i < (int)hdr.size; i++) {
+        if (payload[i] != 0xA5) {
             LPRINTF("Data corruption at index %d\n", i);
             err_cnt++;
             ret = -1;
             break;
         }
     }
-    rnum = r_payload->num + 1;
     return ret;
 }
 
@@ -199,28 +269,75 @@ static int payload_init(struct rpmsg_device *rdev, struct payload_info *pi) {
     pi->max = rpmsg_buf_size - 24;
     pi->num = pi->max / pi->min;
 
-    i_payload =
-        (struct _payload *)metal_allocate_memory(2 * sizeof(unsigned long) +
-                      pi->max);
-    if (!i_payload) {
-        LPERROR("memory allocation failed.\n");
-        return -ENOMEM;
-    }
-
     return 0;
 }
 
+/* Serve the rpmsg device to other processes until SIGINT or SIGTERM */
+static int broker(struct rpmsg_device *rdev, unsigned long id)
+{
+    char path[64];
+
+    (void)signal(SIGINT, serve_stop_handler);
+    (void)signal(SIGTERM, serve_stop_handler);
+
+    snprintf(path, sizeof(path), RPMSG_BROKER_PATH_FMT, id);
+    return rpmsg_broker_run(rdev, path, &serve_stop);
+}
+
+/* Expose the services of the rpmsg device as sockets until SIGINT or SIGTERM */
+static int bridge(struct rpmsg_device *rdev, unsigned long id)
+{
+    char dir[64];
+
+    (void)signal(SIGINT, serve_stop_handler);
+    (void)signal(SIGTERM, serve_stop_handler);
+
+    snprintf(dir, sizeof(dir), RPMSG_BRIDGE_DIR_FMT, id);
+    return rpmsg_bridge_run(rdev, dir, &serve_stop);
+}
+
+static void serve_stop_handler(int signum)
+{
+    (void)signum;
+    serve_stop = 1;
+}
+
 int main(int argc, char *argv[])
 {
     void *platform;
     struct rpmsg_device *rpdev;
+    rpmsg_ns_bind_cb ns_bind = rpmsg_service_bind;
     unsigned long proc_id = 0;
     unsigned long rsc_id = 0;
     int ret = 0;
 	
+    /* rpmsg_sample_client -p ...: the echo test busy polls the vrings */
+    if ((argc >= 2) && !strcmp(argv[1], "-p")) {
+        busy_poll = 1;
+        argc--;
+        argv++;
+    }
+
+    /* rpmsg_sample_client -b|-s <id>: serve the device to other processes */
+    if ((argc >= 2) && (!strcmp(argv[1], "-b") || !strcmp(argv[1], "-s"))) {
+        serve_mode = argv[1][1];
+        argc--;
+        argv++;
+    }
+
+    if (serve_mode == 'b')
+        ns_bind = rpmsg_broker_ns_bind;
+    else if (serve_mode == 's')
+        ns_bind = rpmsg_bridge_ns_bind;
+
     /* Initialize HW system components */
     init_system();
 
+    /* Export the IPC statistics (node_exporter textfile format) */
+    if (rpmsg_stats_start(RPMSG_STATS_PATH, RPMSG_STATS_PERIOD_MS)) {
+        LPERROR("Failed to start the statistics export.\n");
+    }
+
     if (argc >= 2) {
         proc_id = strtoul(argv[1], NULL, 0);
         rsc_id = proc_id;
@@ -235,12 +352,17 @@ int main(int argc, char *argv[])
         rpdev = platform_create_rpmsg_vdev(platform, 0,
                           VIRTIO_DEV_MASTER,
                           NULL,
-                          rpmsg_service_bind);
+                          ns_bind);
         if (!rpdev) {
             LPERROR("Failed to create rpmsg virtio device.\n");
             ret = -1;
         } else {
-            (void)app(rpdev, platform, proc_id);
+            if (serve_mode == 'b')
+                (void)broker(rpdev, proc_id);
+            else if (serve_mode == 's')
+                (void)bridge(rpdev, proc_id);
+            else
+                (void)app(rpdev, platform, proc_id);
             platform_release_rpmsg_vdev(platform, rpdev);
             ret = 0;
         }
@@ -249,6 +371,7 @@ int main(int argc, char *argv[])
     LPRINTF("Stopping application...\n");
     platform_cleanup(platform);
 
+    rpmsg_stats_stop();
     cleanup_system();
 
     return ret;
@@ -28,9 +28,11 @@
 #include <metal/device.h>
 #include <metal/irq.h>
 #include <metal/utilities.h>
+#include <openamp/remoteproc_virtio.h>
 #include <openamp/rpmsg_virtio.h>
 #include "platform_info.h"
 #include "rsc_table.h"
+#include "rpmsg_vdev.h"
 #ifdef __linux__
 #include <sched.h>
 #include <stddef.h>
@@ -58,9 +60,13 @@ struct ipi_info ipi = {
     0, // registered
     {0, 0}, // mbx_chn (not used on this SoC)
     0, // chn_mask (not used on this SoC)
+    NOTIFY_COUNT_FLAG, // notify_seen
+    0, // notify_sent
 #ifdef __linux__
     ATOMIC_FLAG_INIT, // sync
-    0, // notify_id
+    0, // notify_mask
+    NULL, // stats
+    {NULL}, // rpvdev
 #else /* uC3 */
     {E_ID, E_ID}, // ipi_sem_id
 #endif
@@ -129,18 +135,51 @@ struct shm_info shm = {
  * notification operation and remote processor managementi operations. */
 extern struct remoteproc_ops rzt2_proc_ops;
 
-/* RPMsg virtio shared buffer pool */
-static struct rpmsg_virtio_shm_pool shpool;
-
 #ifndef __linux__ /* uC3 */
 static void start_ipi_task(void *platform);
 #endif
 
 #ifdef __linux__
-static inline void virtio_clear_status(void *rsc_table) {
-    struct remote_resource_table *rt = (struct remote_resource_table *)rsc_table;
-    
-    rt->rpmsg_vdev.status = 0x0;
+/* Reset the status of a vdev entry of the resource table */
+static inline void virtio_clear_status(struct virtio_device *vdev) {
+    struct remoteproc_virtio *rpvdev = metal_container_of(vdev, struct remoteproc_virtio, vdev);
+    struct fw_rsc_vdev *vdev_rsc = rpvdev->vdev_rsc;
+
+    vdev_rsc->status = 0x0;
+
+    return ;
+}
+
+/* Warn about vrings of the remote resource table with fields of both cores in a cache line */
+static void vring_layout_check(struct virtio_device *vdev) {
+    struct remoteproc_virtio *rpvdev = metal_container_of(vdev, struct remoteproc_virtio, vdev);
+    struct fw_rsc_vdev *vdev_rsc = rpvdev->vdev_rsc;
+    struct fw_rsc_vdev_vring *vring;
+    unsigned int i;
+
+    for (i = 0; i < vdev_rsc->num_of_vrings; i++) {
+        vring = &vdev_rsc->vring[i];
+        if ((vring->da % VRING_CACHE_LINE) || (vring->align % VRING_CACHE_LINE))
+            LPRINTF("vring %u at 0x%x aligned on 0x%x shares cache lines between the cores\n",
+                    i, (unsigned int)vring->da, (unsigned int)vring->align);
+    }
+
+    return ;
+}
+
+/* Send the counting notification format if the remote offers it */
+static void notify_count_negotiate(struct virtio_device *vdev, struct ipi_info *pipi) {
+    struct remoteproc_virtio *rpvdev = metal_container_of(vdev, struct remoteproc_virtio, vdev);
+    struct fw_rsc_vdev *vdev_rsc = rpvdev->vdev_rsc;
+    uint32_t legacy = 0U;
+
+    if (!(vdev_rsc->dfeatures & (1U << RPMSG_F_NOTIFY_COUNT)))
+        return ;
+    /* After rpmsg_init_vdev(), which may write the features it takes */
+    vdev_rsc->gfeatures |= 1U << RPMSG_F_NOTIFY_COUNT;
+    if (__atomic_compare_exchange_n(&pipi->notify_sent, &legacy, NOTIFY_COUNT_FLAG, 0,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        LPRINTF("sending notifications in the counting format\n");
 
     return ;
 }
@@ -165,6 +204,7 @@ platform_create_proc(int proc_index, int rsc_index)
     }
     memset(rproc_priv, 0, sizeof(*rproc_priv));
     rproc_priv->notify_id = (unsigned int)proc_index;
+    rproc_priv->stats = rpmsg_stats_channel_get(RPMSG_REMOTE_NAME, (unsigned int)proc_index);
     rproc_priv->vr_info = &vrinfo[rsc_index];
 
     /* Allocate remoteproc instance */
@@ -224,7 +264,7 @@ platform_create_rpmsg_vdev(void *platform, unsigned int vdev_index,
 {
     struct remoteproc *rproc = platform;
     struct remoteproc_priv *prproc;
-    struct rpmsg_virtio_device *rpmsg_vdev;
+    struct rpmsg_vdev *rpmsg_vdev;
     struct virtio_device *vdev;
     struct metal_io_region *shbuf_io;
     metal_phys_addr_t pa;
@@ -236,6 +276,10 @@ platform_create_rpmsg_vdev(void *platform, unsigned int vdev_index,
     
     prproc = rproc->priv;
     
+    /* The resource table has RSC_VDEV_NUM vdev entries */
+    if (vdev_index >= RSC_VDEV_NUM)
+        return NULL;
+
     rpmsg_vdev = metal_allocate_memory(sizeof(*rpmsg_vdev));
     if (!rpmsg_vdev)
         return NULL;
@@ -247,6 +291,9 @@ platform_create_rpmsg_vdev(void *platform, unsigned int vdev_index,
         LPRINTF("failed remoteproc_create_virtio\n");
         goto err;
     }
+#ifdef __linux__
+    vring_layout_check(vdev);
+#endif
     
     pa = metal_io_phys(prproc->vr_info->shm.io, 0x0U);
     shbuf_io = remoteproc_get_io_with_pa(rproc, pa);
@@ -259,48 +306,111 @@ platform_create_rpmsg_vdev(void *platform, unsigned int vdev_index,
 #ifdef __linux__
     LPRINTF("initializing rpmsg shared buffer pool\n");
     shbuf = metal_io_phys_to_virt(shbuf_io, pa);
-    len = metal_io_region_size(prproc->vr_info->shm.io);
-    rpmsg_virtio_init_shm_pool(&shpool, shbuf, len);
+    /* Each vdev takes an equal share of the buffers */
+    len = metal_io_region_size(prproc->vr_info->shm.io) / RSC_VDEV_NUM;
+    len -= len % RPMSG_BUFFER_SIZE;
+    shbuf = (char *)shbuf + len * vdev_index;
+    rpmsg_virtio_init_shm_pool(&rpmsg_vdev->shpool, shbuf, len);
 #endif
 
     LPRINTF("initializing rpmsg vdev\n");
     /* RPMsg virtio slave can set shared buffers pool argument to NULL */
-    ret =  rpmsg_init_vdev(rpmsg_vdev, vdev, ns_bind_cb,
+    ret =  rpmsg_init_vdev(&rpmsg_vdev->rvdev, vdev, ns_bind_cb,
                    shbuf_io,
-                   &shpool);
+                   &rpmsg_vdev->shpool);
     if (ret) {
         LPRINTF("failed rpmsg_init_vdev\n");
         goto err;
     }
+    ret = rpmsg_vdev_setup(rpmsg_vdev, prproc->stats);
+    if (ret) {
+        LPRINTF("failed rpmsg_vdev_setup\n");
+        rpmsg_deinit_vdev(&rpmsg_vdev->rvdev);
+        goto err;
+    }
+#ifdef __linux__
+    /* The mailbox serves this channel from now on */
+    ipi.stats = prproc->stats;
+    ipi.rpvdev[vdev_index] = rpmsg_vdev;
+    notify_count_negotiate(vdev, &ipi);
+#endif
 
 #ifndef __linux__ /* uC3 */
     start_ipi_task(rproc);
 #endif
     
-    return rpmsg_virtio_get_rpmsg_device(rpmsg_vdev);
+    return rpmsg_virtio_get_rpmsg_device(&rpmsg_vdev->rvdev);
 err:
 #ifdef __linux__
-    virtio_clear_status(rproc->rsc_table);
+    if (vdev)
+        virtio_clear_status(vdev);
 #endif
     remoteproc_remove_virtio(rproc, vdev);
     metal_free_memory(rpmsg_vdev);
     return NULL;
 }
 
+#ifdef __linux__
+/* Process the virtqueues whose notify id bit is set in mask */
+static void process_notifications(struct remoteproc *rproc, uint32_t mask)
+{
+    uint32_t id;
+
+    if (mask & NOTIFY_CHECK_ALL) {
+        (void)remoteproc_get_notification(rproc, RSC_NOTIFY_ID_ANY);
+        return;
+    }
+    while (mask) {
+        id = (uint32_t)__builtin_ctz(mask);
+        mask &= mask - 1U;
+        (void)remoteproc_get_notification(rproc, id);
+    }
+}
+
+/*
+ * Busy polling: 1 if a device in busy polling mode has something pending
+ * in its vrings, 0 if not, -1 if none of the devices polls.
+ */
+static int vring_pending(struct rpmsg_vdev **rpvdev)
+{
+    unsigned int i;
+    int ret = -1;
+
+    for (i = 0; i < RSC_VDEV_NUM; i++) {
+        if (!rpvdev[i] || !__atomic_load_n(&rpvdev[i]->busy_poll, __ATOMIC_RELAXED))
+            continue;
+        if (rpmsg_vdev_pending(rpvdev[i]))
+            return 1;
+        ret = 0;
+    }
+
+    return ret;
+}
+#endif
+
 int platform_poll(void *priv)
 {
 #ifdef __linux__
     struct remoteproc *rproc = priv;
     unsigned int flags;
+    int pending;
 
     while(1) {
         flags = metal_irq_save_disable();
         if (!(atomic_flag_test_and_set(&ipi.sync))) {
             metal_irq_restore_enable(flags);
-            remoteproc_get_notification(rproc, RSC_NOTIFY_ID_ANY);
+            process_notifications(rproc, __atomic_exchange_n(&ipi.notify_mask, 0U, __ATOMIC_SEQ_CST));
             break;
         }
         metal_irq_restore_enable(flags);
+        /* Busy polling: watch the vrings rather than wait for the doorbell */
+        pending = vring_pending(ipi.rpvdev);
+        if (pending > 0) {
+            process_notifications(rproc, NOTIFY_CHECK_ALL);
+            break;
+        }
+        if (!pending)
+            continue;
         _rproc_wait();
     }
 #else /* uC3 */
@@ -309,6 +419,17 @@ int platform_poll(void *priv)
     return 0;
 }
 
+int platform_event_wait(uint32_t *code, volatile int *stop)
+{
+    int ret = 0;
+
+    while (!ret && !*stop) {
+        ret = platform_event_poll(code);
+    }
+
+    return ret;
+}
+
 int platform_init(unsigned long proc_id, unsigned long rsc_id, void **platform)
 {
     struct remoteproc *rproc;
@@ -337,15 +458,23 @@ void platform_release_rpmsg_vdev(void *platform, struct rpmsg_device *rpdev)
 {
     /* Need to free memory regions already allocated but not used anymore? */
     struct remoteproc *rproc = platform;
-    struct rpmsg_virtio_device *rpmsg_vdev;
-
+    struct rpmsg_vdev *rpmsg_vdev;
 #ifdef __linux__
-    virtio_clear_status(rproc->rsc_table);
+    unsigned int i;
 #endif
 
-    rpmsg_vdev = metal_container_of(rpdev, struct rpmsg_virtio_device, rdev);
-    rpmsg_deinit_vdev(rpmsg_vdev);
-    remoteproc_remove_virtio(rproc, rpmsg_vdev->vdev);
+    rpmsg_vdev = rpmsg_vdev_from_rdev(rpdev);
+#ifdef __linux__
+    virtio_clear_status(rpmsg_vdev->rvdev.vdev);
+
+    for (i = 0; i < RSC_VDEV_NUM; i++) {
+        if (ipi.rpvdev[i] == rpmsg_vdev)
+            ipi.rpvdev[i] = NULL;
+    }
+#endif
+    rpmsg_vdev_cleanup(rpmsg_vdev);
+    rpmsg_deinit_vdev(&rpmsg_vdev->rvdev);
+    remoteproc_remove_virtio(rproc, rpmsg_vdev->rvdev.vdev);
     metal_free_memory(rpmsg_vdev);
 
     return ;
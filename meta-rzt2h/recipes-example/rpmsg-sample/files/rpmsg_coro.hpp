@@ -0,0 +1,365 @@
+/**
+ * @file    rpmsg_coro.hpp
+ * @brief   C++20 coroutine client library over rpmsg endpoints.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ *
+ * One executor thread serves any number of endpoints on up to
+ * RPMSG_POLLER_DEV_MAX devices. It sleeps in poll() on the wakeup eventfd
+ * of its rpmsg_poller and on the TX space eventfd of each device, and
+ * resumes the coroutines whose message, TX buffer or timer is ready.
+ * Coroutines, endpoint callbacks and timers all run on that thread, so
+ * none of the objects below need a lock.
+ *
+ * @code
+ *     rpmsg::task<void> client(rpmsg::endpoint &ep)
+ *     {
+ *         co_await ep.wait_ready();
+ *         auto res = co_await ep.call(OP_GET, nullptr, 0, std::chrono::milliseconds(100));
+ *         ...
+ *     }
+ *
+ *     rdev = platform_create_rpmsg_vdev(platform, 0, VIRTIO_DEV_MASTER, NULL, NULL);
+ *     rpmsg::executor ex;
+ *     rpmsg::endpoint ep(ex);
+ *     if (!ex.add(rdev) && !ep.open(rdev, CFG_RPMSG_SVC_NAME0)) {
+ *         ex.spawn(client(ep));
+ *         ex.run();
+ *     }
+ * @endcode
+ *
+ * Link with librpmsg_coro.a librpmsg_sample.a -lopen_amp -lmetal -pthread;
+ * rpmsg_coro_echo.cpp is built that way.
+ */
+
+#ifndef RPMSG_CORO_HPP_
+#define RPMSG_CORO_HPP_
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* The sample headers have no C++ guards of their own */
+extern "C" {
+#include "rpmsg_vdev.h"
+#include "rpmsg_poller.h"
+#include "rpmsg_rpc.h"
+}
+
+namespace rpmsg {
+
+using clock = std::chrono::steady_clock;
+
+template <typename T = void>
+class task;
+
+namespace detail {
+
+struct promise_base {
+    std::coroutine_handle<> continuation;
+
+    /* Resumes the awaiting coroutine, if any, without growing the stack */
+    struct final_awaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+        {
+            std::coroutine_handle<> c = h.promise().continuation;
+            return c ? c : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    final_awaiter final_suspend() noexcept { return {}; }
+    /* Errors are returned as values like in the C API */
+    void unhandled_exception() noexcept { std::terminate(); }
+};
+
+} // namespace detail
+
+/**
+ * @class task
+ * @brief lazily started coroutine returning a T, run when awaited
+ */
+template <typename T>
+class task {
+public:
+    struct promise_type : detail::promise_base {
+        std::optional<T> value;
+
+        task get_return_object() { return task(handle::from_promise(*this)); }
+        void return_value(T v) { value.emplace(std::move(v)); }
+    };
+    using handle = std::coroutine_handle<promise_type>;
+
+    task(task &&other) noexcept : h_(std::exchange(other.h_, {})) {}
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+    ~task()
+    {
+        if (h_)
+            h_.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept
+    {
+        h_.promise().continuation = c;
+        return h_;
+    }
+    T await_resume() { return std::move(*h_.promise().value); }
+
+private:
+    explicit task(handle h) : h_(h) {}
+    handle h_;
+};
+
+template <>
+class task<void> {
+public:
+    struct promise_type : detail::promise_base {
+        task get_return_object() { return task(handle::from_promise(*this)); }
+        void return_void() noexcept {}
+    };
+    using handle = std::coroutine_handle<promise_type>;
+
+    task(task &&other) noexcept : h_(std::exchange(other.h_, {})) {}
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+    ~task()
+    {
+        if (h_)
+            h_.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept
+    {
+        h_.promise().continuation = c;
+        return h_;
+    }
+    void await_resume() noexcept {}
+
+private:
+    explicit task(handle h) : h_(h) {}
+    handle h_;
+};
+
+/**
+ * @class executor
+ * @brief single-threaded event loop resuming coroutines on rpmsg events
+ */
+class executor {
+public:
+    using timer_id = std::multimap<clock::time_point, std::function<void()>>::iterator;
+
+    executor();
+    ~executor();
+    executor(const executor &) = delete;
+    executor &operator=(const executor &) = delete;
+
+    /**
+     * Serve a device from this executor; its notifications no longer need
+     * platform_poll(). Call before run().
+     *
+     * return 0 on success, negative value on failure
+     */
+    int add(struct rpmsg_device *rdev, unsigned int budget = 0);
+
+    /** Start a coroutine, owned by the executor until it completes */
+    void spawn(task<void> t);
+
+    /**
+     * Run until every spawned coroutine completed or stop() is called.
+     *
+     * return 0, or a negative value if poll() failed
+     */
+    int run();
+
+    /** Make run() return after the current turn */
+    void stop() { stop_ = true; }
+
+    /** Resume a coroutine on the next turn */
+    void post(std::coroutine_handle<> h) { ready_.push_back(h); }
+
+    /** Call fn on the executor at deadline, unless cancelled before */
+    timer_id add_timer(clock::time_point deadline, std::function<void()> fn)
+    {
+        return timers_.emplace(deadline, std::move(fn));
+    }
+    void cancel_timer(timer_id id) { timers_.erase(id); }
+
+    /** Awaitable: let the other coroutines run */
+    auto yield()
+    {
+        struct awaiter {
+            executor &ex;
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { ex.post(h); }
+            void await_resume() noexcept {}
+        };
+        return awaiter{*this};
+    }
+
+    /** Awaitable: resume after the next rpmsg event */
+    auto next_event()
+    {
+        struct awaiter {
+            executor &ex;
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { ex.event_waiters_.push_back(h); }
+            void await_resume() noexcept {}
+        };
+        return awaiter{*this};
+    }
+
+    /** Awaitable: resume after a delay */
+    auto sleep_for(std::chrono::milliseconds delay)
+    {
+        struct awaiter {
+            executor &ex;
+            clock::time_point deadline;
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h)
+            {
+                ex.add_timer(deadline, [this, h] { ex.post(h); });
+            }
+            void await_resume() noexcept {}
+        };
+        return awaiter{*this, clock::now() + delay};
+    }
+
+private:
+    struct detached;
+    static detached drive(executor &ex, task<void> t);
+    void fire_timers();
+
+    struct rpmsg_poller poller_;
+    bool poller_ok_;
+    std::vector<struct rpmsg_device *> devs_;
+    std::deque<std::coroutine_handle<>> ready_;
+    std::vector<std::coroutine_handle<>> event_waiters_;
+    std::multimap<clock::time_point, std::function<void()>> timers_;
+    unsigned int live_;
+    bool stop_;
+};
+
+/**
+ * @struct message
+ * @brief  received message, copied out of the vring
+ */
+struct message {
+    int status = 0;                 /**< 0, or -ETIMEDOUT / RPMSG_ERR_* */
+    uint32_t src = 0;
+    std::vector<unsigned char> data;
+};
+
+/**
+ * @struct rpc_result
+ * @brief  response of endpoint::call()
+ */
+struct rpc_result {
+    int status = 0;                 /**< status of the response, or a local error */
+    std::vector<unsigned char> data;
+};
+
+/**
+ * @class endpoint
+ * @brief rpmsg endpoint with awaitable send, recv and call
+ *
+ * call() uses the rpmsg_rpc header and correlation ids, so many calls can
+ * be in flight. Responses go to their call; every other message goes to
+ * recv(). The endpoint must outlive the coroutines using it.
+ */
+class endpoint {
+public:
+    explicit endpoint(executor &ex) : ex_(ex) {}
+    ~endpoint() { close(); }
+    endpoint(const endpoint &) = delete;
+    endpoint &operator=(const endpoint &) = delete;
+
+    /**
+     * Create the endpoint on a device served by the executor.
+     *
+     * return 0 on success, negative value on failure
+     */
+    int open(struct rpmsg_device *rdev, const char *name,
+             uint32_t src = RPMSG_ADDR_ANY, uint32_t dst = RPMSG_ADDR_ANY);
+
+    /** Destroy the endpoint; waiting receivers and calls get an error */
+    void close();
+
+    bool ready() { return opened_ && is_rpmsg_ept_ready(&ept_); }
+    struct rpmsg_endpoint *get() { return &ept_; }
+
+    /** Wait for the name service of the remote side to bind the endpoint */
+    task<void> wait_ready();
+
+    /** Send, suspending while the remote holds every TX buffer */
+    task<int> send(const void *data, size_t len);
+
+    /** Receive one message, status -ETIMEDOUT if none came in time */
+    auto recv(std::chrono::milliseconds timeout = std::chrono::milliseconds::max())
+    {
+        return recv_awaiter{*this, timeout};
+    }
+
+    /** Send a request and wait for its response */
+    task<rpc_result> call(uint16_t op, const void *data, size_t len, std::chrono::milliseconds timeout);
+
+private:
+    struct recv_awaiter {
+        endpoint &ep;
+        std::chrono::milliseconds timeout;
+        message msg;
+        std::coroutine_handle<> h;
+        executor::timer_id timer;
+        bool timed = false;
+
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> handle);
+        message await_resume() { return std::move(msg); }
+    };
+
+    struct call_state {
+        rpc_result result;
+        std::coroutine_handle<> h;
+        executor::timer_id timer;
+        bool done = false;
+    };
+
+    static int rx_cb(struct rpmsg_endpoint *ept, void *data, size_t len, uint32_t src, void *priv);
+    static void tx_ready_cb(struct rpmsg_endpoint *ept, void *priv);
+    static void unbind_cb(struct rpmsg_endpoint *ept);
+    bool complete_call(const void *data, size_t len);
+    void complete_recv(recv_awaiter *r, message &&msg);
+
+    executor &ex_;
+    struct rpmsg_endpoint ept_ {};
+    bool opened_ = false;
+    std::deque<message> inbox_;
+    std::deque<recv_awaiter *> receivers_;
+    std::vector<std::coroutine_handle<>> senders_;
+    std::unordered_map<uint32_t, call_state *> calls_;
+    uint32_t seq_ = 0;
+};
+
+} // namespace rpmsg
+
+#endif /* RPMSG_CORO_HPP_ */
@@ -0,0 +1,512 @@
+/**
+ * @file    rpmsg_stats.c
+ * @brief   Per-channel and per-endpoint IPC statistics.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "rpmsg_stats.h"
+
+struct rpmsg_stats_channel {
+    int used;
+    unsigned int index;
+    char remote[16];
+    unsigned int channel;
+};
+
+struct rpmsg_stats_ept {
+    int used;
+    unsigned int chn;
+    unsigned int index;
+    uint32_t addr;
+    char name[32];
+};
+
+/*
+ * Counter slab owned by one thread. Only the owner writes it, the export
+ * thread reads it, so relaxed atomic loads and stores are sufficient and no
+ * cache line is ever shared between two writers.
+ */
+struct rpmsg_stats_slab {
+    uint64_t chn[RPMSG_STATS_CHN_MAX][RPMSG_STATS_ID_MAX];
+    uint64_t ept[RPMSG_STATS_CHN_MAX][RPMSG_STATS_EPT_MAX][RPMSG_STATS_EPT_ID_MAX];
+    /* per bucket (not cumulative), followed by the sum of the values */
+    uint64_t hist[RPMSG_STATS_CHN_MAX][RPMSG_STATS_HIST_ID_MAX][RPMSG_STATS_HIST_BUCKETS + 1U];
+    struct rpmsg_stats_slab *next;
+} __attribute__((aligned(RPMSG_STATS_CACHE_LINE)));
+
+/* Metric names and help texts of the Prometheus export */
+static const char *const chn_metric[RPMSG_STATS_ID_MAX][2] = {
+    { "rpmsg_tx_messages_total", "Messages sent to the remote core." },
+    { "rpmsg_tx_bytes_total", "Payload bytes sent to the remote core." },
+    { "rpmsg_rx_messages_total", "Messages received from the remote core." },
+    { "rpmsg_rx_bytes_total", "Payload bytes received from the remote core." },
+    { "rpmsg_doorbells_total", "Doorbells rung towards the remote core." },
+    { "rpmsg_doorbells_coalesced_total", "Notifications issued while the previous doorbell was still pending." },
+    { "rpmsg_irqs_total", "Mailbox interrupts taken." },
+    { "rpmsg_irqs_spurious_total", "Mailbox interrupts carrying an invalid notify_id." },
+    { "rpmsg_tx_nobuf_total", "Sends that had to wait for a free TX buffer." },
+    { "rpmsg_notify_sts_waits_total", "Iterations spent waiting for the doorbell status to clear." },
+    { "rpmsg_tx_waits_total", "Blocking waits for a free TX buffer." },
+    { "rpmsg_tx_wakeups_total", "TX waiters woken up by a notification from the remote core." },
+    { "rpmsg_tx_wait_timeouts_total", "TX buffer waits that ran into the timeout." },
+    { "rpmsg_tx_wait_microseconds_total", "Time spent blocked waiting for a free TX buffer." },
+    { "rpmsg_tx_again_total", "Non-blocking sends that returned without a free TX buffer." },
+    { "rpmsg_tx_ready_total", "TX space available callbacks delivered to endpoints." },
+    { "rpmsg_tx_batches_total", "Batches drained from the TX submission queue, one kick each." },
+    { "rpmsg_tx_deadline_misses_total", "Messages sent after their deadline." },
+    { "rpmsg_tx_credit_waits_total", "Sends that found the remote endpoint out of credits." },
+    { "rpmsg_credit_updates_total", "Empty messages sent to grant credits back to the remote." },
+};
+
+static const char *const ept_metric[RPMSG_STATS_EPT_ID_MAX][2] = {
+    { "rpmsg_endpoint_tx_messages_total", "Messages sent from the endpoint." },
+    { "rpmsg_endpoint_tx_bytes_total", "Payload bytes sent from the endpoint." },
+    { "rpmsg_endpoint_rx_messages_total", "Messages delivered to the endpoint." },
+    { "rpmsg_endpoint_rx_bytes_total", "Payload bytes delivered to the endpoint." },
+};
+
+static const char *const hist_metric[RPMSG_STATS_HIST_ID_MAX][2] = {
+    { "rpmsg_rx_batch_size", "Buffers handled per RX batch, returned with a single kick." },
+    { "rpmsg_worker_queue_depth", "Messages already queued on the worker when a message is dispatched." },
+    { "rpmsg_worker_wait_microseconds", "Time a received message waited for its worker thread." },
+    { "rpmsg_handler_microseconds", "Time spent in an endpoint callback on a worker thread." },
+    { "rpmsg_tx_queue_delay_urgent_microseconds", "Time an urgent message waited for a TX buffer." },
+    { "rpmsg_tx_queue_delay_normal_microseconds", "Time a normal message waited for a TX buffer." },
+    { "rpmsg_tx_queue_delay_bulk_microseconds", "Time a bulk message waited for a TX buffer." },
+    { "rpmsg_echo_round_trip_irq_microseconds", "Time from a send to its echo, woken up by the doorbell." },
+    { "rpmsg_echo_round_trip_poll_microseconds", "Time from a send to its echo, busy polling the vrings." },
+};
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct rpmsg_stats_channel channels[RPMSG_STATS_CHN_MAX];
+static struct rpmsg_stats_ept epts[RPMSG_STATS_CHN_MAX][RPMSG_STATS_EPT_MAX];
+
+/* Slabs of live threads, and the sum of the slabs of exited threads */
+static struct rpmsg_stats_slab *slabs = NULL;
+static struct rpmsg_stats_slab retired;
+static pthread_key_t slab_key;
+static pthread_once_t slab_once = PTHREAD_ONCE_INIT;
+static __thread struct rpmsg_stats_slab *my_slab = NULL;
+
+/* Export thread */
+static pthread_t export_th;
+static pthread_cond_t export_cond = PTHREAD_COND_INITIALIZER;
+static int export_running = 0;
+static int export_stop = 0;
+static const char *export_path = NULL;
+static unsigned int export_period_ms = RPMSG_STATS_PERIOD_MS;
+
+static void slab_retire(void *arg)
+{
+    struct rpmsg_stats_slab *slab = arg;
+    struct rpmsg_stats_slab **pp;
+    uint64_t *dst = &retired.chn[0][0];
+    uint64_t *src = &slab->chn[0][0];
+    size_t i;
+    size_t n = (sizeof(slab->chn) + sizeof(slab->ept) + sizeof(slab->hist)) / sizeof(uint64_t);
+
+    pthread_mutex_lock(&stats_lock);
+    for (pp = &slabs; *pp; pp = &(*pp)->next) {
+        if (*pp == slab) {
+            *pp = slab->next;
+            break;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        __atomic_store_n(&dst[i], dst[i] + src[i], __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&stats_lock);
+
+    free(slab);
+}
+
+static void slab_key_create(void)
+{
+    (void)pthread_key_create(&slab_key, slab_retire);
+}
+
+static struct rpmsg_stats_slab *slab_get(void)
+{
+    struct rpmsg_stats_slab *slab = my_slab;
+
+    if (slab)
+        return slab;
+
+    (void)pthread_once(&slab_once, slab_key_create);
+    if (posix_memalign((void **)&slab, RPMSG_STATS_CACHE_LINE, sizeof(*slab)))
+        return NULL;
+    memset(slab, 0, sizeof(*slab));
+
+    pthread_mutex_lock(&stats_lock);
+    slab->next = slabs;
+    slabs = slab;
+    pthread_mutex_unlock(&stats_lock);
+
+    (void)pthread_setspecific(slab_key, slab);
+    my_slab = slab;
+
+    return slab;
+}
+
+/* Copy a name, truncated to fit and always terminated */
+static void stats_copy_name(char *dst, size_t size, const char *src)
+{
+    size_t len = strnlen(src, size - 1);
+
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+struct rpmsg_stats_channel *rpmsg_stats_channel_get(const char *remote, unsigned int channel)
+{
+    struct rpmsg_stats_channel *chn = NULL;
+    unsigned int i;
+
+    pthread_mutex_lock(&stats_lock);
+    for (i = 0; i < RPMSG_STATS_CHN_MAX; i++) {
+        if (!channels[i].used) {
+            chn = &channels[i];
+            chn->index = i;
+            chn->channel = channel;
+            stats_copy_name(chn->remote, sizeof(chn->remote), remote);
+            __atomic_store_n(&chn->used, 1, __ATOMIC_RELEASE);
+            break;
+        }
+        if ((channels[i].channel == channel) && !strcmp(channels[i].remote, remote)) {
+            chn = &channels[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&stats_lock);
+
+    return chn;
+}
+
+struct rpmsg_stats_ept *rpmsg_stats_ept_get(struct rpmsg_stats_channel *chn, uint32_t addr, const char *name)
+{
+    struct rpmsg_stats_ept *row;
+    struct rpmsg_stats_ept *ept = NULL;
+    unsigned int i;
+
+    if (!chn)
+        return NULL;
+    row = epts[chn->index];
+
+    /* Fast path: entries are never removed, so a published entry is stable */
+    for (i = 0; i < RPMSG_STATS_EPT_MAX; i++) {
+        if (!__atomic_load_n(&row[i].used, __ATOMIC_ACQUIRE))
+            break;
+        if ((row[i].addr == addr) && !strncmp(row[i].name, name, sizeof(row[i].name) - 1))
+            return &row[i];
+    }
+    /* Table full: rows are never freed, so the lock would not find one either */
+    if (i == RPMSG_STATS_EPT_MAX)
+        return NULL;
+
+    pthread_mutex_lock(&stats_lock);
+    for (i = 0; i < RPMSG_STATS_EPT_MAX; i++) {
+        if (!row[i].used) {
+            ept = &row[i];
+            ept->chn = chn->index;
+            ept->index = i;
+            ept->addr = addr;
+            stats_copy_name(ept->name, sizeof(ept->name), name);
+            __atomic_store_n(&ept->used, 1, __ATOMIC_RELEASE);
+            break;
+        }
+        if ((row[i].addr == addr) && !strncmp(row[i].name, name, sizeof(row[i].name) - 1)) {
+            ept = &row[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&stats_lock);
+
+    return ept;
+}
+
+unsigned int rpmsg_stats_ept_index(const struct rpmsg_stats_ept *ept)
+{
+    return ept->index;
+}
+
+struct rpmsg_stats_ept *rpmsg_stats_ept_at(struct rpmsg_stats_channel *chn, unsigned int index)
+{
+    struct rpmsg_stats_ept *ept;
+
+    if (!chn || (index >= RPMSG_STATS_EPT_MAX))
+        return NULL;
+    ept = &epts[chn->index][index];
+
+    return __atomic_load_n(&ept->used, __ATOMIC_ACQUIRE) ? ept : NULL;
+}
+
+void rpmsg_stats_add(struct rpmsg_stats_channel *chn, enum rpmsg_stats_id id, uint64_t val)
+{
+    struct rpmsg_stats_slab *slab;
+    uint64_t *cnt;
+
+    if (!chn || (id >= RPMSG_STATS_ID_MAX))
+        return;
+    slab = slab_get();
+    if (!slab)
+        return;
+
+    cnt = &slab->chn[chn->index][id];
+    __atomic_store_n(cnt, *cnt + val, __ATOMIC_RELAXED);
+}
+
+void rpmsg_stats_ept_add(struct rpmsg_stats_ept *ept, enum rpmsg_stats_ept_id id, uint64_t val)
+{
+    struct rpmsg_stats_slab *slab;
+    uint64_t *cnt;
+
+    if (!ept || (id >= RPMSG_STATS_EPT_ID_MAX))
+        return;
+    slab = slab_get();
+    if (!slab)
+        return;
+
+    cnt = &slab->ept[ept->chn][ept->index][id];
+    __atomic_store_n(cnt, *cnt + val, __ATOMIC_RELAXED);
+}
+
+void rpmsg_stats_observe(struct rpmsg_stats_channel *chn, enum rpmsg_stats_hist_id id, uint64_t val)
+{
+    struct rpmsg_stats_slab *slab;
+    uint64_t *cnt;
+    unsigned int b = 0U;
+
+    if (!chn || (id >= RPMSG_STATS_HIST_ID_MAX))
+        return;
+    slab = slab_get();
+    if (!slab)
+        return;
+
+    /* Smallest power of two bucket holding the value */
+    if (val > 1U)
+        b = 64U - (unsigned int)__builtin_clzll(val - 1U);
+    if (b > RPMSG_STATS_HIST_BUCKETS - 1U)
+        b = RPMSG_STATS_HIST_BUCKETS - 1U;
+
+    cnt = slab->hist[chn->index][id];
+    __atomic_store_n(&cnt[b], cnt[b] + 1U, __ATOMIC_RELAXED);
+    __atomic_store_n(&cnt[RPMSG_STATS_HIST_BUCKETS], cnt[RPMSG_STATS_HIST_BUCKETS] + val, __ATOMIC_RELAXED);
+}
+
+/* Sum of one counter over all slabs. Called with stats_lock held. */
+static uint64_t sum_chn(unsigned int chn, unsigned int id)
+{
+    struct rpmsg_stats_slab *slab;
+    uint64_t val = __atomic_load_n(&retired.chn[chn][id], __ATOMIC_RELAXED);
+
+    for (slab = slabs; slab; slab = slab->next)
+        val += __atomic_load_n(&slab->chn[chn][id], __ATOMIC_RELAXED);
+
+    return val;
+}
+
+static uint64_t sum_ept(unsigned int chn, unsigned int ept, unsigned int id)
+{
+    struct rpmsg_stats_slab *slab;
+    uint64_t val = __atomic_load_n(&retired.ept[chn][ept][id], __ATOMIC_RELAXED);
+
+    for (slab = slabs; slab; slab = slab->next)
+        val += __atomic_load_n(&slab->ept[chn][ept][id], __ATOMIC_RELAXED);
+
+    return val;
+}
+
+static uint64_t sum_hist(unsigned int chn, unsigned int id, unsigned int b)
+{
+    struct rpmsg_stats_slab *slab;
+    uint64_t val = __atomic_load_n(&retired.hist[chn][id][b], __ATOMIC_RELAXED);
+
+    for (slab = slabs; slab; slab = slab->next)
+        val += __atomic_load_n(&slab->hist[chn][id][b], __ATOMIC_RELAXED);
+
+    return val;
+}
+
+/* Escape a label value as the text exposition format requires */
+static const char *label_escape(const char *in, char *out, size_t size)
+{
+    size_t n = 0;
+
+    for (; *in && (n + 2U < size); in++) {
+        if ((*in == '"') || (*in == '\\') || (*in == '\n')) {
+            out[n++] = '\\';
+            out[n++] = (*in == '\n') ? 'n' : *in;
+        } else {
+            out[n++] = *in;
+        }
+    }
+    out[n] = '\0';
+
+    return out;
+}
+
+int rpmsg_stats_write(FILE *fp)
+{
+    char remote[2U * sizeof(channels[0].remote)];
+    char name[2U * sizeof(epts[0][0].name)];
+    unsigned int id, i, j;
+    uint64_t cum;
+
+    pthread_mutex_lock(&stats_lock);
+    for (id = 0; id < RPMSG_STATS_ID_MAX; id++) {
+        fprintf(fp, "# HELP %s %s\n", chn_metric[id][0], chn_metric[id][1]);
+        fprintf(fp, "# TYPE %s counter\n", chn_metric[id][0]);
+        for (i = 0; (i < RPMSG_STATS_CHN_MAX) && channels[i].used; i++) {
+            (void)label_escape(channels[i].remote, remote, sizeof(remote));
+            fprintf(fp, "%s{remote=\"%s\",channel=\"%u\"} %llu\n",
+                    chn_metric[id][0], remote, channels[i].channel,
+                    (unsigned long long)sum_chn(i, id));
+        }
+    }
+    for (id = 0; id < RPMSG_STATS_EPT_ID_MAX; id++) {
+        fprintf(fp, "# HELP %s %s\n", ept_metric[id][0], ept_metric[id][1]);
+        fprintf(fp, "# TYPE %s counter\n", ept_metric[id][0]);
+        for (i = 0; (i < RPMSG_STATS_CHN_MAX) && channels[i].used; i++) {
+            (void)label_escape(channels[i].remote, remote, sizeof(remote));
+            for (j = 0; (j < RPMSG_STATS_EPT_MAX) && epts[i][j].used; j++) {
+                (void)label_escape(epts[i][j].name, name, sizeof(name));
+                fprintf(fp, "%s{remote=\"%s\",channel=\"%u\",endpoint=\"%s\",addr=\"%u\"} %llu\n",
+                        ept_metric[id][0], remote, channels[i].channel,
+                        name, (unsigned int)epts[i][j].addr,
+                        (unsigned long long)sum_ept(i, j, id));
+            }
+        }
+    }
+    for (id = 0; id < RPMSG_STATS_HIST_ID_MAX; id++) {
+        fprintf(fp, "# HELP %s %s\n", hist_metric[id][0], hist_metric[id][1]);
+        fprintf(fp, "# TYPE %s histogram\n", hist_metric[id][0]);
+        for (i = 0; (i < RPMSG_STATS_CHN_MAX) && channels[i].used; i++) {
+            (void)label_escape(channels[i].remote, remote, sizeof(remote));
+            cum = 0U;
+            for (j = 0; j < RPMSG_STATS_HIST_BUCKETS; j++) {
+                cum += sum_hist(i, id, j);
+                if (j < RPMSG_STATS_HIST_BUCKETS - 1U) {
+                    fprintf(fp, "%s_bucket{remote=\"%s\",channel=\"%u\",le=\"%u\"} %llu\n",
+                            hist_metric[id][0], remote, channels[i].channel,
+                            1U << j, (unsigned long long)cum);
+                } else {
+                    fprintf(fp, "%s_bucket{remote=\"%s\",channel=\"%u\",le=\"+Inf\"} %llu\n",
+                            hist_metric[id][0], remote, channels[i].channel,
+                            (unsigned long long)cum);
+                }
+            }
+            fprintf(fp, "%s_sum{remote=\"%s\",channel=\"%u\"} %llu\n",
+                    hist_metric[id][0], remote, channels[i].channel,
+                    (unsigned long long)sum_hist(i, id, RPMSG_STATS_HIST_BUCKETS));
+            fprintf(fp, "%s_count{remote=\"%s\",channel=\"%u\"} %llu\n",
+                    hist_metric[id][0], remote, channels[i].channel,
+                    (unsigned long long)cum);
+        }
+    }
+    pthread_mutex_unlock(&stats_lock);
+
+    return ferror(fp) ? -EIO : 0;
+}
+
+/* Write the file next to its final name and rename it, so that a scraper
+ * never sees a partially written file. */
+static int export_file(const char *path)
+{
+    char tmp[256];
+    FILE *fp;
+    int ret;
+
+    (void)snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    fp = fopen(tmp, "w");
+    if (!fp)
+        return -errno;
+
+    ret = rpmsg_stats_write(fp);
+    if (fclose(fp) && !ret)
+        ret = -errno;
+    if (!ret && rename(tmp, path))
+        ret = -errno;
+    if (ret)
+        (void)unlink(tmp);
+
+    return ret;
+}
+
+static void *export_thread(void *arg)
+{
+    struct timespec ts;
+    (void)arg;
+
+    pthread_mutex_lock(&stats_lock);
+    while (!export_stop) {
+        pthread_mutex_unlock(&stats_lock);
+        (void)export_file(export_path);
+        pthread_mutex_lock(&stats_lock);
+
+        (void)clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += export_period_ms / 1000U;
+        ts.tv_nsec += (long)(export_period_ms % 1000U) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        while (!export_stop) {
+            if (pthread_cond_timedwait(&export_cond, &stats_lock, &ts) == ETIMEDOUT)
+                break;
+        }
+    }
+    pthread_mutex_unlock(&stats_lock);
+
+    /* Final values */
+    (void)export_file(export_path);
+
+    return NULL;
+}
+
+int rpmsg_stats_start(const char *path, unsigned int period_ms)
+{
+    int ret;
+
+    if (!path || !period_ms)
+        return -EINVAL;
+    if (export_running)
+        return -EBUSY;
+
+    export_path = path;
+    export_period_ms = period_ms;
+    export_stop = 0;
+    ret = pthread_create(&export_th, NULL, export_thread, NULL);
+    if (ret)
+        return -ret;
+    export_running = 1;
+
+    return 0;
+}
+
+void rpmsg_stats_stop(void)
+{
+    if (!export_running)
+        return;
+
+    pthread_mutex_lock(&stats_lock);
+    export_stop = 1;
+    pthread_cond_signal(&export_cond);
+    pthread_mutex_unlock(&stats_lock);
+
+    (void)pthread_join(export_th, NULL);
+    export_running = 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file    rpmsg_txq.c
+ * @brief   Lock-free multi-producer TX submission queue.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <stddef.h>
+#include <sched.h>
+#include "rpmsg_txq.h"
+
+#define TXQ_BUSY ((struct rpmsg_txq_node *)1)
+
+static inline void cpu_relax(void)
+{
+#if defined(__aarch64__) || defined(__arm__)
+    __asm__ volatile("yield" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    __asm__ volatile("pause" ::: "memory");
+#else
+    __asm__ volatile("" ::: "memory");
+#endif
+}
+
+static void txq_push(struct rpmsg_txq *q, struct rpmsg_txq_node *node)
+{
+    struct rpmsg_txq_node *prev;
+
+    __atomic_store_n(&node->next, NULL, __ATOMIC_RELAXED);
+    prev = __atomic_exchange_n(&q->head, node, __ATOMIC_SEQ_CST);
+    /* Until this store the node is invisible to the drainer (TXQ_BUSY) */
+    __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+}
+
+/*
+ * Take the oldest node. Returns NULL if the queue is empty, TXQ_BUSY if a
+ * producer is between its exchange and its link, which takes a few cycles.
+ * A node is only returned once its successor is linked, so the producer may
+ * release it as soon as it is marked done.
+ */
+static struct rpmsg_txq_node *txq_pop(struct rpmsg_txq *q)
+{
+    struct rpmsg_txq_node *tail = q->tail;
+    struct rpmsg_txq_node *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+
+    if (tail == &q->stub) {
+        if (!next)
+            return (__atomic_load_n(&q->head, __ATOMIC_SEQ_CST) == tail) ? NULL : TXQ_BUSY;
+        q->tail = next;
+        tail = next;
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    }
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+    if (__atomic_load_n(&q->head, __ATOMIC_SEQ_CST) != tail)
+        return TXQ_BUSY;
+
+    /* Last node: put the stub behind it so that it can be taken */
+    txq_push(q, &q->stub);
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+
+    return TXQ_BUSY;
+}
+
+/* Drain until the queue is empty. Called by the thread owning q->draining. */
+static void txq_drain(struct rpmsg_txq *q)
+{
+    struct rpmsg_txq_node *batch[RPMSG_TXQ_BATCH_MAX];
+    struct rpmsg_txq_node *node;
+    unsigned int i, n, spin;
+    int empty = 0;
+
+    while (!empty) {
+        n = 0;
+        spin = 0;
+        while (n < RPMSG_TXQ_BATCH_MAX) {
+            node = txq_pop(q);
+            if (node == TXQ_BUSY) {
+                /* The producer may have been preempted before its link */
+                if (++spin < RPMSG_TXQ_SPIN_MAX)
+                    cpu_relax();
+                else
+                    (void)sched_yield();
+                continue;
+            }
+            spin = 0;
+            if (!node) {
+                empty = 1;
+                break;
+            }
+            batch[n++] = node;
+        }
+        if (!n)
+            break;
+
+        q->drain(q->arg, batch, n);
+        for (i = 0; i < n; i++)
+            __atomic_store_n(&batch[i]->done, 1, __ATOMIC_RELEASE);
+    }
+}
+
+/* Become the drainer if nobody is, and drain until nothing is left behind */
+static void txq_try_drain(struct rpmsg_txq *q)
+{
+    int idle = 0;
+
+    while (__atomic_compare_exchange_n(&q->draining, &idle, 1, 0,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+        txq_drain(q);
+        __atomic_store_n(&q->draining, 0, __ATOMIC_SEQ_CST);
+        /* A submission that lost the race against the release is drained here */
+        if (__atomic_load_n(&q->head, __ATOMIC_SEQ_CST) == &q->stub)
+            break;
+        idle = 0;
+    }
+}
+
+void rpmsg_txq_init(struct rpmsg_txq *q, rpmsg_txq_drain_fn drain, void *arg)
+{
+    q->stub.next = NULL;
+    q->head = &q->stub;
+    q->tail = &q->stub;
+    q->draining = 0;
+    q->drain = drain;
+    q->arg = arg;
+}
+
+int rpmsg_txq_submit(struct rpmsg_txq *q, struct rpmsg_txq_node *node)
+{
+    unsigned int spin = 0;
+
+    node->done = 0;
+    txq_push(q, node);
+    txq_try_drain(q);
+
+    while (!__atomic_load_n(&node->done, __ATOMIC_ACQUIRE)) {
+        if (++spin < RPMSG_TXQ_SPIN_MAX) {
+            cpu_relax();
+        } else {
+            (void)sched_yield();
+            /* The drainer may have finished right before our node was linked */
+            if (!__atomic_load_n(&q->draining, __ATOMIC_RELAXED))
+                txq_try_drain(q);
+        }
+    }
+
+    return node->result;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file    rpmsg_txq.h
+ * @brief   Lock-free multi-producer TX submission queue.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#ifndef RPMSG_TXQ_H_
+#define RPMSG_TXQ_H_
+
+#include <stdint.h>
+
+// Maximum number of submissions handed to the drain function at once
+#ifndef RPMSG_TXQ_BATCH_MAX
+#define RPMSG_TXQ_BATCH_MAX     (32U)
+#endif
+// Spin iterations of a waiting sender before it yields the CPU
+#define RPMSG_TXQ_SPIN_MAX      (128U)
+
+/**
+ * @struct rpmsg_txq_node
+ * @brief  submission, embedded in the request of the sender
+ */
+struct rpmsg_txq_node {
+    struct rpmsg_txq_node *next;
+    int result; /**< set by the drain function */
+    int done;   /**< set once the result is valid */
+};
+
+/**
+ * rpmsg_txq_drain_fn - process a batch of submissions
+ *
+ * Called by exactly one thread at a time, in submission order. It sets the
+ * result of every node; the queue marks them done afterwards.
+ *
+ * @arg: argument given to rpmsg_txq_init()
+ * @nodes: submissions
+ * @n: number of submissions
+ */
+typedef void (*rpmsg_txq_drain_fn)(void *arg, struct rpmsg_txq_node **nodes, unsigned int n);
+
+/**
+ * @struct rpmsg_txq
+ * @brief  intrusive MPSC queue (D. Vyukov) with a combining drainer
+ */
+struct rpmsg_txq {
+    struct rpmsg_txq_node *head __attribute__((aligned(64))); /**< producers */
+    struct rpmsg_txq_node *tail __attribute__((aligned(64))); /**< drainer */
+    struct rpmsg_txq_node stub;
+    int draining __attribute__((aligned(64)));
+    rpmsg_txq_drain_fn drain;
+    void *arg;
+};
+
+/**
+ * rpmsg_txq_init - initialize a queue
+ *
+ * @q: queue
+ * @drain: function processing the submissions
+ * @arg: argument passed to @drain
+ */
+void rpmsg_txq_init(struct rpmsg_txq *q, rpmsg_txq_drain_fn drain, void *arg);
+
+/**
+ * rpmsg_txq_submit - submit a request and wait for its result
+ *
+ * The enqueue is a single atomic exchange, so senders never wait for each
+ * other to enqueue. Whichever sender finds the queue idle drains it,
+ * including the requests of the others, in batches of up to
+ * RPMSG_TXQ_BATCH_MAX; the other senders only wait for their own result.
+ *
+ * @q: queue
+ * @node: submission, must stay valid until the function returns
+ *
+ * return result set by the drain function
+ */
+int rpmsg_txq_submit(struct rpmsg_txq *q, struct rpmsg_txq_node *node);
+
+#endif /* RPMSG_TXQ_H_ */
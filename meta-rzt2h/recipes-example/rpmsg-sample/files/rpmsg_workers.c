@@ -0,0 +1,193 @@
+/**
+ * @file    rpmsg_workers.c
+ * @brief   Worker threads running the endpoint callbacks of a rpmsg device.
+ * @date    2026.10.18
+ * @author  Copyright (c) 2026, Renesas Electronics Corporation. All rights reserved.
+ * @license SPDX-License-Identifier: BSD-3-Clause
+ *
+ ****************************************************************************
+ * @par     History
+ *          - rev 1.0 (2026.10.18)
+ *            Initial version.
+ ****************************************************************************
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rpmsg_workers.h"
+
+struct worker_msg {
+    struct rpmsg_endpoint *ept;
+    struct rpmsg_vdev_hdr *hdr;
+    struct timespec queued;
+};
+
+/*
+ * Queue of one worker. It can hold every buffer of the RX ring, so the
+ * polling thread never has to wait for a worker.
+ */
+struct worker {
+    struct rpmsg_workers *pool;
+    pthread_t th;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct worker_msg *msg;
+    unsigned int size;
+    unsigned int head;
+    unsigned int count;
+    int stop;
+} __attribute__((aligned(64)));
+
+struct rpmsg_workers {
+    struct rpmsg_vdev *rpvdev;
+    unsigned int num;
+    struct worker worker[RPMSG_WORKERS_MAX];
+};
+
+static uint64_t usec_since(const struct timespec *from)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - from->tv_sec) * 1000000U
+           + (uint64_t)((now.tv_nsec - from->tv_nsec) / 1000);
+}
+
+static void *worker_thread(void *arg)
+{
+    struct worker *w = arg;
+    struct rpmsg_vdev *rpvdev = w->pool->rpvdev;
+    struct worker_msg msg[RPMSG_WORKERS_BATCH];
+    struct rpmsg_vdev_hdr *done[RPMSG_WORKERS_BATCH];
+    struct timespec start;
+    unsigned int i, n;
+
+    pthread_mutex_lock(&w->lock);
+    for (;;) {
+        while (!w->count && !w->stop)
+            pthread_cond_wait(&w->cond, &w->lock);
+        if (!w->count)
+            break;
+
+        for (n = 0; (n < RPMSG_WORKERS_BATCH) && w->count; n++) {
+            msg[n] = w->msg[w->head];
+            w->head = (w->head + 1U) % w->size;
+            w->count--;
+        }
+        pthread_mutex_unlock(&w->lock);
+
+        for (i = 0; i < n; i++) {
+            rpmsg_stats_observe(rpvdev->stats, RPMSG_STATS_HIST_WORKER_WAIT, usec_since(&msg[i].queued));
+            (void)clock_gettime(CLOCK_MONOTONIC, &start);
+            (void)msg[i].ept->cb(msg[i].ept, (void *)(msg[i].hdr + 1), msg[i].hdr->len,
+                                 msg[i].hdr->src, msg[i].ept->priv);
+            rpmsg_stats_observe(rpvdev->stats, RPMSG_STATS_HIST_HANDLER_USEC, usec_since(&start));
+            done[i] = msg[i].hdr;
+        }
+        rpmsg_vdev_rx_release(rpvdev, done, n);
+
+        pthread_mutex_lock(&w->lock);
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    return NULL;
+}
+
+void rpmsg_workers_submit(struct rpmsg_workers *workers, struct rpmsg_endpoint *ept,
+                          struct rpmsg_vdev_hdr *hdr)
+{
+    struct worker *w = &workers->worker[ept->addr % workers->num];
+    struct worker_msg *msg;
+
+    pthread_mutex_lock(&w->lock);
+    rpmsg_stats_observe(workers->rpvdev->stats, RPMSG_STATS_HIST_WORKER_DEPTH, w->count);
+    msg = &w->msg[(w->head + w->count) % w->size];
+    msg->ept = ept;
+    msg->hdr = hdr;
+    (void)clock_gettime(CLOCK_MONOTONIC, &msg->queued);
+    w->count++;
+    if (w->count == 1U)
+        pthread_cond_signal(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+}
+
+static void workers_free(struct rpmsg_workers *workers, unsigned int started)
+{
+    unsigned int i;
+
+    for (i = 0; i < started; i++) {
+        pthread_mutex_lock(&workers->worker[i].lock);
+        workers->worker[i].stop = 1;
+        pthread_cond_signal(&workers->worker[i].cond);
+        pthread_mutex_unlock(&workers->worker[i].lock);
+        (void)pthread_join(workers->worker[i].th, NULL);
+    }
+    for (i = 0; i < workers->num; i++) {
+        pthread_cond_destroy(&workers->worker[i].cond);
+        pthread_mutex_destroy(&workers->worker[i].lock);
+        free(workers->worker[i].msg);
+    }
+    free(workers);
+}
+
+int rpmsg_workers_start(struct rpmsg_device *rdev, unsigned int num)
+{
+    struct rpmsg_vdev *rpvdev = rpmsg_vdev_from_rdev(rdev);
+    struct rpmsg_workers *workers;
+    struct worker *w;
+    unsigned int i;
+    int ret = 0;
+
+    if (!num || (num > RPMSG_WORKERS_MAX))
+        return -EINVAL;
+    if (rpvdev->workers)
+        return -EBUSY;
+
+    workers = calloc(1, sizeof(*workers));
+    if (!workers)
+        return -ENOMEM;
+    workers->rpvdev = rpvdev;
+    workers->num = num;
+
+    for (i = 0; i < num; i++) {
+        w = &workers->worker[i];
+        w->pool = workers;
+        w->size = rpvdev->rvdev.rvq->vq_nentries;
+        pthread_mutex_init(&w->lock, NULL);
+        pthread_cond_init(&w->cond, NULL);
+        w->msg = calloc(w->size, sizeof(*w->msg));
+        if (!w->msg)
+            ret = -ENOMEM;
+    }
+    for (i = 0; !ret && (i < num); i++) {
+        ret = -pthread_create(&workers->worker[i].th, NULL, worker_thread, &workers->worker[i]);
+        if (ret)
+            break;
+    }
+    if (ret) {
+        workers_free(workers, i);
+        return ret;
+    }
+
+    __atomic_store_n(&rpvdev->workers, workers, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+void rpmsg_workers_stop(struct rpmsg_device *rdev)
+{
+    struct rpmsg_vdev *rpvdev = rpmsg_vdev_from_rdev(rdev);
+    struct rpmsg_workers *workers;
+
+    /* rx_dispatch() runs under rx_poll_lock, once released it cannot see the pool */
+    pthread_mutex_lock(&rpvdev->rx_poll_lock);
+    workers = rpvdev->workers;
+    __atomic_store_n(&rpvdev->workers, NULL, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&rpvdev->rx_poll_lock);
+
+    if (!workers)
+        return;
+    workers_free(workers, workers->num);
+}